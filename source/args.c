@@ -60,6 +60,18 @@ int getArgs(struct flags *flag, int argc, char **argv, char *opt_string)
 			case 's':
 				flag->show = 1;
 				break;
+			case 'q':
+				flag->query = 1;
+				break;
+			case 'D':
+				flag->daemon = 1;
+				break;
+			case 'S':
+				flag->switch_now = 1;
+				break;
+			case 'a':
+				flag->all_users = 1;
+				break;
 			case 'v':
 				if(optarg == NULL) {
 					if(flag->verbose != NULL) {
@@ -149,6 +161,12 @@ void showHelp()
 	printf("-h - help (show usage information)\n");
 	printf("-v - verbose (show messages about the details of a run)\n");
 	printf("-s - show (show the options from the config)\n");
+	printf("-q - query (show the status published by the last run)\n");
+	printf("-D - daemon (run in the foreground instead of a cronjob)\n");
+	printf("     events are streamed at $XDG_RUNTIME_DIR/csw/events\n");
+	printf("-S - switch now (let the running daemon evaluate the schedule)\n");
+	printf("-a - all users (run the schedule of every user with a config,\n");
+	printf("     replaces the crontab entries of the users by one of root)\n");
 	printf("-d - delay (add a delay to the switch of a context)\n");
 	printf("     requires an argument, valid values:\n");
 	printf("     integer/float number & m|min|minute or h|hour or d|day)\n");
@@ -0,0 +1,624 @@
+/**
+ * @file batch.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	evaluate the schedule of every user in a single invocation
+ *
+ * Replaces one crontab entry per user with one root entry (csw -a). The
+ * users are discovered once per invocation and evaluated in parallel on
+ * a work-stealing pool: the compiled config, the timeline, the status
+ * segment and the taskrc of the user tell if the active context already
+ * matches the schedule. Users with the same schedule share one timeline
+ * (share.c). The config, the taskrc and the cache of all users
+ * are checked in one batched scan (scan.c). Only users that need an action
+ * (or whose state can't be decided without taskwarrior) get a run on the
+ * deadline queue, in a child that drops to the credentials of the user.
+ * The children are forked by a spawn server (spawn.c) that is started
+ * before the process grows. Without the server the runs are forked one
+ * after another, once the process is single threaded again.
+ *
+ * Most users of a host share the zone boundaries, so their runs would
+ * hit taskwarrior in the same second. The runs of a boundary are spread
+ * by a jitter derived from the name of the user (the same offset on every
+ * boundary), at most ACTION_WORKERS run at once and the earliest deadline
+ * goes first, every run should end within HERD_SLO seconds of the
+ * boundary. Requests of a user skip the jitter.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/batch.h"
+
+extern int verbose;
+
+void evaluateJob(void*);
+void actionJob(void*);
+void herdJob(struct user_job*, int);
+void reportHerd(struct user_job*, int, int);
+void runSequential(struct deadline_queue*);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+long monotonicNs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	run the scheduler as the user, called in a child process
+ *
+ * @param[in]	user	target user
+ * @param[in]	flag	parsed command line options
+ * @param[in]	base	system-wide base compiled by the parent (NULL to
+ * 				load it)
+ * @param[in]	rawtime	point in time shared by all users of the batch
+ *
+ * @retval	EXIT_SUCCESS	switched or no switch required
+ * @retval	EXIT_FAILURE	switching to the user or the run failed
+ */
+int runUser(struct user_entry *user, struct flags *flag, struct base_layer *base,
+		time_t rawtime)
+{
+	char status_name[STATUS_NAME_LEN] = {0};
+	struct runtime rt = {0};
+	int result = 0;
+
+	if(userEnvironment(user) != 0 || dropPrivileges(user) != 0) {
+		fprintf(stderr, "ERROR: switching to user %s failed\n", user->name);
+		return EXIT_FAILURE;
+	}
+	if(statusName(status_name) == 0)
+		rt.status = openStatus(status_name, 1);
+	rt.base = base;
+
+	result = runTick(&rt, flag, rawtime);
+	fflush(stdout);
+	return result;
+}
+
+/**
+ * @brief	fork a child that runs the scheduler for one user
+ *
+ * The child calls into NSS, malloc and popen, so the caller has to be the
+ * only thread of the process.
+ *
+ * @param[in]	user	target user
+ * @param[in]	flag	parsed command line options
+ * @param[in]	base	system-wide base compiled by the parent
+ * @param[in]	rawtime	point in time shared by all users of the batch
+ *
+ * @retval	pid of the child
+ * @retval	-1	fork failed
+ */
+pid_t startUser(struct user_entry *user, struct flags *flag,
+		struct base_layer *base, time_t rawtime)
+{
+	pid_t pid = fork();
+
+	if(pid != 0)
+		return pid;
+	_exit(runUser(user, flag, base, rawtime));
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int spawnedUser(struct spawn_request *request)
+{
+	return runUser(&request->user, &request->flag, &request->base,
+			request->rawtime);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	decide without taskwarrior if a user needs a run
+ *
+ * Works on the files of the last scan, the status segment and the
+ * timeline shared by all users with the same schedule. Every input that
+ * is missing or stale (no cache, no status, no taskrc) leads to a run,
+ * the run rebuilds it.
+ *
+ * @param[in]	job	job of the user with the scanned files
+ *
+ * @retval	USER_IDLE	context matches the schedule, delayed or no zone
+ * @retval	USER_ACTION	a run is required
+ */
+USER_STATE evaluateUser(struct user_job *job)
+{
+	char status_name[STATUS_NAME_LEN] = {0};
+	char context[MAX_COMMAND] = {0};
+	struct scan_file *file = job->file;
+	struct cache_header header = {0};
+	struct compiled compiled;
+	struct status *status = NULL;
+	struct status snapshot = {0};
+	int zone = -1;
+	int valid = 0;
+
+	if((file[FILE_CONFIG].state != SCAN_CHANGED &&
+				file[FILE_CONFIG].state != SCAN_UNCHANGED) ||
+			file[FILE_TASKRC].data == NULL)
+		return USER_ACTION;
+	header.config = file[FILE_CONFIG].key;
+	header.taskrc = file[FILE_TASKRC].key;
+	header.base = job->base->key;
+	if(checkCache(file[FILE_CACHE].data, file[FILE_CACHE].size, &header,
+				&compiled) != 0)
+		return USER_ACTION;
+
+	if(compiled.config.delay.tm_year + compiled.config.delay.tm_mon > 0)
+		return USER_ACTION;
+
+	snprintf(status_name, STATUS_NAME_LEN, "/csw-%s", job->user->name);
+	if((status = openStatus(status_name, 0)) == NULL)
+		return USER_ACTION;
+	valid = readStatus(status, &snapshot) == 0;
+	closeStatus(status);
+	if(!valid || snapshot.error_code != 0)
+		return USER_ACTION;
+	if(snapshot.delay > job->rawtime)
+		return USER_IDLE;
+	if(snapshot.delay != 0)
+		return USER_ACTION;
+
+	if(job->schedule == NULL ||
+			job->schedule->hash != scheduleHash(&compiled.config)) {
+		releaseSchedule(job->schedules, job->schedule);
+		job->schedule = acquireSchedule(job->schedules, &compiled.config,
+				job->rawtime);
+	}
+	if(job->schedule == NULL ||
+			scheduleZone(job->schedules, job->schedule, job->rawtime, &zone) != 0)
+		return USER_ACTION;
+	if(zone == -1)
+		return USER_IDLE;
+
+	if(taskrcBuffer(file[FILE_TASKRC].data, file[FILE_TASKRC].size, "context",
+				context, MAX_COMMAND) != 0)
+		return USER_ACTION;
+
+	if(strncmp(compiled.config.zone_context[zone], context, MAX_COMMAND) == 0)
+		return USER_IDLE;
+	return USER_ACTION;
+}
+
+/**
+ * @brief	job of the evaluation pool, hands a required run to the deadline queue
+ *
+ * @param[in]	arg	struct user_job of the user
+ */
+void evaluateJob(void *arg)
+{
+	struct user_job *job = arg;
+
+	char line[MAX_ROW] = {0};
+
+	job->start = monotonicNs();
+	job->state = USER_ACTION;
+	if(job->flag->show == 0 && buildControl(job->flag, line) == 0)
+		job->state = evaluateUser(job);
+
+	if(job->state == USER_ACTION) {
+		/* without a spawn server the run waits for the end of the pool */
+		if(job->spawner == NULL)
+			return;
+		if(queueSubmit(job->actions, job->deadline, job->release, actionJob,
+					job) == 0)
+			return;
+		job->state = USER_FAILED;
+	}
+	job->latency = monotonicNs() - job->start;
+}
+
+/**
+ * @brief	job of the deadline queue, runs the scheduler as the user
+ *
+ * The run is forked by the spawn server if there is one. Without it the
+ * process forks itself, from runSequential once the pool is stopped.
+ *
+ * @param[in]	arg	struct user_job of the user
+ */
+void actionJob(void *arg)
+{
+	struct user_job *job = arg;
+	struct spawn_request request;
+	int status = 0;
+	pid_t pid = 0;
+
+	fflush(stdout);
+	if(job->spawner != NULL) {
+		request.user = *job->user;
+		request.flag = *job->flag;
+		request.rawtime = job->rawtime;
+		/* the server forked before the batch, the base travels along */
+		request.base = *job->base;
+		if(spawnRequest(job->spawner, &request, &status) != 0)
+			status = -1;
+	} else if((pid = startUser(job->user, job->flag, job->base,
+					job->rawtime)) == -1 || waitpid(pid, &status, 0) != pid) {
+		status = -1;
+	}
+	if(status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+		job->state = USER_FAILED;
+
+	job->finished = realtimeMs();
+	job->latency = monotonicNs() - job->start;
+}
+
+/**
+ * @brief	run the queued runs one after another from the calling thread
+ *
+ * A fork next to running threads copies the locks they hold (malloc,
+ * NSS) into the child. Without a spawn server the runs wait until the
+ * evaluation pool is stopped and run in the order of the deadline queue,
+ * each one after its release.
+ *
+ * @param[in,out]	queue	deadline queue without workers, emptied
+ */
+void runSequential(struct deadline_queue *queue)
+{
+	struct deadline_entry entry;
+	struct timespec pause;
+	long release = 0;
+	long now = 0;
+	int index = 0;
+
+	while(queue->amount > 0) {
+		now = realtimeMs();
+		if((index = releasedDeadline(queue, now, &release)) == -1) {
+			pause.tv_sec = (release - now) / 1000;
+			pause.tv_nsec = (release - now) % 1000 * 1000000L;
+			nanosleep(&pause, NULL);
+			continue;
+		}
+		removeDeadline(queue, index, &entry);
+		entry.run(entry.arg);
+	}
+	free(queue->heap);
+	queue->heap = NULL;
+	queue->capacity = 0;
+}
+
+/**
+ * @brief	place the run of a user on the deadline queue
+ *
+ * The jitter is a hash of the name of the user within HERD_JITTER
+ * seconds, the deadline is HERD_SLO seconds after the boundary. A run
+ * for an older boundary (retry, delay) has the earlier deadline.
+ *
+ * @param[in,out]	job	job of the user with rawtime set
+ * @param[in]	immediate	1 for the request of a user, no jitter
+ */
+void herdJob(struct user_job *job, int immediate)
+{
+	char *name = job->user->name;
+
+	job->boundary = (long)(job->rawtime / 60) * 60000L;
+	job->finished = 0;
+	if(immediate) {
+		job->release = realtimeMs();
+		job->deadline = job->release;
+		return;
+	}
+	job->release = job->boundary +
+		(long)(checksum(name, strnlen(name, MAX_USER)) % (HERD_JITTER * 1000U));
+	job->deadline = job->boundary + HERD_SLO * 1000L;
+}
+
+/**
+ * @brief	print the queue depth and the completion latency of the runs
+ *
+ * The completion latency is measured from the boundary to the end of the
+ * run, runs that end after HERD_SLO seconds missed the SLO.
+ *
+ * @param[in]	job	jobs of all users
+ * @param[in]	amount	number of jobs
+ * @param[in]	depth	highest number of queued runs
+ */
+void reportHerd(struct user_job *job, int amount, int depth)
+{
+	long *completion = calloc(amount, sizeof(long));
+	int runs = 0;
+	int missed = 0;
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(!job[i].due || job[i].finished == 0)
+			continue;
+		if(job[i].finished > job[i].deadline)
+			missed++;
+		if(completion != NULL)
+			completion[runs] = job[i].finished - job[i].boundary;
+		runs++;
+	}
+	printf("%d runs queued (depth %d), completion p99 %.3f s, %d over the SLO of %d s\n",
+			runs, depth, percentile(completion, completion ? runs : 0, 99) / 1e3,
+			missed, HERD_SLO);
+	free(completion);
+}
+
+/**
+ * @brief	evaluate the due users in parallel, run the ones that need it
+ *
+ * The files of the due users are scanned in one batch first, only the
+ * files that changed since the last scan are read again.
+ *
+ * @param[in,out]	job	jobs of all users, only jobs with due set are run
+ * @param[in]	amount	number of jobs
+ * @param[in]	immediate	1 for the request of a user, the runs skip the
+ * 				jitter
+ *
+ * @retval	number of failed users
+ * @retval	-1	the pools couldn't be started
+ */
+int runJobs(struct user_job *job, int amount, int immediate)
+{
+	struct scan_file **file = calloc((size_t)amount * SCAN_FILES,
+			sizeof(struct scan_file*));
+	struct base_layer base;
+	struct pool evaluation;
+	struct deadline_queue actions = {0};
+	struct deadline_entry entry;
+	int spawning = amount > 0 && job[0].spawner != NULL;
+	int changed = 0;
+	int failed = 0;
+	int files = 0;
+
+	if(file == NULL)
+		return -1;
+	for(int i = 0 ; i < amount ; i++) {
+		for(int kind = 0 ; job[i].due && kind < SCAN_FILES ; kind++)
+			file[files++] = &job[i].file[kind];
+	}
+	changed = scanFiles(file, files);
+	free(file);
+	/* the base is compiled once, the runs of the users inherit it */
+	if(loadBase(BASE_CONFIG, &base) == -1)
+		fprintf(stderr, "WARNING: base config %s unreadable\n", BASE_CONFIG);
+	if(verbose)
+		printf("%d files scanned, %d changed\n", files, changed);
+
+	if(poolCreate(&evaluation, sysconf(_SC_NPROCESSORS_ONLN), 0) != 0)
+		return -1;
+	if(spawning && queueCreate(&actions, ACTION_WORKERS) != 0) {
+		poolStop(&evaluation);
+		return -1;
+	}
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(!job[i].due)
+			continue;
+		job[i].actions = &actions;
+		job[i].base = &base;
+		job[i].rawtime = time(NULL);
+		job[i].latency = 0;
+		herdJob(&job[i], immediate);
+		if(poolSubmit(&evaluation, evaluateJob, &job[i]) != 0)
+			job[i].state = USER_FAILED;
+	}
+	poolWait(&evaluation);
+	if(spawning)
+		queueWait(&actions);
+	poolStop(&evaluation);
+
+	for(int i = 0 ; !spawning && i < amount ; i++) {
+		if(!job[i].due || job[i].state != USER_ACTION)
+			continue;
+		entry = (struct deadline_entry){.deadline = job[i].deadline,
+			.release = job[i].release, .run = actionJob, .arg = &job[i]};
+		if(pushDeadline(&actions, &entry) != 0)
+			job[i].state = USER_FAILED;
+	}
+	if(!spawning)
+		runSequential(&actions);
+
+	if(verbose && amount > 0) {
+		printf("%d distinct schedules, %d timelines built\n",
+				job[0].schedules->amount, job[0].schedules->builds);
+		reportHerd(job, amount, actions.depth);
+	}
+	queueStop(&actions);
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(job[i].due && job[i].state == USER_FAILED) {
+			fprintf(stderr, "ERROR: run for user %s failed\n", job[i].user->name);
+			failed++;
+		}
+	}
+	return failed;
+}
+
+/**
+ * @brief	print the result and latency of every due user and the p99
+ *
+ * @param[in]	job	jobs of all users
+ * @param[in]	amount	number of jobs
+ * @param[in]	elapsed	duration of the batch in ns
+ */
+void reportJobs(struct user_job *job, int amount, long elapsed)
+{
+	char *state_name[] = {"idle", "run", "failed"};
+	long *latency = calloc(amount, sizeof(long));
+	int counter[3] = {0};
+	int due = 0;
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(!job[i].due)
+			continue;
+		counter[job[i].state]++;
+		if(latency != NULL)
+			latency[due] = job[i].latency;
+		due++;
+		printf("user %s: %s in %.3f ms\n", job[i].user->name,
+				state_name[job[i].state], job[i].latency / 1e6);
+	}
+	printf("%d users: %d idle, %d runs, %d failed\n", due,
+			counter[USER_IDLE], counter[USER_ACTION], counter[USER_FAILED]);
+	printf("tick %.3f ms, p99 per user %.3f ms\n", elapsed / 1e6,
+			percentile(latency, latency ? due : 0, 99) / 1e6);
+	free(latency);
+}
+
+/**
+ * @brief	set the timers of a user after a run
+ *
+ * The transition timer fires at the next transition of the schedule of
+ * the user, the delay timer at the end of a delay. Without a schedule the
+ * user is evaluated again after BATCH_RETRY minutes.
+ *
+ * @param[in,out]	wheel	timer wheel of the daemon
+ * @param[in,out]	job	job of the user
+ * @param[in]	rawtime	current unix timestamp
+ */
+void scheduleUser(struct wheel *wheel, struct user_job *job, time_t rawtime)
+{
+	char status_name[STATUS_NAME_LEN] = {0};
+	struct status *status = NULL;
+	struct status snapshot = {0};
+	int minute = (int)(rawtime / 60);
+	int expiry = -1;
+
+	if(job->schedule != NULL)
+		expiry = scheduleNext(job->schedules, job->schedule, rawtime);
+	if(expiry <= minute)
+		expiry = minute + BATCH_RETRY;
+	addTimer(wheel, &job->timer[TIMER_TRANSITION], expiry);
+
+	cancelTimer(wheel, &job->timer[TIMER_DELAY]);
+	snprintf(status_name, STATUS_NAME_LEN, "/csw-%s", job->user->name);
+	if((status = openStatus(status_name, 0)) != NULL) {
+		if(readStatus(status, &snapshot) == 0 && snapshot.delay > rawtime)
+			addTimer(wheel, &job->timer[TIMER_DELAY], (int)((snapshot.delay + 59) / 60));
+		closeStatus(status);
+	}
+}
+
+/**
+ * @brief	run the scheduler for every user with a config
+ *
+ * @param[in]	flag	parsed command line options
+ * @param[in]	home_root	directory containing the home directories
+ *
+ * @retval	EXIT_SUCCESS	every run succeeded
+ * @retval	EXIT_FAILURE	discovery failed or at least one run failed
+ */
+int runUsers(struct flags *flag, char *home_root)
+{
+	struct schedule_table schedules;
+	struct spawner spawner;
+	struct user_list list;
+	struct user_job *job = NULL;
+	long start = monotonicNs();
+	int spawning = startSpawner(&spawner, spawnedUser) == 0;
+	int failed = 0;
+
+	initSchedules(&schedules);
+	job = prepareJobs(&list, flag, home_root, &schedules,
+			spawning ? &spawner : NULL);
+	if(job == NULL) {
+		stopSpawner(&spawner);
+		freeSchedules(&schedules);
+		return list.amount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	failed = runJobs(job, list.amount, 0);
+	if(verbose)
+		reportJobs(job, list.amount, monotonicNs() - start);
+
+	stopSpawner(&spawner);
+	releaseJobs(job, list.amount);
+	freeSchedules(&schedules);
+	freeUsers(&list);
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief	discover the users and prepare one due job per user
+ *
+ * @param[out]	list	discovered users, release with freeUsers
+ * @param[in]	flag	parsed command line options
+ * @param[in]	home_root	directory containing the home directories
+ * @param[in]	schedules	distinct schedules shared by the jobs
+ * @param[in]	spawner	spawn server for the runs (NULL to fork directly)
+ *
+ * @retval	array of jobs on the heap
+ * @retval	NULL	no users (list->amount is 0) or FAILURE
+ */
+struct user_job* prepareJobs(struct user_list *list, struct flags *flag,
+		char *home_root, struct schedule_table *schedules, struct spawner *spawner)
+{
+	struct user_job *job = NULL;
+
+	if(discoverUsers(list, home_root) == -1) {
+		fprintf(stderr, "ERROR: discovery of the users failed\n");
+		list->amount = -1;
+		return NULL;
+	}
+	if(verbose)
+		printf("%d users with a config found\n", list->amount);
+	if(list->amount == 0)
+		return NULL;
+
+	if((job = calloc(list->amount, sizeof(struct user_job))) == NULL) {
+		freeUsers(list);
+		list->amount = -1;
+		return NULL;
+	}
+	for(int i = 0 ; i < list->amount ; i++) {
+		job[i].user = &list->user[i];
+		job[i].flag = flag;
+		job[i].home_root = home_root;
+		job[i].schedules = schedules;
+		job[i].spawner = spawner;
+		job[i].due = 1;
+		for(int kind = 0 ; kind < 2 ; kind++) {
+			job[i].timer[kind].owner = i;
+			job[i].timer[kind].kind = kind;
+		}
+		if(userFiles(&job[i]) != 0) {
+			releaseJobs(job, list->amount);
+			freeUsers(list);
+			list->amount = -1;
+			return NULL;
+		}
+	}
+	return job;
+}
+
+/**
+ * @brief	set the config, taskrc and cache of a user up for the scan
+ *
+ * The content of the config is read by the run of the user itself, the
+ * scan only needs its identity.
+ *
+ * @param[in,out]	job	job of the user
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int userFiles(struct user_job *job)
+{
+	char config_path[PATH_MAX] = {0};
+	char path[PATH_MAX] = {0};
+
+	if(userConfig(config_path, job->home_root, job->user->name) != 0 ||
+			setFile(&job->file[FILE_CONFIG], config_path, 0) != 0)
+		return -1;
+	snprintf(path, PATH_MAX, "%.*s/.taskrc", PATH_MAX-9, job->user->home);
+	if(setFile(&job->file[FILE_TASKRC], path, 1) != 0)
+		return -1;
+	if(cachePath(path, config_path) != 0 ||
+			setFile(&job->file[FILE_CACHE], path, 1) != 0)
+		return -1;
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void releaseJobs(struct user_job *job, int amount)
+{
+	for(int i = 0 ; job != NULL && i < amount ; i++) {
+		for(int kind = 0 ; kind < SCAN_FILES ; kind++)
+			releaseFile(&job[i].file[kind]);
+	}
+	free(job);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -0,0 +1,241 @@
+/**
+ * @file cache.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	compiled binary cache of the parsed config
+ *
+ * Reading the config and validating the contexts with taskwarrior is only
+ * required after an edit of the config or the taskrc. The result of the
+ * parser is stored in ~/.task/csw/config.bin, keyed by the identity
+ * (device, inode, size, mtime) of both files. On a cache hit a run costs
+ * two stat calls and one mmap.
+ */
+
+#define _DEFAULT_SOURCE
+#include <sys/mman.h>
+#include "include/cache.h"
+
+/**
+ * @brief	locate the cache file next to the config
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	path of the config of the user
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int cachePath(char *path, char *config_path)
+{
+	if(config_path == NULL || config_path[0] == '\0')
+		return -1;
+
+	snprintf(path, PATH_MAX, "%.*s.bin", PATH_MAX-5, config_path);
+	return 0;
+}
+
+/**
+ * @brief	read the identity of a file
+ *
+ * @param[in]	path	path of the file
+ * @param[out]	key	identity, all zero if the file doesn't exist
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	file doesn't exist
+ * @retval	-1	stat failed
+ */
+int fileKey(char *path, struct file_key *key)
+{
+	struct stat s;
+
+	memset(key, 0, sizeof(struct file_key));
+	if(stat(path, &s) != 0)
+		return errno == ENOENT ? 1 : -1;
+
+	key->device = s.st_dev;
+	key->inode = s.st_ino;
+	key->size = s.st_size;
+	key->mtime = s.st_mtim.tv_sec;
+	key->mtime_nsec = s.st_mtim.tv_nsec;
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int sameKey(struct file_key *first, struct file_key *second)
+{
+	return first->device == second->device && first->inode == second->inode &&
+		first->size == second->size && first->mtime == second->mtime &&
+		first->mtime_nsec == second->mtime_nsec;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	FNV-1a checksum of a memory area
+ *
+ * @param[in]	data	start of the memory area
+ * @param[in]	size	size of the memory area in bytes
+ *
+ * @retval	checksum
+ */
+unsigned int checksum(const void *data, size_t size)
+{
+	return extendChecksum(2166136261u, data, size);
+}
+
+/**
+ * @brief	continue a FNV-1a checksum with another memory area
+ *
+ * @param[in]	hash	checksum of the preceding areas
+ * @param[in]	data	start of the memory area
+ * @param[in]	size	size of the memory area in bytes
+ *
+ * @retval	checksum
+ */
+unsigned int extendChecksum(unsigned int hash, const void *data, size_t size)
+{
+	const unsigned char *byte = data;
+
+	for(size_t i = 0 ; i < size ; i++) {
+		hash ^= byte[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * @brief	validate the content of a cache and copy the compiled config
+ *
+ * @param[in]	data	content of the cache file
+ * @param[in]	size	number of bytes in data
+ * @param[in]	expected	header with the keys of the current files
+ * @param[out]	compiled	parsed config and parse errors
+ *
+ * @retval	0	cache hit
+ * @retval	1	cache stale or corrupted
+ */
+int checkCache(const void *data, size_t size, struct cache_header *expected,
+		struct compiled *compiled)
+{
+	const struct cache_header *header = data;
+
+	if(data == NULL ||
+			size != sizeof(struct cache_header) + sizeof(struct compiled))
+		return 1;
+
+	if(memcmp(header->magic, CACHE_MAGIC, 4) != 0 ||
+			header->version != CACHE_VERSION ||
+			header->size != sizeof(struct compiled) ||
+			!sameKey((struct file_key*)&header->config, &expected->config) ||
+			!sameKey((struct file_key*)&header->taskrc, &expected->taskrc) ||
+			!sameKey((struct file_key*)&header->base, &expected->base) ||
+			header->checksum != checksum(header + 1, sizeof(struct compiled)))
+		return 1;
+
+	memcpy(compiled, header + 1, sizeof(struct compiled));
+	return 0;
+}
+
+/**
+ * @brief	map the cache and copy the compiled config if the cache is valid
+ *
+ * @param[in]	path	location of the cache
+ * @param[in]	expected	header with the keys of the current files
+ * @param[out]	compiled	parsed config and parse errors
+ *
+ * @retval	0	cache hit
+ * @retval	1	cache missing, stale or corrupted
+ */
+int loadCache(char *path, struct cache_header *expected, struct compiled *compiled)
+{
+	struct stat s;
+	size_t size = sizeof(struct cache_header) + sizeof(struct compiled);
+	void *mapping = NULL;
+	int result = 1;
+	int fd = -1;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+		return 1;
+
+	if(fstat(fd, &s) != 0 || (size_t)s.st_size != size) {
+		close(fd);
+		return 1;
+	}
+	mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapping == MAP_FAILED)
+		return 1;
+
+	result = checkCache(mapping, size, expected, compiled);
+	munmap(mapping, size);
+	return result;
+}
+
+/**
+ * @brief	read the key of the taskrc a cache was compiled with
+ *
+ * @param[in]	path	location of the cache
+ * @param[out]	taskrc	key of the taskrc stored in the cache
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	cache missing or too short
+ */
+int cacheTaskrc(char *path, struct file_key *taskrc)
+{
+	struct cache_header header;
+	int fd = -1;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+		return 1;
+	if(read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)) {
+		close(fd);
+		return 1;
+	}
+	close(fd);
+	*taskrc = header.taskrc;
+	return 0;
+}
+
+/**
+ * @brief	write the compiled config to the cache
+ *
+ * The cache is written to a temporary file and renamed, a concurrent
+ * reader sees either the old or the new cache.
+ *
+ * @param[in]	path	location of the cache
+ * @param[in]	header	header with the keys of the current files
+ * @param[in]	compiled	parsed config and parse errors
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int storeCache(char *path, struct cache_header *header, struct compiled *compiled)
+{
+	char tmp_name[PATH_MAX] = {0};
+	int fd = -1;
+
+	memcpy(header->magic, CACHE_MAGIC, 4);
+	header->version = CACHE_VERSION;
+	header->size = sizeof(struct compiled);
+	header->checksum = checksum(compiled, sizeof(struct compiled));
+
+	snprintf(tmp_name, PATH_MAX, "%.*s.XXXXXX", PATH_MAX-8, path);
+	fd = mkstemp(tmp_name);
+	if(fd == -1)
+		return -1;
+
+	if(write(fd, header, sizeof(struct cache_header)) !=
+			(ssize_t)sizeof(struct cache_header) ||
+			write(fd, compiled, sizeof(struct compiled)) !=
+			(ssize_t)sizeof(struct compiled)) {
+		close(fd);
+		unlink(tmp_name);
+		return -1;
+	}
+	close(fd);
+	if(rename(tmp_name, path) != 0) {
+		unlink(tmp_name);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file champion.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	find active tasks in the replica of taskwarrior 3 (TaskChampion)
+ *
+ * Taskwarrior 3 keeps the tasks in taskchampion.sqlite3 within the data
+ * directory, the properties of a task are a JSON object in tasks.data.
+ * The pending tasks are listed in working_set, so the active tasks are
+ * found by joining the working set with the primary key of tasks. The
+ * replica is opened read-only, taskwarrior may write it at the same time.
+ *
+ * The backend is optional (HAVE_SQLITE, set by the Makefile if sqlite3 is
+ * installed), without it a replica is answered by taskwarrior itself.
+ */
+
+#define _DEFAULT_SOURCE
+#include <unistd.h>
+#include "include/champion.h"
+
+#ifdef HAVE_SQLITE
+#include <sqlite3.h>
+
+/**
+ * @brief	query of the active tasks, limited to the requested amount
+ */
+#define ACTIVE_QUERY \
+	"SELECT tasks.uuid FROM working_set JOIN tasks ON tasks.uuid = working_set.uuid" \
+	" WHERE json_extract(tasks.data, '$.status') = 'pending'" \
+	" AND json_extract(tasks.data, '$.start') IS NOT NULL LIMIT ?1"
+
+/**
+ * @brief	query of the attributes of the active tasks, tags are tag_<name> keys
+ */
+#define DETAIL_QUERY \
+	"SELECT tasks.uuid, json_extract(tasks.data, '$.project')," \
+	" json_extract(tasks.data, '$.modified'), (SELECT group_concat(substr(key, 5), ',')" \
+	" FROM json_each(tasks.data) WHERE key LIKE 'tag\\_%' ESCAPE '\\')" \
+	" FROM working_set JOIN tasks ON tasks.uuid = working_set.uuid" \
+	" WHERE json_extract(tasks.data, '$.status') = 'pending'" \
+	" AND json_extract(tasks.data, '$.start') IS NOT NULL LIMIT ?1"
+
+sqlite3_stmt* prepareReplica(char*, char*, int, sqlite3**);
+
+/**
+ * @brief	open the replica read-only and prepare a query with a limit
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ * @param[in]	sql	query with the limit as first parameter
+ * @param[in]	max	limit of the query
+ * @param[out]	db	connection, closed by the caller (also on failure)
+ *
+ * @retval	prepared query
+ * @retval	NULL	FAILURE
+ */
+sqlite3_stmt* prepareReplica(char *directory, char *sql, int max, sqlite3 **db)
+{
+	char path[PATH_MAX] = {0};
+	sqlite3_stmt *query = NULL;
+
+	snprintf(path, PATH_MAX, "file:%.*s/taskchampion.sqlite3?mode=ro",
+			PATH_MAX - 35, directory);
+	if(sqlite3_open_v2(path, db, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, NULL)
+			!= SQLITE_OK)
+		return NULL;
+	/* taskwarrior may hold a write transaction for a moment */
+	sqlite3_busy_timeout(*db, CHAMPION_BUSY);
+	if(sqlite3_prepare_v2(*db, sql, -1, &query, NULL) != SQLITE_OK)
+		return NULL;
+	if(sqlite3_bind_int(query, 1, max) != SQLITE_OK) {
+		sqlite3_finalize(query);
+		return NULL;
+	}
+	return query;
+}
+#endif /* HAVE_SQLITE */
+
+/**
+ * @brief	pick the source of the active tasks from the data directory
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ *
+ * @retval	BACKEND_CHAMPION	taskchampion.sqlite3 with sqlite support
+ * @retval	BACKEND_PENDING	pending.data of taskwarrior 2.x
+ * @retval	BACKEND_TASK	ask taskwarrior
+ */
+TASK_BACKEND taskBackend(char *directory)
+{
+	char path[PATH_MAX] = {0};
+
+	snprintf(path, PATH_MAX, "%.*s/taskchampion.sqlite3", PATH_MAX - 22, directory);
+	if(access(path, R_OK) == 0) {
+#ifdef HAVE_SQLITE
+		return BACKEND_CHAMPION;
+#else
+		return BACKEND_TASK;
+#endif /* HAVE_SQLITE */
+	}
+
+	snprintf(path, PATH_MAX, "%.*s/pending.data", PATH_MAX - 14, directory);
+	if(access(path, R_OK) == 0)
+		return BACKEND_PENDING;
+	return BACKEND_TASK;
+}
+
+/**
+ * @brief	collect the active tasks of a taskwarrior 3 replica
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ * @param[out]	uuid	UUIDs of the active tasks (NULL to count only)
+ * @param[in]	max	stop after max active tasks (1 to check for existence)
+ *
+ * @retval	number of active tasks, at most max
+ * @retval	-1	no readable replica or no sqlite support
+ */
+int championActive(char *directory, char (*uuid)[UUID_LEN], int max)
+{
+#ifdef HAVE_SQLITE
+	sqlite3 *db = NULL;
+	sqlite3_stmt *query = NULL;
+	int found = -1;
+	int step = 0;
+
+	if((query = prepareReplica(directory, ACTIVE_QUERY, max, &db)) == NULL)
+		goto champion_done;
+
+	found = 0;
+	while((step = sqlite3_step(query)) == SQLITE_ROW) {
+		if(uuid != NULL)
+			snprintf(uuid[found], UUID_LEN, "%s",
+					(const char*)sqlite3_column_text(query, 0));
+		found++;
+	}
+	if(step != SQLITE_DONE)
+		found = -1;
+
+	champion_done:
+		sqlite3_finalize(query);
+		sqlite3_close(db);
+		return found;
+#else
+	(void)directory;
+	(void)uuid;
+	(void)max;
+	return -1;
+#endif /* HAVE_SQLITE */
+}
+
+/**
+ * @brief	read the attributes of the active tasks of a taskwarrior 3 replica
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ * @param[out]	task	attributes of the active tasks
+ * @param[in]	max	stop after max active tasks
+ *
+ * @retval	number of active tasks, at most max
+ * @retval	-1	no readable replica or no sqlite support
+ */
+int championTasks(char *directory, struct active_task *task, int max)
+{
+#ifdef HAVE_SQLITE
+	sqlite3 *db = NULL;
+	sqlite3_stmt *query = NULL;
+	const unsigned char *value = NULL;
+	int found = -1;
+	int step = 0;
+
+	if((query = prepareReplica(directory, DETAIL_QUERY, max, &db)) == NULL)
+		goto details_done;
+
+	found = 0;
+	while((step = sqlite3_step(query)) == SQLITE_ROW) {
+		snprintf(task[found].uuid, UUID_LEN, "%s",
+				(const char*)sqlite3_column_text(query, 0));
+		value = sqlite3_column_text(query, 1);
+		snprintf(task[found].project, MAX_FIELD, "%s",
+				value != NULL ? (const char*)value : "");
+		task[found].modified = (long)sqlite3_column_int64(query, 2);
+		value = sqlite3_column_text(query, 3);
+		snprintf(task[found].tags, MAX_ROW, "%s",
+				value != NULL ? (const char*)value : "");
+		found++;
+	}
+	if(step != SQLITE_DONE)
+		found = -1;
+
+	details_done:
+		sqlite3_finalize(query);
+		sqlite3_close(db);
+		return found;
+#else
+	(void)directory;
+	(void)task;
+	(void)max;
+	return -1;
+#endif /* HAVE_SQLITE */
+}
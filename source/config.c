@@ -2,7 +2,7 @@
  * @file config.c
  * @author	Sebastian Fricke
  *
- * @brief	find,read,parse,sync & write a config file
+ * @brief	find,read,parse & sync a config file
  */
 
 #include "include/config.h"
@@ -12,6 +12,9 @@ extern int mkstemp(char *template);
 extern int unlink(const char *pathname);
 #endif
 
+char* splitHook(char*);
+OPTION_STATE storeOption(struct configcontent*, char*, char*, int);
+
 /**
  * @brief find the file within the expected location
  *
@@ -96,11 +99,43 @@ FILE_STATE findConfig(char* name, char* path)
 	}
 }
 
+/**
+ * @brief	split the command of a hook from the rest of the row
+ *
+ * The command of a Hook= runs until the end of the row, it may contain
+ * ';' and '='.
+ *
+ * @param[in,out]	row	row of the config, ends before the hook
+ *
+ * @retval	command of the hook
+ * @retval	NULL	the row has no hook
+ */
+char* splitHook(char *row)
+{
+	char title[6] = {0};
+
+	for(char *part = row ; part != NULL ; part = strchr(part, ';')) {
+		if(*part == ';')
+			part++;
+		snprintf(title, 6, "%s", part);
+		lowerCase(title, 5);
+		if(strncmp(title, "hook=", 6) != 0)
+			continue;
+		if(part != row)
+			part[-1] = '\0';
+		else
+			part[0] = '\0';
+		return part + 5;
+	}
+	return NULL;
+}
+
 /**
  * @brief	read the config file in .task/csw and fill the config struct
  *
  * ZONE={NAME};START={Start_t};END={End_t};CONTEXT={context option from tw};
- * ';' the option separator , '=' the value separator
+ * ';' the option separator , '=' the value separator, a HOOK={command}
+ * takes the rest of the row
  *
  * @param[in]	path	path to the config file
  * @param[out]	config	pointer to heap allocated struct
@@ -115,8 +150,8 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
 						char* path)
 {
 	FILE *config_file = NULL;
-	struct substr *option[MAX_ZONES+MAX_EXCLUSION+4] = {NULL};
-	char row[MAX_ZONES+MAX_EXCLUSION+4][MAX_ROW] = {{0}};
+	struct substr *option[MAX_CONFIG_ROWS+1] = {NULL};
+	char row[MAX_CONFIG_ROWS+1][MAX_ROW] = {{0}};
 	char err_msg[MAX_ROW] = {0};
 	int eof = 0;
 	int ferr = 0;
@@ -124,6 +159,9 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
 	OPTION_STATE state = 0;
 	int substr_state = 0;
 	int rows = 0;
+	int dropped = 0;
+	int line_start = 1;
+	char *hook = NULL;
 	errno = 0;
 
 	config_file = fopen(path, "r");
@@ -131,7 +169,7 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
 		return CONFIG_NOTFOUND;
 	}
 
-	for(int i = 0 ; i < MAX_ZONES+MAX_EXCLUSION+4 ; i++) {
+	for(int i = 0 ; i < MAX_CONFIG_ROWS+1 ; i++) {
 		memset(row[i], 0, MAX_ROW);
 	}
 
@@ -150,19 +188,45 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
 		if(strnlen(row[rows], MAX_ROW) > 0)
 			rows++;
 
-		if(rows == MAX_ZONES+MAX_EXCLUSION+3)
+		if(rows == MAX_CONFIG_ROWS)
 			break;
 
 		errno = 0;
 	}
 
+	/* the spare row takes the rest of the file, to count the dropped rows */
+	while(rows == MAX_CONFIG_ROWS &&
+			fgets(row[rows], MAX_ROW, config_file) != NULL) {
+		if(line_start && row[rows][0] != '\n')
+			dropped++;
+		line_start = strchr(row[rows], '\n') != NULL;
+	}
+	memset(row[MAX_CONFIG_ROWS], 0, MAX_ROW);
+	if(dropped > 0) {
+		snprintf(err_msg, MAX_ROW, "%d rows beyond the limit of %d rows dropped",
+				dropped, MAX_CONFIG_ROWS);
+		addError(error, -12, err_msg, MAX_CONFIG_ROWS);
+	}
+
 	for(int i = 0 ; i < rows ; i++) {
 		amount = 0;
+		hook = splitHook(row[i]);
 		if(strnlen(row[i], MAX_ROW) > MAX_FIELD) {
 			fprintf(stderr,"Row %d of Config, longer than the limit of: %d\n",
 					i+1, MAX_FIELD);
 			continue;
 		}
+		if(hook != NULL && strnlen(hook, MAX_ROW) >= MAX_OPTION) {
+			snprintf(err_msg, MAX_ROW, "Hook longer than %d characters",
+					MAX_OPTION - 1);
+			addError(error, -13, err_msg, i);
+			hook = NULL;
+		}
+		if(row[i][0] == '\0') {
+			if(hook != NULL && storeOption(config, "hook", hook, i) != OPTION_SUCCESS)
+				addError(error, -3, "No option or memory full(hook)", i);
+			continue;
+		}
 		option[i] = allocateSubstring(option[i]);
 		if((substr_state=getSubstring(row[i], option[i], &amount, ';')) != 0) {
 			fprintf(stderr,"ERROR: reading substrings failed %d!\n",
@@ -192,6 +256,9 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
 					break;
 			}
 		}
+		/* the hook of a zone follows its other options */
+		if(hook != NULL && storeOption(config, "hook", hook, i) != OPTION_SUCCESS)
+			addError(error, -3, "No option or memory full(hook)", i);
 	}
 
 	read_success:
@@ -212,6 +279,8 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
  * @li	zone, start, end, context
  * @li	exclude
  * @li	delay, cancel, notify
+ * @li	interval, state, database
+ * @li	profile, hook
  *
  * @param[in]	option	the string to parse
  * @param[in]	index	the current line in the config
@@ -226,12 +295,11 @@ CONFIG_STATE readConfig(struct configcontent* config, struct error* error,
 OPTION_STATE getOption(struct configcontent *config, char *option, int index)
 {
 	struct substr *sub_option = NULL;
-	int current = 0;
-	int sub = 0;
+	OPTION_STATE state = 0;
 	int amount = 0;
 	char valid_titles[VALID_OPTIONS][MAX_OPTION_NAME] = {
 		"zone", "start", "end", "context", "delay", "cancel",
-		"exclude", "notify", "interval"
+		"exclude", "notify", "interval", "state", "database", "profile", "hook"
 	};
 
 	sub_option = allocateSubstring(sub_option);
@@ -258,21 +326,10 @@ OPTION_STATE getOption(struct configcontent *config, char *option, int index)
 	for(int i = 0 ; i < VALID_OPTIONS ; i++) {
 		if(strncmp(sub_option->member, valid_titles[i], MAX_OPTION_NAME) == 0){
 			if(sub_option->next != NULL) {
-				if(indexInList(config, index) != 0) {
-					config->amount += 1;
-					current = config->amount-1;
-					config->rowindex[current] = index;
-				} else {
-					current = config->amount-1;
-				}
-				config->sub_option_amount[current] += 1;
-				sub = config->sub_option_amount[current]-1;
-				strncpy(config->option_name[current][sub],
-						sub_option->member, MAX_OPTION_NAME);
-				strncpy(config->option_value[current][sub],
-						sub_option->next->member, MAX_OPTION);
-
-				goto option_good;
+				state = storeOption(config, sub_option->member,
+						sub_option->next->member, index);
+				freeSubstring(sub_option);
+				return state;
 			} else {
 				goto option_novalue;
 			}
@@ -280,10 +337,6 @@ OPTION_STATE getOption(struct configcontent *config, char *option, int index)
 	}
 	goto option_notfound;
 
-	option_good:
-		freeSubstring(sub_option);
-		return OPTION_SUCCESS;
-
 	option_notfound:
 		freeSubstring(sub_option);
 		return OPTION_NOTFOUND;
@@ -293,6 +346,41 @@ OPTION_STATE getOption(struct configcontent *config, char *option, int index)
 		return OPTION_NOVALUE;
 }
 
+/**
+ * @brief	append an option to the row of the configcontent
+ *
+ * @param[out]	config	the pointer to the configcontent structure
+ * @param[in]	name	title of the option in lower case
+ * @param[in]	value	value of the option
+ * @param[in]	index	the current line in the config
+ *
+ * @retval OPTION_SUCCESS	option stored
+ * @retval OPTION_ERROR	no room for another row or option
+ */
+OPTION_STATE storeOption(struct configcontent *config, char *name, char *value,
+		int index)
+{
+	int current = 0;
+	int sub = 0;
+
+	if(indexInList(config, index) != 0) {
+		if(config->amount == MAX_AMOUNT_OPTIONS)
+			return OPTION_ERROR;
+		config->amount += 1;
+		current = config->amount-1;
+		config->rowindex[current] = index;
+	} else {
+		current = config->amount-1;
+	}
+	if(config->sub_option_amount[current] == MAX_SUBOPTIONS)
+		return OPTION_ERROR;
+	config->sub_option_amount[current] += 1;
+	sub = config->sub_option_amount[current]-1;
+	strncpy(config->option_name[current][sub], name, MAX_OPTION_NAME);
+	strncpy(config->option_value[current][sub], value, MAX_OPTION);
+	return OPTION_SUCCESS;
+}
+
 /**
  * @brief	Checks if the index of a row is within the set of configcontent
  *
@@ -381,74 +469,56 @@ int syncConfig(struct config *config, struct flags *flag,struct tm *time)
 }
 
 /**
- * @brief	write the current state of the config structure to a file
+ * @brief	capture the options and translate them to the config structure
+ *
+ * Parse the different options and fill the error structure whenever a option
+ * has a incorrect format.
  *
- * @param[in]	config	pointer to the config structure containing the parsed options
- * @param[in]	path	string containing the path to the file
+ * @param[in]	content	configcontent structure pointer from readConfig()
+ * @param[out]	error	error structure pointer
+ * @param[out]	config	config structure pointer for the parse output
  *
- * @retval	0	the content was successfully written to the file
- * @retval	-1	error encountered while writing to the file	
+ * @retval	0	SUCCESS
+ * @retval -1	FAILURE
  */
-int writeConfig(struct config* config, char* path)
+int parseConfig(struct configcontent *content, struct error* error,
+		struct config* config)
 {
-	char tmp_name[PATH_MAX] = {"/tmp/.config_write"};
-	char buffer[MAX_ROW] = {0};
-	FILE* new_file = NULL;
-
+	struct context *context = NULL;
+	int result = 0;
 
-	errno = 0;
-	new_file = fopen(tmp_name, "w");
-	if(!new_file)
+	context = initContext(context);
+	if(!context)
 		return -1;
 
-	for(int i = 0 ; i < config->zone_amount ; i++) {
-		snprintf(buffer, MAX_ROW, "Zone=%s;Start=%02d:%02d;End=%02d:%02d;Context=%s\n",
-				config->zone_name[i], config->ztime[i].start_hour,
-				config->ztime[i].start_minute, config->ztime[i].end_hour,
-				config->ztime[i].end_minute, config->zone_context[i]);
-		fprintf(new_file, "%s", buffer);
-	}
-	for(int i = 0 ; i < config->excl.amount ; i++) {
-		buildExclFormat(&config->excl.type[i], config->excl.type_name[i], buffer);
-		fprintf(new_file, "%s", buffer);
-	}
-	if(config->delay.tm_year + config->delay.tm_mon + config->delay.tm_mday > 0) {
-		buildDelayFormat(&config->delay, buffer);
-		fprintf(new_file, "%s", buffer);
-	}
-	buildBoolFormat(config->cancel, "Cancel", buffer);
-	fprintf(new_file, "%s", buffer);
-	buildBoolFormat(config->notify, "Notify", buffer);
-	fprintf(new_file, "%s", buffer);
-	snprintf(buffer, MAX_ROW, "Interval=%dmin\n", config->interval);
-	fprintf(new_file, "%s", buffer);
-	fclose(new_file);
-	remove(path);
-	rename(tmp_name, path);
-	return 0;
+	result = parseLayer(content, error, config, context);
+	free(context);
+	return result;
 }
 
 /**
- * @brief	capture the options and translate them to the config structure
+ * @brief	parse the options on top of the given config
  *
- * Parse the different options and fill the error structure whenever a option
- * has a incorrect format.
+ * Zones and exclusions are appended to the config, the other options
+ * replace the value of the config. A hook in the row of a zone belongs to
+ * that zone, any other hook runs on every transition.
  *
  * @param[in]	content	configcontent structure pointer from readConfig()
  * @param[out]	error	error structure pointer
- * @param[out]	config	config structure pointer for the parse output
+ * @param[in,out]	config	config structure pointer for the parse output
+ * @param[in]	context	contexts of taskwarrior, NULL to accept every context
+ * 				(the system-wide base is validated per user)
  *
  * @retval	0	SUCCESS
- * @retval -1	FAILURE
  */
-int parseConfig(struct configcontent *content, struct error* error,
-		struct config* config)
+int parseLayer(struct configcontent *content, struct error* error,
+		struct config* config, struct context *context)
 {
 	char msg[MAX_ROW] = {0};
 	int value = 0;
 	int result = 0;
 	int zamount = config->zone_amount;
-	struct context *context = NULL;
+	int first_zone = config->zone_amount;
 	char temp_name[MAX_OPTION] = {0};
 	char temp_context[MAX_CONTEXT] = {0};
 	struct zonetime temp_time = {0};
@@ -462,24 +532,22 @@ int parseConfig(struct configcontent *content, struct error* error,
 		{"cancel", FIND_CANCEL},
 		{"notify", FIND_NOTIFY},
 		{"interval", FIND_INTERVAL},
-		{"exclude", FIND_EXCLUDE}
+		{"exclude", FIND_EXCLUDE},
+		{"state", FIND_STATE},
+		{"database", FIND_DATABASE},
+		{"profile", FIND_PROFILE},
+		{"hook", FIND_HOOK}
 	};
 
-	context = initContext(context);
-	if(!context)
-		return -1;
-
 	for(int i = 0 ; i < content->amount ; i++) {
 		for(int j = 0 ; j < content->sub_option_amount[i] ; j++) {
 			value = valueForKey(&lookuptable[0], content->option_name[i][j]);
 			if(zoneValidation(temp_name, &temp_time,
 						temp_context) == 0) {
-				strncpy(config->zone_name[zamount],
-						temp_name,
-						MAX_OPTION);
-				strncpy(config->zone_context[zamount],
-						temp_context,
-						MAX_OPTION);
+				snprintf(config->zone_name[zamount], MAX_FIELD, "%.*s",
+						MAX_FIELD - 1, temp_name);
+				snprintf(config->zone_context[zamount], MAX_COMMAND, "%s",
+						temp_context);
 				config->ztime[zamount].start_hour = temp_time.start_hour;
 				config->ztime[zamount].start_minute = temp_time.start_minute;
 				config->ztime[zamount].end_hour = temp_time.end_hour;
@@ -520,7 +588,7 @@ int parseConfig(struct configcontent *content, struct error* error,
 					}
 					continue;
 				case FIND_CONTEXT:
-					result = contextValidation(context,
+					result = context == NULL ? 0 : contextValidation(context,
 										content->option_value[i][j]);
 					if(result == 0) {
 						strncpy(temp_context,
@@ -596,11 +664,66 @@ int parseConfig(struct configcontent *content, struct error* error,
 						continue;
 					}
 					continue;
+				case FIND_STATE:
+					result = strncmp(content->option_value[i][j], "persistent", 11);
+					if(result == 0)
+						config->persistent = 1;
+					else
+						config->persistent = 0;
+
+					continue;
+				case FIND_DATABASE:
+					result = strncmp(content->option_value[i][j], "large", 6);
+					if(result == 0)
+						config->large = 1;
+					else
+						config->large = 0;
+
+					continue;
+				case FIND_PROFILE:
+					if(config->profile_amount == MAX_PROFILES) {
+						snprintf(msg, MAX_ROW, "Too many profiles:%s",
+								content->option_value[i][j]);
+						addError(error, -10, msg, content->rowindex[i]);
+						continue;
+					}
+					snprintf(config->profile[config->profile_amount++], MAX_OPTION,
+							"%s", content->option_value[i][j]);
+					continue;
+				case FIND_HOOK:
+					/* the hook of a zone is assigned once the zone is complete */
+					if(strncmp(content->option_name[i][0], "zone", 5) == 0)
+						continue;
+					if(config->hook_amount == MAX_HOOKS) {
+						snprintf(msg, MAX_ROW, "Too many hooks:%s",
+								content->option_value[i][j]);
+						addError(error, -11, msg, content->rowindex[i]);
+						continue;
+					}
+					snprintf(config->hook[config->hook_amount++], MAX_OPTION,
+							"%s", content->option_value[i][j]);
+					continue;
+			}
+		}
+	}
+
+	for(int i = 0 ; i < content->amount ; i++) {
+		if(strncmp(content->option_name[i][0], "zone", 5) != 0)
+			continue;
+		for(int j = 1 ; j < content->sub_option_amount[i] ; j++) {
+			if(strncmp(content->option_name[i][j], "hook", 5) != 0)
+				continue;
+			for(int zone = config->zone_amount - 1 ; zone >= first_zone ; zone--) {
+				if(strncmp(config->zone_name[zone], content->option_value[i][0],
+							MAX_FIELD) != 0)
+					continue;
+				snprintf(config->zone_hook[zone], MAX_OPTION, "%s",
+						content->option_value[i][j]);
+				break;
 			}
 		}
 	}
 
-	free(context);
 	return 0;
 }
 
@@ -612,7 +735,7 @@ int parseConfig(struct configcontent *content, struct error* error,
  *
  * @param[in]	value	the boolean either 0 or 1
  * @param[in]	type	the option type either 'Cancel' or 'Notify'
- * @param[out]	str	the format string used in the writeConfig function
+ * @param[out]	str	the format string used in the records of the journal
  */
 void buildBoolFormat(int value, char *type, char *str)
 {
@@ -635,6 +758,8 @@ void addError(struct error *error, int error_code, char *error_msg, int index)
 {
 	int current = error->amount;
 
+	if(current >= MAX_AMOUNT_OPTIONS)
+		return;
 	error->error_code[current] = error_code;
 	strncpy(error->error_msg[current], error_msg, MAX_ROW);
 	error->rowindex[current] = index;
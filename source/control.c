@@ -0,0 +1,410 @@
+/**
+ * @file control.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	apply command line mutations within the running daemon
+ *
+ * A request is a single line of ';' separated commands:
+ * @li	delay {time-span}
+ * @li	cancel {0|1}
+ * @li	notify {0|1}
+ * @li	interval {minutes}
+ * @li	switch
+ *
+ * The daemon answers with "ok" or "error {description}" and closes the
+ * connection. The client tries the daemon of the user first, then the
+ * multi-user daemon at SYSTEM_CONTROL, which applies the request for the
+ * user id of the peer. Without a listening daemon the command line client
+ * falls back to the local run.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "include/control.h"
+
+/**
+ * @brief	create the listening socket and register it at the epoll instance
+ *
+ * @param[out]	server	control server instance
+ * @param[in]	epoll	epoll instance of the daemon
+ * @param[in]	path	location of the socket
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int openControl(struct control_server *server, int epoll, char *path)
+{
+	struct sockaddr_un address = {0};
+	struct epoll_event event = {0};
+
+	if(server == NULL || path == NULL ||
+			strnlen(path, PATH_MAX) >= sizeof(address.sun_path))
+		return -1;
+
+	memset(server, 0, sizeof(struct control_server));
+	for(int i = 0 ; i < MAX_CONTROL ; i++)
+		server->client[i].fd = -1;
+	server->epoll = epoll;
+	strncpy(server->path, path, PATH_MAX-1);
+
+	server->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(server->fd == -1)
+		return -1;
+
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path)-1);
+	unlink(path);
+	if(bind(server->fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+		goto open_failed;
+
+	if(listen(server->fd, MAX_CONTROL) != 0)
+		goto open_failed;
+
+	event.events = EPOLLIN;
+	event.data.fd = server->fd;
+	if(epoll_ctl(epoll, EPOLL_CTL_ADD, server->fd, &event) != 0)
+		goto open_failed;
+
+	return 0;
+
+	open_failed:
+		close(server->fd);
+		server->fd = -1;
+		return -1;
+}
+
+/**
+ * @brief	close pending connections and remove the listening socket
+ *
+ * @param[in]	server	control server instance
+ */
+void closeControl(struct control_server *server)
+{
+	if(server == NULL || server->fd == -1)
+		return;
+
+	for(int i = 0 ; i < MAX_CONTROL ; i++) {
+		if(server->client[i].fd != -1)
+			dropControl(server, i);
+	}
+	close(server->fd);
+	unlink(server->path);
+	server->fd = -1;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void dropControl(struct control_server *server, int index)
+{
+	struct control_client *client = &server->client[index];
+
+	epoll_ctl(server->epoll, EPOLL_CTL_DEL, client->fd, NULL);
+	close(client->fd);
+	client->fd = -1;
+	client->length = 0;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	handle the readiness of a socket that belongs to the control server
+ *
+ * Accept new connections and collect the request line, a complete line is
+ * parsed into the request flags.
+ *
+ * @param[in]	server	control server instance
+ * @param[in]	fd	the ready file descriptor
+ * @param[in]	events	the epoll events for the descriptor
+ * @param[out]	request	flags of a complete request
+ * @param[out]	index	slot of the client that sent the request
+ *
+ * @retval	CONTROL_REQUEST	request complete, reply with replyControl
+ * @retval	CONTROL_HANDLED	descriptor handled, nothing to execute
+ * @retval	CONTROL_IGNORED	descriptor doesn't belong to the control server
+ */
+CONTROL_STATE handleControl(struct control_server *server, int fd,
+		unsigned int events, struct flags *request, int *index)
+{
+	struct epoll_event event = {0};
+	struct control_client *client = NULL;
+	struct ucred credentials = {0};
+	socklen_t credentials_len = sizeof(credentials);
+	char *newline = NULL;
+	ssize_t length = 0;
+	int connection = -1;
+	int slot = -1;
+
+	if(server == NULL || server->fd == -1)
+		return CONTROL_IGNORED;
+
+	if(fd == server->fd) {
+		while((connection = accept4(server->fd, NULL, NULL,
+						SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+			slot = -1;
+			for(int i = 0 ; i < MAX_CONTROL && slot == -1 ; i++) {
+				if(server->client[i].fd == -1)
+					slot = i;
+			}
+			event.events = EPOLLIN | EPOLLRDHUP;
+			event.data.fd = connection;
+			if(slot == -1 || epoll_ctl(server->epoll, EPOLL_CTL_ADD,
+						connection, &event) != 0) {
+				close(connection);
+				continue;
+			}
+			server->client[slot].fd = connection;
+			server->client[slot].length = 0;
+			server->client[slot].uid = (uid_t)-1;
+			if(getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials,
+						&credentials_len) == 0)
+				server->client[slot].uid = credentials.uid;
+		}
+		return CONTROL_HANDLED;
+	}
+
+	for(int i = 0 ; i < MAX_CONTROL ; i++) {
+		client = &server->client[i];
+		if(client->fd != fd)
+			continue;
+
+		length = recv(fd, client->buffer + client->length,
+				MAX_ROW - client->length - 1, MSG_DONTWAIT);
+		if(length > 0)
+			client->length += length;
+		client->buffer[client->length] = '\0';
+
+		newline = strchr(client->buffer, '\n');
+		if(newline == NULL) {
+			if(client->length >= MAX_ROW - 1) {
+				replyControl(server, i, -1);
+				return CONTROL_HANDLED;
+			}
+			if(length == 0 || (length == -1 && errno != EAGAIN) ||
+					(events & (EPOLLERR | EPOLLHUP)))
+				dropControl(server, i);
+			return CONTROL_HANDLED;
+		}
+		*newline = '\0';
+		if(parseControl(client->buffer, request) != 0) {
+			replyControl(server, i, -1);
+			return CONTROL_HANDLED;
+		}
+		*index = i;
+		return CONTROL_REQUEST;
+	}
+	return CONTROL_IGNORED;
+}
+
+/**
+ * @brief	answer a request and close the connection
+ *
+ * @param[in]	server	control server instance
+ * @param[in]	index	slot of the client
+ * @param[in]	result	0 for success, any other value for a failure
+ */
+void replyControl(struct control_server *server, int index, int result)
+{
+	char *answer = result == 0 ? "ok\n" : "error request failed\n";
+
+	send(server->client[index].fd, answer, strnlen(answer, MAX_ROW),
+			MSG_DONTWAIT | MSG_NOSIGNAL);
+	dropControl(server, index);
+}
+
+/**
+ * @brief	parse a request line into command line flags
+ *
+ * @param[in]	line	';' separated list of commands
+ * @param[out]	flag	flags structure, untouched options keep their value
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	unknown command or invalid value
+ */
+int parseControl(char *line, struct flags *flag)
+{
+	char command[MAX_ROW] = {0};
+	char *token = NULL;
+	char *save = NULL;
+	char name[MAX_OPTION_NAME] = {0};
+	char value[MAX_OPTION] = {0};
+	int amount = 0;
+	int number = 0;
+
+	if(line == NULL || flag == NULL)
+		return -1;
+
+	strncpy(command, line, MAX_ROW-1);
+	stripChar(command, '\r');
+	for(token = strtok_r(command, ";", &save) ; token != NULL ;
+			token = strtok_r(NULL, ";", &save)) {
+		memset(name, 0, MAX_OPTION_NAME);
+		memset(value, 0, MAX_OPTION);
+		amount = sscanf(token, "%39s %127s", name, value);
+		if(amount < 1)
+			return -1;
+
+		if(strncmp(name, "switch", 7) == 0 && amount == 1) {
+			flag->switch_now = 1;
+			continue;
+		}
+		if(amount != 2)
+			return -1;
+
+		if(strncmp(name, "delay", 6) == 0) {
+			if((number = parseTimeSpan(value)) == -1)
+				return -1;
+			flag->delay = number;
+		} else if(strncmp(name, "interval", 9) == 0) {
+			if(sscanf(value, "%d", &number) != 1 || number <= 0 ||
+					number > MAX_INTERVAL)
+				return -1;
+			flag->cron_interval = number;
+		} else if(strncmp(name, "cancel", 7) == 0 ||
+				strncmp(name, "notify", 7) == 0) {
+			if(strncmp(value, "0", 2) != 0 && strncmp(value, "1", 2) != 0)
+				return -1;
+			if(name[0] == 'c')
+				flag->cancel_on = value[0] - '0';
+			else
+				flag->notify_on = value[0] - '0';
+		} else {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief	build the request line for the mutations in the flags
+ *
+ * @param[in]	flag	parsed command line options
+ * @param[out]	line	string of length MAX_ROW
+ *
+ * @retval	number of commands in the request
+ */
+int buildControl(struct flags *flag, char *line)
+{
+	int amount = 0;
+	int length = 0;
+
+	line[0] = '\0';
+	if(flag->delay > 0) {
+		length += snprintf(line + length, MAX_ROW - length, "%sdelay %d",
+				amount++ ? ";" : "", flag->delay);
+	}
+	if(flag->cancel_on == 0 || flag->cancel_on == 1) {
+		length += snprintf(line + length, MAX_ROW - length, "%scancel %d",
+				amount++ ? ";" : "", flag->cancel_on);
+	}
+	if(flag->notify_on == 0 || flag->notify_on == 1) {
+		length += snprintf(line + length, MAX_ROW - length, "%snotify %d",
+				amount++ ? ";" : "", flag->notify_on);
+	}
+	if(flag->cron_interval > 0) {
+		length += snprintf(line + length, MAX_ROW - length, "%sinterval %d",
+				amount++ ? ";" : "", flag->cron_interval);
+	}
+	if(flag->switch_now == 1) {
+		length += snprintf(line + length, MAX_ROW - length, "%sswitch",
+				amount++ ? ";" : "");
+	}
+	if(amount > 0)
+		snprintf(line + length, MAX_ROW - length, "\n");
+
+	return amount;
+}
+
+/**
+ * @brief	location of the control socket
+ *
+ * @param[out]	path	string of length PATH_MAX
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	runtime directory unavailable
+ */
+int controlPath(char *path)
+{
+	if(runtimeDir(path) != 0)
+		return -1;
+
+	strncat(path, "/control", PATH_MAX - strnlen(path, PATH_MAX) - 1);
+	return 0;
+}
+
+/**
+ * @brief	send the mutations of the command line to the running daemon
+ *
+ * @param[in]	flag	parsed command line options
+ * @param[out]	response	answer of the daemon, string of length MAX_ROW
+ *
+ * @retval	0	the daemon applied the request
+ * @retval	1	no daemon is listening or nothing to send, run locally
+ * @retval	-1	the daemon rejected the request
+ */
+int sendControl(struct flags *flag, char *response)
+{
+	char line[MAX_ROW] = {0};
+	char path[PATH_MAX] = {0};
+	int result = 1;
+
+	response[0] = '\0';
+	if(buildControl(flag, line) == 0)
+		return 1;
+
+	if(controlPath(path) == 0)
+		result = requestControl(path, line, response);
+	if(result == 1)
+		result = requestControl(SYSTEM_CONTROL, line, response);
+	return result;
+}
+
+/**
+ * @brief	send a request line to a control socket and wait for the answer
+ *
+ * @param[in]	path	location of the socket
+ * @param[in]	line	request line
+ * @param[out]	response	answer of the daemon, string of length MAX_ROW
+ *
+ * @retval	0	request applied
+ * @retval	1	no daemon listening
+ * @retval	-1	request rejected
+ */
+int requestControl(char *path, char *line, char *response)
+{
+	struct sockaddr_un address = {0};
+	ssize_t length = 0;
+	size_t received = 0;
+	int fd = -1;
+
+	if(strnlen(path, PATH_MAX) >= sizeof(address.sun_path))
+		return 1;
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd == -1)
+		return 1;
+
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path)-1);
+	if(connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+		close(fd);
+		return 1;
+	}
+	if(send(fd, line, strnlen(line, MAX_ROW), MSG_NOSIGNAL) == -1) {
+		close(fd);
+		return 1;
+	}
+	while(received < MAX_ROW - 1 &&
+			(length = recv(fd, response + received, MAX_ROW - received - 1, 0)) > 0)
+		received += length;
+	response[received] = '\0';
+	close(fd);
+
+	stripChar(response, '\n');
+	if(strncmp(response, "ok", 3) == 0)
+		return 0;
+
+	return -1;
+}
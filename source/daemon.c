@@ -0,0 +1,487 @@
+/**
+ * @file daemon.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	keep the scheduler running in the foreground instead of cron
+ *
+ * A timerfd fires on every interval boundary and triggers a run of the
+ * scheduler, the event stream and control sockets share the same epoll
+ * instance. A control request is applied by an immediate run. With
+ * Cancel=on the data directory of taskwarrior is watched as well, tasks
+ * started outside of the context of the zone are stopped right away.
+ *
+ * The multi-user daemon (-D -a) doesn't poll: every user has a timer for
+ * the next transition and the end of the delay on a timer wheel, the
+ * timerfd is armed for the earliest slot of the wheel. Edits of a config
+ * (inotify) and requests on SYSTEM_CONTROL only reschedule that user.
+ */
+
+#define _DEFAULT_SOURCE
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include "include/daemon.h"
+
+#define MAX_EPOLL_EVENTS 16
+
+extern int verbose;
+
+void stopDaemon(int);
+int armWheel(int, struct wheel*);
+int watchUsers(int, int*, struct user_job*, int);
+int findWatch(int*, int, int);
+
+static volatile sig_atomic_t stop_requested = 0;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void stopDaemon(int signal)
+{
+	(void)signal;
+	stop_requested = 1;
+}
+
+void markDue(struct wheel_timer *timer, void *arg)
+{
+	struct user_job *job = arg;
+
+	job[timer->owner].due = 1;
+}
+
+int findWatch(int *watch, int amount, int wd)
+{
+	for(int i = 0 ; i < amount ; i++) {
+		if(watch[i] == wd)
+			return i;
+	}
+	return -1;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	arm the timer for the next interval boundary after now
+ *
+ * Boundaries are multiples of the interval, counted in whole minutes.
+ *
+ * @param[in]	fd	timerfd of the daemon
+ * @param[in]	now	current unix timestamp
+ * @param[in]	interval	interval in minutes (1 if not positive)
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int armTimer(int fd, time_t now, int interval)
+{
+	struct itimerspec expiration = {{0, 0}, {0, 0}};
+	time_t step = 0;
+
+	if(interval <= 0 || interval > MAX_INTERVAL)
+		interval = 1;
+
+	step = (time_t)interval * 60;
+	expiration.it_value.tv_sec = (now / step + 1) * step;
+	return timerfd_settime(fd, TFD_TIMER_ABSTIME, &expiration, NULL);
+}
+
+/**
+ * @brief	arm the timer for the earliest slot of the timer wheel
+ *
+ * @param[in]	fd	timerfd of the daemon
+ * @param[in]	wheel	timer wheel
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int armWheel(int fd, struct wheel *wheel)
+{
+	struct itimerspec expiration = {{0, 0}, {0, 0}};
+	int next = nextExpiry(wheel);
+
+	/* a disarmed timer for an empty wheel */
+	if(next != -1)
+		expiration.it_value.tv_sec = (time_t)next * 60;
+	return timerfd_settime(fd, TFD_TIMER_ABSTIME, &expiration, NULL);
+}
+
+/**
+ * @brief	watch the csw directory of every user for edits of the config
+ *
+ * @param[in]	fd	inotify instance
+ * @param[out]	watch	watch descriptor per user (-1 if not watched)
+ * @param[in]	job	jobs of all users
+ * @param[in]	amount	number of users
+ *
+ * @retval	number of watched users
+ */
+int watchUsers(int fd, int *watch, struct user_job *job, int amount)
+{
+	char path[PATH_MAX] = {0};
+	char *separator = NULL;
+	int watched = 0;
+
+	for(int i = 0 ; i < amount ; i++) {
+		watch[i] = -1;
+		if(userConfig(path, job[i].home_root, job[i].user->name) != 0 ||
+				(separator = strrchr(path, '/')) == NULL)
+			continue;
+		*separator = '\0';
+		watch[i] = inotify_add_watch(fd, path, IN_CLOSE_WRITE | IN_MOVED_TO);
+		if(watch[i] != -1)
+			watched++;
+	}
+	return watched;
+}
+
+/**
+ * @brief	make the user of a control request the only due job
+ *
+ * Users marked due earlier in the same batch (an expired timer, an edit of
+ * the config) already left the wheel, their flags are kept in held.
+ *
+ * @param[in,out]	job	jobs of all users
+ * @param[in]	amount	number of users
+ * @param[in]	index	user of the request
+ * @param[out]	held	due flags of all users, array of length amount
+ */
+void isolateJob(struct user_job *job, int amount, int index, int *held)
+{
+	for(int i = 0 ; i < amount ; i++) {
+		held[i] = job[i].due;
+		job[i].due = i == index;
+	}
+}
+
+/**
+ * @brief	restore the due flags of the other users after a control request
+ *
+ * @param[in,out]	job	jobs of all users
+ * @param[in]	amount	number of users
+ * @param[in]	index	user of the request, rescheduled by the request
+ * @param[in]	held	due flags stored by isolateJob
+ */
+void restoreJobs(struct user_job *job, int amount, int index, int *held)
+{
+	for(int i = 0 ; i < amount ; i++)
+		job[i].due = i != index && held[i];
+}
+
+/**
+ * @brief	forget the one-shot command line options after the first run
+ *
+ * @param[out]	flag	parsed command line options
+ */
+void resetFlags(struct flags *flag)
+{
+	flag->delay = 0;
+	flag->show = 0;
+	flag->cancel_on = -1;
+	flag->notify_on = -1;
+	flag->cron_interval = -1;
+	flag->switch_now = 0;
+}
+
+/**
+ * @brief	run the scheduler on every interval until SIGINT or SIGTERM
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	flag	parsed command line options, applied on the first run
+ *
+ * @retval	EXIT_SUCCESS	stopped by a signal
+ * @retval	EXIT_FAILURE	setup of the timer or epoll failed
+ */
+int runDaemon(struct runtime *rt, struct flags *flag)
+{
+	struct epoll_event event = {0};
+	struct epoll_event ready[MAX_EPOLL_EVENTS];
+	struct event_server events;
+	struct control_server control;
+	struct task_watch tasks;
+	struct flags request;
+	struct sigaction action = {0};
+	CONTROL_STATE control_state = 0;
+	char path[PATH_MAX] = {0};
+	uint64_t expirations = 0;
+	int epoll = -1;
+	int timer = -1;
+	int amount = 0;
+	int client = 0;
+	int stopped = 0;
+
+	control.fd = -1;
+	tasks.fd = -1;
+	action.sa_handler = stopDaemon;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	epoll = epoll_create1(EPOLL_CLOEXEC);
+	timer = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+	if(epoll == -1 || timer == -1)
+		goto daemon_failed;
+
+	event.events = EPOLLIN;
+	event.data.fd = timer;
+	if(epoll_ctl(epoll, EPOLL_CTL_ADD, timer, &event) != 0)
+		goto daemon_failed;
+
+	if(runtimeDir(path) == 0) {
+		strncat(path, "/events", PATH_MAX - strnlen(path, PATH_MAX) - 1);
+		if(openEvents(&events, epoll, path) == 0)
+			rt->events = &events;
+		else
+			fprintf(stderr, "WARNING: event socket %s unavailable\n", path);
+	}
+	if(verbose && rt->events)
+		printf("Streaming events at %s\n", path);
+
+	if(controlPath(path) != 0 || openControl(&control, epoll, path) != 0)
+		fprintf(stderr, "WARNING: control socket unavailable\n");
+
+	runTick(rt, flag, time(NULL));
+	resetFlags(flag);
+	armTimer(timer, time(NULL), rt->interval);
+	request = *flag;
+
+	event.data.fd = -1;
+	if(watchTasks(&tasks) == 0) {
+		event.data.fd = tasks.fd;
+		epoll_ctl(epoll, EPOLL_CTL_ADD, tasks.fd, &event);
+	}
+	if(verbose && event.data.fd != -1)
+		printf("Watching the active tasks in %s\n", tasks.directory);
+	else if(event.data.fd == -1)
+		fprintf(stderr, "WARNING: taskwarrior data directory can't be watched\n");
+
+	while(!stop_requested) {
+		amount = epoll_wait(epoll, ready, MAX_EPOLL_EVENTS, -1);
+		if(amount == -1) {
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		for(int i = 0 ; i < amount ; i++) {
+			if(ready[i].data.fd == timer) {
+				if(read(timer, &expirations, sizeof(expirations)) == -1 &&
+						errno != EAGAIN)
+					continue;
+				runTick(rt, flag, time(NULL));
+				armTimer(timer, time(NULL), rt->interval);
+				continue;
+			}
+			if(ready[i].data.fd == tasks.fd) {
+				/* the check keeps the seen tasks current, also without a context */
+				if(!tasksChanged(&tasks))
+					continue;
+				if((stopped = enforceContext(&tasks, rt->enforce)) == -1)
+					fprintf(stderr, "WARNING: enforcing the context %s failed\n",
+							rt->enforce);
+				else if(stopped > 0)
+					emitEvent(rt->events, "enforce", "context=%s stopped=%d",
+							rt->enforce, stopped);
+				continue;
+			}
+			resetFlags(&request);
+			control_state = handleControl(&control, ready[i].data.fd,
+					ready[i].events, &request, &client);
+			if(control_state == CONTROL_REQUEST) {
+				runTick(rt, &request, time(NULL));
+				replyControl(&control, client, rt->applied ? 0 : -1);
+				armTimer(timer, time(NULL), rt->interval);
+				continue;
+			}
+			if(control_state == CONTROL_HANDLED)
+				continue;
+
+			handleEvents(rt->events, ready[i].data.fd, ready[i].events);
+		}
+	}
+
+	closeWatch(&tasks);
+	closeControl(&control);
+	closeEvents(rt->events);
+	closeTimeline(&rt->timeline);
+	rt->events = NULL;
+	close(timer);
+	close(epoll);
+	return EXIT_SUCCESS;
+
+	daemon_failed:
+		perror("daemon setup failed");
+		if(timer != -1)
+			close(timer);
+		if(epoll != -1)
+			close(epoll);
+		return EXIT_FAILURE;
+}
+
+/**
+ * @brief	run the schedules of all users, woken up by their timers only
+ *
+ * @param[in]	flag	parsed command line options
+ * @param[in]	home_root	directory containing the home directories
+ *
+ * @retval	EXIT_SUCCESS	stopped by a signal
+ * @retval	EXIT_FAILURE	setup failed
+ */
+int runBatchDaemon(struct flags *flag, char *home_root)
+{
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct epoll_event event = {0};
+	struct epoll_event ready[MAX_EPOLL_EVENTS];
+	struct inotify_event *change = NULL;
+	struct control_server control;
+	struct sigaction action = {0};
+	struct schedule_table schedules;
+	struct spawner spawner;
+	struct user_list list;
+	struct user_job *job = NULL;
+	struct flags request;
+	struct wheel wheel;
+	CONTROL_STATE control_state = 0;
+	uint64_t expirations = 0;
+	ssize_t length = 0;
+	long start = 0;
+	int *watch = NULL;
+	int *held = NULL;
+	int result = EXIT_FAILURE;
+	int epoll = -1;
+	int timer = -1;
+	int notify = -1;
+	int amount = 0;
+	int client = 0;
+	int index = 0;
+
+	control.fd = -1;
+	action.sa_handler = stopDaemon;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	/* before the process grows, the spawn server forks the runs */
+	if(startSpawner(&spawner, spawnedUser) != 0)
+		fprintf(stderr, "WARNING: spawn server unavailable, forking directly\n");
+	initSchedules(&schedules);
+	job = prepareJobs(&list, flag, home_root, &schedules,
+			spawner.pid != -1 ? &spawner : NULL);
+	if(job == NULL) {
+		stopSpawner(&spawner);
+		freeSchedules(&schedules);
+		return list.amount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if((watch = calloc(list.amount, sizeof(int))) == NULL ||
+			(held = calloc(list.amount, sizeof(int))) == NULL)
+		goto batch_daemon_done;
+
+	epoll = epoll_create1(EPOLL_CLOEXEC);
+	timer = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+	notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(epoll == -1 || timer == -1 || notify == -1)
+		goto batch_daemon_done;
+
+	event.events = EPOLLIN;
+	event.data.fd = timer;
+	if(epoll_ctl(epoll, EPOLL_CTL_ADD, timer, &event) != 0)
+		goto batch_daemon_done;
+	event.data.fd = notify;
+	if(epoll_ctl(epoll, EPOLL_CTL_ADD, notify, &event) != 0)
+		goto batch_daemon_done;
+
+	if(verbose)
+		printf("Watching %d config directories\n",
+				watchUsers(notify, watch, job, list.amount));
+	else
+		watchUsers(notify, watch, job, list.amount);
+
+	mkdir(SYSTEM_CONTROL_DIR, 0755);
+	if(openControl(&control, epoll, SYSTEM_CONTROL) != 0 ||
+			chmod(SYSTEM_CONTROL, 0666) != 0)
+		fprintf(stderr, "WARNING: control socket %s unavailable\n", SYSTEM_CONTROL);
+
+	resetFlags(flag);
+	initWheel(&wheel, (int)(time(NULL) / 60));
+	result = EXIT_SUCCESS;
+	while(!stop_requested) {
+		for(index = 0 ; index < list.amount && !job[index].due ; index++);
+		if(index < list.amount) {
+			start = monotonicNs();
+			runJobs(job, list.amount, 0);
+			if(verbose)
+				reportJobs(job, list.amount, monotonicNs() - start);
+			for(int i = 0 ; i < list.amount ; i++) {
+				if(job[i].due)
+					scheduleUser(&wheel, &job[i], time(NULL));
+				job[i].due = 0;
+			}
+		}
+		armWheel(timer, &wheel);
+
+		amount = epoll_wait(epoll, ready, MAX_EPOLL_EVENTS, -1);
+		if(amount == -1) {
+			if(errno == EINTR)
+				continue;
+			result = EXIT_FAILURE;
+			break;
+		}
+		for(int i = 0 ; i < amount ; i++) {
+			if(ready[i].data.fd == timer) {
+				if(read(timer, &expirations, sizeof(expirations)) == -1 &&
+						errno != EAGAIN)
+					continue;
+				advanceWheel(&wheel, (int)(time(NULL) / 60), markDue, job);
+				continue;
+			}
+			if(ready[i].data.fd == notify) {
+				while((length = read(notify, buffer, sizeof(buffer))) > 0) {
+					for(char *cursor = buffer ; cursor < buffer + length ;
+							cursor += sizeof(struct inotify_event) + change->len) {
+						change = (struct inotify_event*)cursor;
+						index = findWatch(watch, list.amount, change->wd);
+						if(index != -1 && change->len > 0 &&
+								strncmp(change->name, "config", 7) == 0)
+							job[index].due = 1;
+					}
+				}
+				continue;
+			}
+
+			resetFlags(&request);
+			request.verbose = flag->verbose;
+			control_state = handleControl(&control, ready[i].data.fd,
+					ready[i].events, &request, &client);
+			if(control_state != CONTROL_REQUEST)
+				continue;
+
+			for(index = 0 ; index < list.amount &&
+					list.user[index].uid != control.client[client].uid ; index++);
+			if(index == list.amount) {
+				replyControl(&control, client, -1);
+				continue;
+			}
+			/* apply the request for this user alone, right away */
+			isolateJob(job, list.amount, index, held);
+			job[index].flag = &request;
+			runJobs(job, list.amount, 1);
+			job[index].flag = flag;
+			replyControl(&control, client, job[index].state == USER_FAILED ? -1 : 0);
+			scheduleUser(&wheel, &job[index], time(NULL));
+			restoreJobs(job, list.amount, index, held);
+		}
+	}
+
+	batch_daemon_done:
+		if(result == EXIT_FAILURE && job != NULL)
+			perror("multi-user daemon setup failed");
+		closeControl(&control);
+		if(notify != -1)
+			close(notify);
+		if(timer != -1)
+			close(timer);
+		if(epoll != -1)
+			close(epoll);
+		free(watch);
+		free(held);
+		stopSpawner(&spawner);
+		releaseJobs(job, list.amount);
+		freeSchedules(&schedules);
+		freeUsers(&list);
+		return result;
+}
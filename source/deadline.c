@@ -0,0 +1,305 @@
+/**
+ * @file deadline.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	deadline queue for the runs of the multi-user modes
+ *
+ * At a common zone boundary (08:30, 17:00) most users of a host need a
+ * run in the same minute, and every run calls taskwarrior on the shared
+ * data volume. The number of workers caps the concurrent runs. A job
+ * carries a release time (the jitter of the user) and a deadline, the
+ * workers take the released job with the earliest deadline.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/deadline.h"
+
+void* runDeadlineWorker(void*);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+long realtimeMs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return now.tv_sec * 1000L + now.tv_nsec / 1000000L;
+}
+
+int earlierEntry(struct deadline_entry *first, struct deadline_entry *second)
+{
+	if(first->deadline != second->deadline)
+		return first->deadline < second->deadline;
+	return first->release < second->release;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	insert a job into the heap, grow the heap if it is full
+ *
+ * @param[in,out]	queue	deadline queue, locked by the caller
+ * @param[in]	entry	job to insert
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	allocation failed
+ */
+int pushDeadline(struct deadline_queue *queue, struct deadline_entry *entry)
+{
+	struct deadline_entry *grown = NULL;
+	struct deadline_entry swap;
+	int index = queue->amount;
+	int parent = 0;
+
+	if(queue->amount == queue->capacity) {
+		grown = realloc(queue->heap, (queue->capacity ? queue->capacity*2 :
+					POOL_QUEUE) * sizeof(struct deadline_entry));
+		if(grown == NULL)
+			return -1;
+		queue->heap = grown;
+		queue->capacity = queue->capacity ? queue->capacity*2 : POOL_QUEUE;
+	}
+
+	queue->heap[queue->amount++] = *entry;
+	while(index > 0) {
+		parent = (index - 1) / 2;
+		if(!earlierEntry(&queue->heap[index], &queue->heap[parent]))
+			break;
+		swap = queue->heap[parent];
+		queue->heap[parent] = queue->heap[index];
+		queue->heap[index] = swap;
+		index = parent;
+	}
+	if(queue->amount > queue->depth)
+		queue->depth = queue->amount;
+	return 0;
+}
+
+/**
+ * @brief	remove a job from the heap
+ *
+ * @param[in,out]	queue	deadline queue, locked by the caller
+ * @param[in]	index	position of the job in the heap
+ * @param[out]	entry	removed job
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no job at the position
+ */
+int removeDeadline(struct deadline_queue *queue, int index, struct deadline_entry *entry)
+{
+	struct deadline_entry swap;
+	int parent = 0;
+	int child = 0;
+
+	if(index < 0 || index >= queue->amount)
+		return -1;
+
+	*entry = queue->heap[index];
+	queue->heap[index] = queue->heap[--queue->amount];
+	while(index > 0 && index < queue->amount) {
+		parent = (index - 1) / 2;
+		if(!earlierEntry(&queue->heap[index], &queue->heap[parent]))
+			break;
+		swap = queue->heap[parent];
+		queue->heap[parent] = queue->heap[index];
+		queue->heap[index] = swap;
+		index = parent;
+	}
+	while((child = 2*index + 1) < queue->amount) {
+		if(child + 1 < queue->amount &&
+				earlierEntry(&queue->heap[child + 1], &queue->heap[child]))
+			child++;
+		if(!earlierEntry(&queue->heap[child], &queue->heap[index]))
+			break;
+		swap = queue->heap[child];
+		queue->heap[child] = queue->heap[index];
+		queue->heap[index] = swap;
+		index = child;
+	}
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int popDeadline(struct deadline_queue *queue, struct deadline_entry *entry)
+{
+	return removeDeadline(queue, 0, entry);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	find the released job with the earliest deadline
+ *
+ * The first job of the heap is usually released, the heap is only
+ * searched while the earliest deadline still waits for its jitter.
+ *
+ * @param[in]	queue	deadline queue, locked by the caller
+ * @param[in]	now	current point in time (ms)
+ * @param[out]	release	earliest release of all jobs, if none is released
+ *
+ * @retval	position of the job in the heap
+ * @retval	-1	no job is released
+ */
+int releasedDeadline(struct deadline_queue *queue, long now, long *release)
+{
+	int found = -1;
+
+	*release = 0;
+	for(int i = 0 ; i < queue->amount ; i++) {
+		if(queue->heap[i].release > now) {
+			if(*release == 0 || queue->heap[i].release < *release)
+				*release = queue->heap[i].release;
+			continue;
+		}
+		if(found == -1 || earlierEntry(&queue->heap[i], &queue->heap[found]))
+			found = i;
+		if(i == 0)
+			break;
+	}
+	return found;
+}
+
+/**
+ * @brief	main loop of a worker, waits for the release of the next job
+ *
+ * @param[in]	arg	struct deadline_queue of the worker
+ *
+ * @retval	NULL
+ */
+void* runDeadlineWorker(void *arg)
+{
+	struct deadline_queue *queue = arg;
+	struct deadline_entry entry;
+	struct timespec wakeup;
+	long release = 0;
+	int index = 0;
+
+	pthread_mutex_lock(&queue->lock);
+	for(;;) {
+		if(queue->amount == 0) {
+			if(queue->stop)
+				break;
+			pthread_cond_wait(&queue->work, &queue->lock);
+			continue;
+		}
+		if((index = releasedDeadline(queue, realtimeMs(), &release)) == -1) {
+			wakeup.tv_sec = release / 1000;
+			wakeup.tv_nsec = release % 1000 * 1000000L;
+			pthread_cond_timedwait(&queue->work, &queue->lock, &wakeup);
+			continue;
+		}
+
+		removeDeadline(queue, index, &entry);
+		queue->running++;
+		pthread_mutex_unlock(&queue->lock);
+		entry.run(entry.arg);
+		pthread_mutex_lock(&queue->lock);
+		queue->running--;
+		if(queue->amount == 0 && queue->running == 0)
+			pthread_cond_broadcast(&queue->done);
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return NULL;
+}
+
+/**
+ * @brief	start the workers of a deadline queue
+ *
+ * @param[out]	queue	deadline queue
+ * @param[in]	workers	number of concurrent jobs
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int queueCreate(struct deadline_queue *queue, int workers)
+{
+	int started = 0;
+
+	memset(queue, 0, sizeof(struct deadline_queue));
+	if(workers < 1)
+		workers = 1;
+	if(workers > POOL_MAX_WORKERS)
+		workers = POOL_MAX_WORKERS;
+
+	if((queue->thread = calloc(workers, sizeof(pthread_t))) == NULL)
+		return -1;
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->work, NULL);
+	pthread_cond_init(&queue->done, NULL);
+
+	for(started = 0 ; started < workers ; started++) {
+		if(pthread_create(&queue->thread[started], NULL, runDeadlineWorker,
+					queue) != 0)
+			break;
+	}
+	queue->workers = started;
+	if(started > 0)
+		return 0;
+
+	pthread_mutex_destroy(&queue->lock);
+	pthread_cond_destroy(&queue->work);
+	pthread_cond_destroy(&queue->done);
+	free(queue->thread);
+	memset(queue, 0, sizeof(struct deadline_queue));
+	return -1;
+}
+
+/**
+ * @brief	queue a job with its deadline and release time
+ *
+ * @param[in]	queue	deadline queue
+ * @param[in]	deadline	point in time the job has to be finished at (ms)
+ * @param[in]	release	earliest start of the job (ms)
+ * @param[in]	run	function executed by a worker
+ * @param[in]	arg	argument of the function
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	allocation failed, the job was not queued
+ */
+int queueSubmit(struct deadline_queue *queue, long deadline, long release,
+		void (*run)(void*), void *arg)
+{
+	struct deadline_entry entry = {.deadline = deadline, .release = release,
+		.run = run, .arg = arg};
+	int result = 0;
+
+	pthread_mutex_lock(&queue->lock);
+	/* the new job may be released before the one a worker waits for */
+	if((result = pushDeadline(queue, &entry)) == 0)
+		pthread_cond_broadcast(&queue->work);
+	pthread_mutex_unlock(&queue->lock);
+	return result;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void queueWait(struct deadline_queue *queue)
+{
+	pthread_mutex_lock(&queue->lock);
+	while(queue->amount > 0 || queue->running > 0)
+		pthread_cond_wait(&queue->done, &queue->lock);
+	pthread_mutex_unlock(&queue->lock);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	finish the queued jobs, join the workers and release the queue
+ *
+ * @param[in]	queue	deadline queue
+ */
+void queueStop(struct deadline_queue *queue)
+{
+	if(queue->thread == NULL)
+		return;
+
+	pthread_mutex_lock(&queue->lock);
+	queue->stop = 1;
+	pthread_cond_broadcast(&queue->work);
+	pthread_mutex_unlock(&queue->lock);
+
+	for(int i = 0 ; i < queue->workers ; i++)
+		pthread_join(queue->thread[i], NULL);
+
+	pthread_mutex_destroy(&queue->lock);
+	pthread_cond_destroy(&queue->work);
+	pthread_cond_destroy(&queue->done);
+	free(queue->thread);
+	free(queue->heap);
+	memset(queue, 0, sizeof(struct deadline_queue));
+}
@@ -0,0 +1,275 @@
+/**
+ * @file enforce.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	stop tasks started outside of the context of the active zone
+ *
+ * Cancel=on stops the active tasks when the context is switched, a task
+ * started later in the wrong context would run until the next boundary.
+ * The daemon watches the data directory of taskwarrior with inotify
+ * (pending.data, the replica and its WAL). On a change only the tasks
+ * that were started or modified since the last check are evaluated on
+ * the filter of the context, the ones that don't match are stopped.
+ *
+ * The filter is read from the taskrc (context.<name>.read or
+ * context.<name>) and evaluated for the terms project:, project.is:, +tag
+ * and -tag combined with and/or. A filter with other terms or with a virtual tag of
+ * taskwarrior (all uppercase, e.g. +READY) is left to taskwarrior, no
+ * task is stopped for it.
+ */
+
+#define _DEFAULT_SOURCE
+#include <sys/inotify.h>
+#include "include/enforce.h"
+
+extern int verbose;
+
+int filterTerm(char*, struct active_task*);
+int taskChanged(struct task_watch*, struct active_task*);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int hasTag(char *tags, char *tag)
+{
+	size_t length = strlen(tag);
+	char *match = tags;
+
+	while((match = strstr(match, tag)) != NULL) {
+		if((match == tags || match[-1] == ',') &&
+				(match[length] == ',' || match[length] == '\0'))
+			return 1;
+		match += length;
+	}
+	return 0;
+}
+
+int virtualTag(char *tag)
+{
+	for(char *letter = tag ; *letter != '\0' ; letter++) {
+		if(*letter < 'A' || *letter > 'Z')
+			return 0;
+	}
+	return 1;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	read the filter of a context from the taskrc
+ *
+ * @param[in]	context	name of the context
+ * @param[out]	filter	string of length MAX_FILTER
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the context has no filter in the taskrc
+ */
+int contextFilter(char *context, char *filter)
+{
+	char path[PATH_MAX] = {0};
+	char key[MAX_ROW] = {0};
+
+	if(taskrcPath(path) != 0)
+		return -1;
+	snprintf(key, MAX_ROW, "context.%.*s.read", MAX_ROW - 14, context);
+	if(taskrcValue(path, key, filter, MAX_FILTER) == 0)
+		return 0;
+	snprintf(key, MAX_ROW, "context.%.*s", MAX_ROW - 9, context);
+	if(taskrcValue(path, key, filter, MAX_FILTER) == 0)
+		return 0;
+	return -1;
+}
+
+/**
+ * @brief	evaluate a single term of a filter on a task
+ *
+ * project:X is a left match like in taskwarrior, it matches X, X.sub and
+ * Xylo. project.is:X matches only the project X. Virtual tags depend on
+ * attributes the task isn't parsed for.
+ *
+ * @param[in]	term	term of the filter, quotes are removed
+ * @param[in]	task	attributes of the task
+ *
+ * @retval	1	the task matches
+ * @retval	0	the task doesn't match
+ * @retval	-1	unsupported term
+ */
+int filterTerm(char *term, struct active_task *task)
+{
+	char *value = NULL;
+	int exact = 0;
+
+	if((term[0] == '+' || term[0] == '-') && virtualTag(term + 1))
+		return -1;
+	if(term[0] == '+' && term[1] != '\0')
+		return hasTag(task->tags, term + 1);
+	if(term[0] == '-' && term[1] != '\0')
+		return !hasTag(task->tags, term + 1);
+
+	if(strncmp(term, "project:", 8) == 0)
+		value = term + 8;
+	else if(strncmp(term, "pro:", 4) == 0)
+		value = term + 4;
+	else if(strncmp(term, "project.is:", 11) == 0) {
+		value = term + 11;
+		exact = 1;
+	}
+	if(value == NULL)
+		return -1;
+
+	if(exact || value[0] == '\0')
+		return strncmp(task->project, value, MAX_FIELD) == 0;
+	return strncmp(task->project, value, strlen(value)) == 0;
+}
+
+/**
+ * @brief	evaluate the filter of a context on a task
+ *
+ * Terms are joined by and (also implicit), or binds weaker than and.
+ *
+ * @param[in]	filter	filter of the context
+ * @param[in]	task	attributes of the task
+ *
+ * @retval	1	the task matches the filter (an empty filter matches all)
+ * @retval	0	the task doesn't match
+ * @retval	-1	the filter contains an unsupported term
+ */
+int filterMatch(char *filter, struct active_task *task)
+{
+	char copy[MAX_FILTER] = {0};
+	char *save = NULL;
+	char *term = NULL;
+	int group = 1;
+	int result = 0;
+	int match = 0;
+
+	snprintf(copy, MAX_FILTER, "%s", filter);
+	for(term = strtok_r(copy, " \t", &save) ; term != NULL ;
+			term = strtok_r(NULL, " \t", &save)) {
+		stripChar(term, '\'');
+		stripChar(term, '"');
+		if(strncmp(term, "or", 3) == 0) {
+			result |= group;
+			group = 1;
+			continue;
+		}
+		if(strncmp(term, "and", 4) == 0)
+			continue;
+		if((match = filterTerm(term, task)) == -1)
+			return -1;
+		group &= match;
+	}
+	return result | group;
+}
+
+/**
+ * @brief	watch the data directory of taskwarrior
+ *
+ * The active tasks at this point are taken as checked.
+ *
+ * @param[out]	watch	watch of the data directory
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the directory can't be located or watched
+ */
+int watchTasks(struct task_watch *watch)
+{
+	memset(watch, 0, sizeof(struct task_watch));
+	watch->fd = -1;
+	if(dataLocation(watch->directory) != 0)
+		return -1;
+	if((watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1)
+		return -1;
+	if(inotify_add_watch(watch->fd, watch->directory,
+				IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY) == -1) {
+		close(watch->fd);
+		watch->fd = -1;
+		return -1;
+	}
+	watch->amount = activeDetails(watch->directory, watch->seen, STOP_UUIDS);
+	if(watch->amount < 0)
+		watch->amount = 0;
+	return 0;
+}
+
+/**
+ * @brief	read the pending events of the watch
+ *
+ * @param[in]	watch	watch of the data directory
+ *
+ * @retval	1	pending.data or the replica changed
+ * @retval	0	other files of the directory changed
+ */
+int tasksChanged(struct task_watch *watch)
+{
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event *change = NULL;
+	ssize_t length = 0;
+	int changed = 0;
+
+	while((length = read(watch->fd, buffer, sizeof(buffer))) > 0) {
+		for(char *cursor = buffer ; cursor < buffer + length ;
+				cursor += sizeof(struct inotify_event) + change->len) {
+			change = (struct inotify_event*)cursor;
+			if(change->len > 0 &&
+					(strncmp(change->name, "pending.data", 13) == 0 ||
+					 strncmp(change->name, "taskchampion.sqlite3", 20) == 0))
+				changed = 1;
+		}
+	}
+	return changed;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int taskChanged(struct task_watch *watch, struct active_task *task)
+{
+	for(int i = 0 ; i < watch->amount ; i++) {
+		if(strncmp(watch->seen[i].uuid, task->uuid, UUID_LEN) == 0)
+			return watch->seen[i].modified != task->modified;
+	}
+	return 1;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	stop the started or modified tasks outside of the context
+ *
+ * @param[in,out]	watch	watch of the data directory
+ * @param[in]	context	context of the active zone
+ *
+ * @retval	number of stopped tasks
+ * @retval	-1	the tasks can't be read or taskwarrior failed to stop them
+ */
+int enforceContext(struct task_watch *watch, char *context)
+{
+	struct active_task task[STOP_UUIDS];
+	char uuid[STOP_UUIDS][UUID_LEN];
+	char filter[MAX_FILTER] = {0};
+	int found = 0;
+	int stop = 0;
+
+	if((found = activeDetails(watch->directory, task, STOP_UUIDS)) == -1)
+		return -1;
+	if(contextFilter(context, filter) == 0) {
+		for(int i = 0 ; i < found ; i++) {
+			if(!taskChanged(watch, &task[i]) || filterMatch(filter, &task[i]) != 0)
+				continue;
+			if(verbose)
+				printf("task %s was started outside of context %s\n",
+						task[i].uuid, context);
+			snprintf(uuid[stop++], UUID_LEN, "%s", task[i].uuid);
+		}
+	}
+
+	memcpy(watch->seen, task, found * sizeof(struct active_task));
+	watch->amount = found;
+	if(stop == 0)
+		return 0;
+	return stopTasks("", uuid, stop) == 0 ? stop : -1;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void closeWatch(struct task_watch *watch)
+{
+	if(watch->fd != -1)
+		close(watch->fd);
+	watch->fd = -1;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -0,0 +1,278 @@
+/**
+ * @file event.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	stream scheduler events to subscribers of a UNIX socket
+ *
+ * Every event is a single line: "{unix timestamp} {type} {details}\n".
+ * Types are transition, delay, exclusion and error.
+ * The sockets are registered at the epoll instance of the daemon and never
+ * block it, a subscriber that can't keep up with its buffer is dropped.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "include/event.h"
+
+/**
+ * @brief	create the listening socket and register it at the epoll instance
+ *
+ * A stale socket of a previous daemon at the same path is replaced.
+ *
+ * @param[out]	server	event server instance
+ * @param[in]	epoll	epoll instance of the daemon
+ * @param[in]	path	location of the socket
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int openEvents(struct event_server *server, int epoll, char *path)
+{
+	struct sockaddr_un address = {0};
+	struct epoll_event event = {0};
+
+	if(server == NULL || path == NULL ||
+			strnlen(path, PATH_MAX) >= sizeof(address.sun_path))
+		return -1;
+
+	memset(server, 0, sizeof(struct event_server));
+	for(int i = 0 ; i < MAX_SUBSCRIBER ; i++)
+		server->client[i].fd = -1;
+	server->epoll = epoll;
+	strncpy(server->path, path, PATH_MAX-1);
+
+	server->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(server->fd == -1)
+		return -1;
+
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path)-1);
+	unlink(path);
+	if(bind(server->fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+		goto open_failed;
+
+	if(listen(server->fd, MAX_SUBSCRIBER) != 0)
+		goto open_failed;
+
+	event.events = EPOLLIN;
+	event.data.fd = server->fd;
+	if(epoll_ctl(epoll, EPOLL_CTL_ADD, server->fd, &event) != 0)
+		goto open_failed;
+
+	return 0;
+
+	open_failed:
+		close(server->fd);
+		server->fd = -1;
+		return -1;
+}
+
+/**
+ * @brief	disconnect every subscriber and remove the listening socket
+ *
+ * @param[in]	server	event server instance
+ */
+void closeEvents(struct event_server *server)
+{
+	if(server == NULL || server->fd == -1)
+		return;
+
+	for(int i = 0 ; i < MAX_SUBSCRIBER ; i++) {
+		if(server->client[i].fd != -1)
+			dropSubscriber(server, i);
+	}
+	close(server->fd);
+	unlink(server->path);
+	server->fd = -1;
+}
+
+/**
+ * @brief	close the connection to a subscriber and free the slot
+ *
+ * @param[in]	server	event server instance
+ * @param[in]	index	slot of the subscriber
+ */
+void dropSubscriber(struct event_server *server, int index)
+{
+	struct subscriber *client = &server->client[index];
+
+	epoll_ctl(server->epoll, EPOLL_CTL_DEL, client->fd, NULL);
+	close(client->fd);
+	client->fd = -1;
+	client->length = 0;
+}
+
+/**
+ * @brief	write as much of the pending buffer as the socket accepts
+ *
+ * Wait for EPOLLOUT while data is pending, stop waiting once the
+ * buffer is empty.
+ *
+ * @param[in]	server	event server instance
+ * @param[in]	index	slot of the subscriber
+ *
+ * @retval	0	SUCCESS (the buffer might still contain data)
+ * @retval	-1	FAILURE, the subscriber was dropped
+ */
+int flushSubscriber(struct event_server *server, int index)
+{
+	struct subscriber *client = &server->client[index];
+	struct epoll_event event = {0};
+	ssize_t written = 0;
+	int pending = client->length > 0;
+
+	while(client->length > 0) {
+		written = send(client->fd, client->buffer, client->length,
+				MSG_DONTWAIT | MSG_NOSIGNAL);
+		if(written == -1) {
+			if(errno == EINTR)
+				continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			dropSubscriber(server, index);
+			return -1;
+		}
+		memmove(client->buffer, client->buffer + written,
+				client->length - written);
+		client->length -= written;
+	}
+
+	if(pending || client->length > 0) {
+		event.events = EPOLLIN | EPOLLRDHUP | (client->length > 0 ? EPOLLOUT : 0);
+		event.data.fd = client->fd;
+		epoll_ctl(server->epoll, EPOLL_CTL_MOD, client->fd, &event);
+	}
+	return 0;
+}
+
+/**
+ * @brief	append an event to the buffer of a subscriber
+ *
+ * @param[in]	server	event server instance
+ * @param[in]	index	slot of the subscriber
+ * @param[in]	line	the event line
+ * @param[in]	length	length of the event line
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	buffer full, the subscriber was dropped
+ */
+int queueEvent(struct event_server *server, int index, char *line,
+		size_t length)
+{
+	struct subscriber *client = &server->client[index];
+
+	if(client->length + length > SUBSCRIBER_BUFFER) {
+		dropSubscriber(server, index);
+		server->dropped += 1;
+		return -1;
+	}
+	memcpy(client->buffer + client->length, line, length);
+	client->length += length;
+	return flushSubscriber(server, index);
+}
+
+/**
+ * @brief	format an event and send it to every subscriber
+ *
+ * @param[in]	server	event server instance (no-op if NULL)
+ * @param[in]	type	event type
+ * @param[in]	format	printf format of the event details
+ */
+void emitEvent(struct event_server *server, char *type, const char *format, ...)
+{
+	char line[MAX_EVENT] = {0};
+	va_list args;
+	int length = 0;
+
+	if(server == NULL || server->fd == -1)
+		return;
+
+	length = snprintf(line, MAX_EVENT, "%ld %s ", (long)time(NULL), type);
+	va_start(args, format);
+	length += vsnprintf(line + length, MAX_EVENT - length - 1, format, args);
+	va_end(args);
+	if(length > MAX_EVENT - 2)
+		length = MAX_EVENT - 2;
+	line[length++] = '\n';
+
+	for(int i = 0 ; i < MAX_SUBSCRIBER ; i++) {
+		if(server->client[i].fd != -1)
+			queueEvent(server, i, line, length);
+	}
+}
+
+/**
+ * @brief	handle the readiness of a socket that belongs to the event server
+ *
+ * Accept new subscribers on the listening socket, input of subscribers is
+ * discarded, a hang up frees the slot and pending output is flushed.
+ *
+ * @param[in]	server	event server instance
+ * @param[in]	fd	the ready file descriptor
+ * @param[in]	events	the epoll events for the descriptor
+ *
+ * @retval	0	descriptor handled
+ * @retval	-1	descriptor doesn't belong to the event server
+ */
+int handleEvents(struct event_server *server, int fd, unsigned int events)
+{
+	struct epoll_event event = {0};
+	char discard[MAX_EVENT] = {0};
+	int client = -1;
+	int slot = -1;
+	ssize_t length = 0;
+
+	if(server == NULL || server->fd == -1)
+		return -1;
+
+	if(fd == server->fd) {
+		while((client = accept4(server->fd, NULL, NULL,
+						SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+			slot = -1;
+			for(int i = 0 ; i < MAX_SUBSCRIBER && slot == -1 ; i++) {
+				if(server->client[i].fd == -1)
+					slot = i;
+			}
+			event.events = EPOLLIN | EPOLLRDHUP;
+			event.data.fd = client;
+			if(slot == -1 || epoll_ctl(server->epoll, EPOLL_CTL_ADD,
+						client, &event) != 0) {
+				close(client);
+				continue;
+			}
+			server->client[slot].fd = client;
+			server->client[slot].length = 0;
+		}
+		return 0;
+	}
+
+	for(int i = 0 ; i < MAX_SUBSCRIBER ; i++) {
+		if(server->client[i].fd != fd)
+			continue;
+
+		if(events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+			dropSubscriber(server, i);
+			return 0;
+		}
+		if(events & EPOLLIN) {
+			length = recv(fd, discard, MAX_EVENT, MSG_DONTWAIT);
+			if(length == 0 || (length == -1 && errno != EAGAIN)) {
+				dropSubscriber(server, i);
+				return 0;
+			}
+		}
+		if(events & EPOLLOUT)
+			flushSubscriber(server, i);
+
+		return 0;
+	}
+	return -1;
+}
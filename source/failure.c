@@ -0,0 +1,303 @@
+/**
+ * @file failure.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	back off the retries of a failed switch
+ *
+ * A switch that fails (unknown context, taskwarrior missing or broken) is
+ * attempted again on every run, from cron three process chains a minute
+ * and an error mail for each of them. The failure is stored next to the
+ * journal (the file "failure"), the switch to the same context is retried
+ * after BACKOFF_BASE seconds, doubled per consecutive failure up to
+ * BACKOFF_MAX. The delay is shortened by a random jitter of up to a
+ * quarter, the runs of many users don't retry in lockstep. A request from
+ * the command line (-S) or a new target context retries at once.
+ *
+ * A failure is reported on stderr and notified once per distinct failure
+ * (target context and reason), the config errors once per distinct set.
+ * A locked database is no failure, it is retried LOCK_RETRIES times within
+ * the run.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/failure.h"
+
+extern int verbose;
+
+int parseFailure(struct failure_state*, char*);
+
+/**
+ * @brief	build the path of the failure state next to the journal
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	location of the config
+ * @param[in]	persistent	1 if the state is kept next to the config
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no location for the state
+ */
+int failurePath(char *path, char *config_path, int persistent)
+{
+	char *separator = NULL;
+
+	if(journalPath(path, config_path, persistent) != 0 ||
+			(separator = strrchr(path, '/')) == NULL)
+		return -1;
+	snprintf(separator + 1, PATH_MAX - (separator + 1 - path), "failure");
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int parseFailure(struct failure_state *failure, char *record)
+{
+	char *value = strchr(record, '=');
+
+	if(value == NULL)
+		return -1;
+	*value++ = '\0';
+	if(strncmp(record, "Context", 8) == 0)
+		snprintf(failure->context, MAX_COMMAND, "%s", value);
+	else if(strncmp(record, "Reason", 7) == 0)
+		failure->reason = atoi(value);
+	else if(strncmp(record, "Count", 6) == 0)
+		failure->count = atoi(value);
+	else if(strncmp(record, "Retry", 6) == 0)
+		failure->retry = (time_t)strtoll(value, NULL, 10);
+	else if(strncmp(record, "Notified", 9) == 0)
+		failure->notified = (unsigned int)strtoul(value, NULL, 10);
+	else
+		return -1;
+	return 0;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	read the failure state
+ *
+ * @param[in]	path	location of the failure state
+ * @param[out]	failure	stored state, empty without a file
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the file is unreadable
+ */
+int loadFailure(char *path, struct failure_state *failure)
+{
+	char record[MAX_ROW] = {0};
+	FILE *file = NULL;
+
+	memset(failure, 0, sizeof(struct failure_state));
+	if((file = fopen(path, "r")) == NULL)
+		return errno == ENOENT ? 0 : -1;
+	while(fgets(record, MAX_ROW, file) != NULL) {
+		stripChar(record, '\n');
+		parseFailure(failure, record);
+	}
+	fclose(file);
+	return 0;
+}
+
+/**
+ * @brief	replace the failure state, an empty state removes the file
+ *
+ * @param[in]	path	location of the failure state
+ * @param[in]	failure	state to store
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int storeFailure(char *path, struct failure_state *failure)
+{
+	char tmp_name[PATH_MAX] = {0};
+	FILE *file = NULL;
+	int fd = -1;
+
+	if(failure->count == 0 && failure->notified == 0)
+		return unlink(path) == 0 || errno == ENOENT ? 0 : -1;
+
+	snprintf(tmp_name, PATH_MAX, "%.*s.XXXXXX", PATH_MAX-8, path);
+	if((fd = mkstemp(tmp_name)) == -1)
+		return -1;
+	if((file = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(tmp_name);
+		return -1;
+	}
+	fprintf(file, "Context=%s\nReason=%d\nCount=%d\nRetry=%lld\nNotified=%u\n",
+			failure->context, failure->reason, failure->count,
+			(long long)failure->retry, failure->notified);
+	if(fclose(file) != 0 || rename(tmp_name, path) != 0) {
+		unlink(tmp_name);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	delay before the next retry after a number of failures
+ *
+ * @param[in]	count	consecutive failures (>= 1)
+ * @param[in]	seed	seed of the jitter
+ *
+ * @retval	delay in seconds, between 3/4 and all of the backoff
+ */
+time_t backoffDelay(int count, unsigned int seed)
+{
+	time_t delay = BACKOFF_BASE;
+
+	for(int i = 1 ; i < count && delay < BACKOFF_MAX ; i++)
+		delay *= 2;
+	if(delay > BACKOFF_MAX)
+		delay = BACKOFF_MAX;
+	return delay - (time_t)(rand_r(&seed) % (delay / 4 + 1));
+}
+
+/**
+ * @brief	check if the switch to a context waits for its retry
+ *
+ * @param[in]	failure	stored failure state
+ * @param[in]	context	target context of the switch
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	1	the switch is backed off
+ * @retval	0	the switch is attempted
+ */
+int backedOff(struct failure_state *failure, char *context, time_t rawtime)
+{
+	return failure->count > 0 && rawtime < failure->retry &&
+		strncmp(failure->context, context, MAX_COMMAND) == 0;
+}
+
+/**
+ * @brief	count a failed switch and set the time of the retry
+ *
+ * @param[in,out]	failure	failure state
+ * @param[in]	context	target context of the switch
+ * @param[in]	reason	SEND_STATE of the attempt
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	1	a new failure, to be reported
+ * @retval	0	the failure was reported before
+ */
+int recordFailure(struct failure_state *failure, char *context, SEND_STATE reason,
+		time_t rawtime)
+{
+	int distinct = failure->count == 0 || failure->reason != (int)reason ||
+		strncmp(failure->context, context, MAX_COMMAND) != 0;
+
+	if(failure->count == 0 || strncmp(failure->context, context, MAX_COMMAND) != 0)
+		failure->count = 0;
+	snprintf(failure->context, MAX_COMMAND, "%s", context);
+	failure->reason = reason;
+	failure->count++;
+	failure->retry = rawtime + backoffDelay(failure->count,
+			(unsigned int)rawtime ^ (unsigned int)getpid());
+	return distinct;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void clearFailure(struct failure_state *failure)
+{
+	failure->context[0] = '\0';
+	failure->reason = SEND_SUCCESS;
+	failure->count = 0;
+	failure->retry = 0;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	check if the errors of the config differ from the notified ones
+ *
+ * @param[in,out]	failure	failure state, the checksum is updated
+ * @param[in]	error	errors found while parsing
+ *
+ * @retval	1	the errors are new, to be notified
+ * @retval	0	no errors or notified before
+ */
+int newErrors(struct failure_state *failure, struct error *error)
+{
+	unsigned int sum = 0;
+
+	if(error->amount == 0) {
+		failure->notified = 0;
+		return 0;
+	}
+	sum = checksum(&error->amount, sizeof(int));
+	sum = extendChecksum(sum, error->error_code, error->amount * sizeof(int));
+	sum = extendChecksum(sum, error->rowindex, error->amount * sizeof(int));
+	for(int i = 0 ; i < error->amount ; i++)
+		sum = extendChecksum(sum, error->error_msg[i],
+				strnlen(error->error_msg[i], MAX_ROW));
+	/* 0 is reserved for no notification */
+	sum = sum == 0 ? 1 : sum;
+	if(sum == failure->notified)
+		return 0;
+	failure->notified = sum;
+	return 1;
+}
+
+/**
+ * @brief	describe the reason of a failed switch
+ *
+ * @param[in]	reason	SEND_STATE of the attempt
+ *
+ * @retval	description
+ */
+const char* sendReason(int reason)
+{
+	switch(reason) {
+		case SEND_UNKNOWN:
+			return "context not defined in the taskrc";
+		case SEND_LOCKED:
+			return "taskwarrior data locked";
+		case SEND_MISSING:
+			return "taskwarrior not found";
+		default:
+			return "taskwarrior failed";
+	}
+}
+
+/**
+ * @brief	switch the context, retry while the data of taskwarrior is locked
+ *
+ * @param[in]	profile	rc overrides of the profile (empty for the default taskrc)
+ * @param[in]	context	target context
+ * @param[out]	reaction	first line of the reaction, string of length MAX_ROW
+ *
+ * @retval	SEND_STATE of the last attempt
+ */
+SEND_STATE sendContext(char *profile, char *context, char *reaction)
+{
+	struct timespec wait = {0};
+	SEND_STATE result = SEND_FAILURE;
+
+	for(int attempt = 1 ; attempt <= LOCK_RETRIES ; attempt++) {
+		if((result = sendCommand(profile, context, reaction)) != SEND_LOCKED)
+			break;
+		if(verbose)
+			printf("taskwarrior data locked, attempt %d of %d\n", attempt,
+					LOCK_RETRIES);
+		if(attempt < LOCK_RETRIES) {
+			wait.tv_nsec = (long)attempt * LOCK_WAIT * 1000000L;
+			nanosleep(&wait, NULL);
+		}
+	}
+	return result;
+}
+
+/**
+ * @brief	notify the user of a failed switch
+ *
+ * @param[in]	failure	failure state of the switch
+ *
+ * @retval	0	notification send successful
+ * @retval	-1	sending failed
+ */
+int notifyFailure(struct failure_state *failure)
+{
+	char command[MAX_MSG] = {0};
+
+	snprintf(command, MAX_MSG,
+			"notify-send 'CSW switch to %s failed' '%s' --icon=dialog-error",
+			failure->context, sendReason(failure->reason));
+	return sendNotification(command);
+}
@@ -5,12 +5,17 @@
  * @brief	various functions used within different modules
  */
 
+#define _DEFAULT_SOURCE
+#include <fcntl.h>
 #include "include/helper.h"
 
 
 long encodeDay(struct tm*);
 long encode(struct tm*);
 
+/* rc overrides appended to every call of taskwarrior (see quietTask) */
+static char task_overrides[MAX_FIELD] = {0};
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 extern FILE *popen( const char *command, const char *modes);
 extern int pclose(FILE *stream);
@@ -186,6 +191,27 @@ int zoneValidation(char *name, struct zonetime *zone_t, char *context)
 	return 0;
 }
 
+/**
+ * @brief	set the rc overrides for the following calls of taskwarrior
+ *
+ * On a large database every call of taskwarrior pays for the garbage
+ * collection, the recurrence handling and the hook scripts, before the
+ * command itself is executed. Database=large switches them off.
+ *
+ * @param[in]	large	1 to switch off gc, hooks and recurrence
+ */
+void quietTask(int large)
+{
+	snprintf(task_overrides, MAX_FIELD, "%s", large == 1 ? TASK_QUIET : "");
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+char* taskOverrides(void)
+{
+	return task_overrides;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
 /**
  * @brief	use _get rc.context command from taskwarrior to get the current context
  *
@@ -196,26 +222,111 @@ int zoneValidation(char *name, struct zonetime *zone_t, char *context)
  */
 int currentContext(char* context)
 {
-	char command[MAX_COMMAND] = {0};
+	char command[MAX_ROW] = {0};
 	char full_output[MAX_COMMAND] = {0};
 	FILE* command_output = NULL;
 
-	strncpy(command, "task _get rc.context", MAX_COMMAND);
+	snprintf(command, MAX_ROW, "task%s _get rc.context", task_overrides);
 	command_output = popen(command, "r");
 	if(!command_output)
 		return -1;
 
 	if(fgets(full_output, MAX_CONTEXT, command_output) != NULL) {
-		strncpy(context, full_output, MAX_CONTEXT);
 		pclose(command_output);
-		if(context[0] == '\0')
-			return -1;
-
+		stripChar(full_output, '\n');
+		if(full_output[0] == '\0')
+			strncpy(full_output, "none", 5);
+		strncpy(context, full_output, MAX_CONTEXT);
 		return 0;
 	}
+	pclose(command_output);
 	return -1;
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int compareLong(const void *first, const void *second)
+{
+	long a = *(const long*)first;
+	long b = *(const long*)second;
+
+	return (a > b) - (a < b);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	nearest-rank percentile, sorts the values in place
+ *
+ * @param[in,out]	values	array of measurements
+ * @param[in]	amount	number of measurements
+ * @param[in]	rank	percentile between 1 and 100
+ *
+ * @retval	value at the percentile, 0 without measurements
+ */
+long percentile(long *values, int amount, int rank)
+{
+	int index = 0;
+
+	if(values == NULL || amount < 1)
+		return 0;
+
+	qsort(values, amount, sizeof(long), compareLong);
+	index = (amount * rank + 99) / 100 - 1;
+	if(index < 0)
+		index = 0;
+	return values[index];
+}
+
+/**
+ * @brief	locate the taskwarrior config of the user
+ *
+ * $TASKRC has precedence over .taskrc in the home directory.
+ *
+ * @param[out]	path	string of length PATH_MAX
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no user found in the environment
+ */
+int taskrcPath(char *path)
+{
+	char *taskrc = getenv("TASKRC");
+	char *home = getenv("HOME");
+	char *username = getenv("USER");
+
+	if(taskrc != NULL && taskrc[0] != '\0')
+		snprintf(path, PATH_MAX, "%s", taskrc);
+	else if(home != NULL && home[0] != '\0')
+		snprintf(path, PATH_MAX, "%s/.taskrc", home);
+	else if(username != NULL && username[0] != '\0')
+		snprintf(path, PATH_MAX, "/home/%s/.taskrc", username);
+	else
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @brief	expand a leading ~ of a path with $HOME
+ *
+ * @param[in]	location	path from a config
+ * @param[out]	path	string of length PATH_MAX
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no home directory in the environment
+ */
+int expandHome(char *location, char *path)
+{
+	char *home = getenv("HOME");
+
+	if(location[0] != '~') {
+		snprintf(path, PATH_MAX, "%s", location);
+		return 0;
+	}
+	if(home == NULL || home[0] == '\0')
+		return -1;
+	snprintf(path, PATH_MAX, "%s%.*s", home, PATH_MAX - 2, location + 1);
+	return 0;
+}
+
 /**
  * @brief	Check the string for a timespan format, return a minute integer.
  *
@@ -478,6 +589,83 @@ int getDate(struct tm *date, time_t rawtime)
 	return 0;
 }
 
+/**
+ * @brief	locate and create the directory for sockets and runtime files
+ *
+ * $XDG_RUNTIME_DIR/csw is used when the variable is set, /tmp/csw-{UID}
+ * otherwise. The directory is only accessible by the user.
+ *
+ * @param[out]	path	string of length PATH_MAX
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int runtimeDir(char *path)
+{
+	char *runtime = getenv("XDG_RUNTIME_DIR");
+	struct stat s;
+
+	if(runtime != NULL && runtime[0] != '\0')
+		snprintf(path, PATH_MAX, "%s/csw", runtime);
+	else
+		snprintf(path, PATH_MAX, "/tmp/csw-%d", (int)getuid());
+
+	if(mkdir(path, 0700) != 0 && errno != EEXIST)
+		return -1;
+
+	if(stat(path, &s) != 0 || !S_ISDIR(s.st_mode) || s.st_uid != getuid())
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @brief	read a whole regular file into a NUL terminated buffer
+ *
+ * Taskwarrior rewrites its files in place (truncate and write), a mapping
+ * of the file would fault on the pages past the new end. A file that
+ * shrinks while it is read only ends the read early.
+ *
+ * @param[in]	path	location of the file
+ * @param[out]	length	number of bytes read
+ *
+ * @retval	content on the heap, released with free
+ * @retval	NULL	the file is missing, unreadable or not a regular file
+ */
+char* readContent(char *path, size_t *length)
+{
+	struct stat s;
+	char *data = NULL;
+	ssize_t amount = 0;
+	int fd = -1;
+
+	*length = 0;
+	if((fd = open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK)) == -1)
+		return NULL;
+	if(fstat(fd, &s) != 0 || !S_ISREG(s.st_mode) ||
+			(data = malloc((size_t)s.st_size + 1)) == NULL) {
+		close(fd);
+		return NULL;
+	}
+	while(*length < (size_t)s.st_size) {
+		amount = read(fd, data + *length, (size_t)s.st_size - *length);
+		if(amount == -1 && errno == EINTR)
+			continue;
+		if(amount == -1) {
+			close(fd);
+			free(data);
+			*length = 0;
+			return NULL;
+		}
+		if(amount == 0)
+			break;
+		*length += (size_t)amount;
+	}
+	close(fd);
+	data[*length] = '\0';
+	return data;
+}
+
 /**
  * @brief	wrapper for sendNotification to send a error notification
  *
@@ -0,0 +1,353 @@
+/**
+ * @file hook.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	apply the context of the schedule from an on-launch hook of taskwarrior
+ *
+ * Without a hook csw has to force the context in the background, even
+ * while nobody runs task. The hook binary (on-launch-csw) is started by
+ * taskwarrior before every command and checks the schedule then. It never
+ * parses the config and never starts a process: the compiled config comes
+ * from the cache, the runtime state from the journal and the zone from the
+ * timeline of the last run of csw. Without a cache the hook does nothing.
+ *
+ * Taskwarrior has read the taskrc before the hook runs, a new context in
+ * the taskrc only applies to the following commands. The hook therefore
+ * rejects the command that found the wrong context, so the command never
+ * runs in it.
+ */
+
+#define _DEFAULT_SOURCE
+#include <sys/file.h>
+#include "include/hook.h"
+
+/**
+ * @brief	locate the config of the user (see findConfig)
+ *
+ * @param[out]	config_path	string of length PATH_MAX
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no user in the environment
+ */
+int hookConfig(char *config_path)
+{
+	char *username = getenv("USER");
+
+	if(username == NULL || username[0] == '\0')
+		return -1;
+	snprintf(config_path, PATH_MAX, "/home/%.*s/.task/csw/config", MAX_USER,
+			username);
+	return 0;
+}
+
+/**
+ * @brief	find the zone of the schedule with the state of the journal
+ *
+ * The timeline of the last run is used as long as it matches the config,
+ * otherwise the zones and exclusions are evaluated directly.
+ *
+ * @param[in,out]	config	compiled config, the journal is applied
+ * @param[in]	config_path	location of the config
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	index of the active zone
+ * @retval	-1	no zone is active, the day is excluded or a delay runs
+ */
+int scheduledZone(struct config *config, char *config_path, time_t rawtime)
+{
+	struct timeline timeline = {0};
+	struct tm datetime = {0};
+	char path[PATH_MAX] = {0};
+	int minute = (int)(rawtime / 60);
+	int zone = -1;
+
+	if(getDate(&datetime, rawtime) == -1)
+		return -1;
+	if(journalPath(path, config_path, config->persistent) == 0)
+		replayJournal(config, path);
+	if(config->delay.tm_year + config->delay.tm_mon + config->delay.tm_mday > 0 &&
+			checkDelay(0, &config->delay, &datetime) == VALID)
+		return -1;
+
+	if(timelinePath(path, config_path) == 0 && openTimeline(&timeline, path) == 0 &&
+			validTimeline(&timeline, scheduleHash(config), minute)) {
+		zone = lookupTimeline(&timeline, minute);
+		closeTimeline(&timeline);
+		return zone;
+	}
+	closeTimeline(&timeline);
+	if(switchExclusion(&config->excl, &datetime) == EXCLUSION_MATCH)
+		return -1;
+	return activeZone(config, datetime.tm_hour*60 + datetime.tm_min);
+}
+
+/**
+ * @brief	write a taskrc with a new context
+ *
+ * Every assignment of the context is dropped, the new one is appended.
+ * The context none is written as no assignment at all.
+ *
+ * @param[in]	data	content of the taskrc
+ * @param[in]	length	number of bytes in data
+ * @param[in]	context	new context
+ * @param[out]	out	stream for the new taskrc
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	writing failed
+ */
+int replaceContext(char *data, size_t length, char *context, FILE *out)
+{
+	char row[MAX_ROW] = {0};
+	char value[MAX_FIELD] = {0};
+	char *end = NULL;
+	size_t row_len = 0;
+
+	while(length > 0) {
+		end = memchr(data, '\n', length);
+		row_len = end != NULL ? (size_t)(end - data) + 1 : length;
+		snprintf(row, MAX_ROW, "%.*s", (int)row_len, data);
+		if(taskrcRow(row, "context", value, MAX_FIELD) != 0 &&
+				fwrite(data, 1, row_len, out) != row_len)
+			return -1;
+		if(end == NULL && fputc('\n', out) == EOF)
+			return -1;
+		data += row_len;
+		length -= row_len;
+	}
+	if(strncmp(context, "none", 5) != 0 && fprintf(out, "context=%s\n", context) < 0)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief	lock the taskrc against the other writers of csw
+ *
+ * The lock is taken on the file that is renamed over, the taskrc is
+ * compared with the key of its content under the lock. A writer that
+ * waited for the lock finds the renamed taskrc changed.
+ *
+ * @param[in]	path	resolved location of the taskrc
+ * @param[in]	key	identity of the taskrc the new content is based on
+ *
+ * @retval	descriptor holding the lock, released with close
+ * @retval	-1	the taskrc changed since key or can't be locked
+ */
+int lockTaskrc(char *path, struct file_key *key)
+{
+	struct file_key current = {0};
+	int fd = open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+
+	if(fd == -1)
+		return -1;
+	while(flock(fd, LOCK_EX) != 0) {
+		if(errno == EINTR)
+			continue;
+		close(fd);
+		return -1;
+	}
+	if(fileKey(path, &current) != 0 || !sameKey(&current, key)) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * @brief	write a copy of the taskrc that sets the new context
+ *
+ * The copy is written next to the taskrc with its permissions and renamed
+ * to the target. A symbolic link to the taskrc (e.g. from a dotfile
+ * repository) is resolved, the link is kept. The taskrc itself is only
+ * replaced under its lock and while it still matches the key, an edit
+ * since the read is never overwritten.
+ *
+ * @param[in]	taskrc_path	location of the taskrc
+ * @param[in]	target	location of the copy (NULL to replace the taskrc)
+ * @param[in]	key	identity of the taskrc when data was read (only used
+ * 			to replace the taskrc)
+ * @param[in]	data	content of the taskrc
+ * @param[in]	length	number of bytes in data
+ * @param[in]	context	new context
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE, the target is unchanged
+ */
+int copyContext(char *taskrc_path, char *target, struct file_key *key,
+		char *data, size_t length, char *context)
+{
+	char path[PATH_MAX] = {0};
+	char tmp_name[PATH_MAX] = {0};
+	struct stat s;
+	FILE *out = NULL;
+	int fd = -1;
+	int lock = -1;
+
+	if(realpath(taskrc_path, path) == NULL || stat(path, &s) != 0)
+		return -1;
+	snprintf(tmp_name, PATH_MAX, "%.*s.XXXXXX", PATH_MAX - 8, path);
+	if((fd = mkstemp(tmp_name)) == -1)
+		return -1;
+	if(fchmod(fd, s.st_mode & 07777) != 0 || (out = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(tmp_name);
+		return -1;
+	}
+
+	if(replaceContext(data, length, context, out) != 0) {
+		fclose(out);
+		unlink(tmp_name);
+		return -1;
+	}
+	if(fclose(out) != 0 ||
+			(target == NULL && (lock = lockTaskrc(path, key)) == -1) ||
+			rename(tmp_name, target != NULL ? target : path) != 0) {
+		if(lock != -1)
+			close(lock);
+		unlink(tmp_name);
+		return -1;
+	}
+	if(lock != -1)
+		close(lock);
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int writeContext(char *taskrc_path, struct file_key *key, char *data,
+		size_t length, char *context)
+{
+	return copyContext(taskrc_path, NULL, key, data, length, context);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	read the content of the taskrc
+ *
+ * The taskrc is read, not mapped: task context and task config rewrite it
+ * in place while other task processes run their hooks.
+ *
+ * @param[in]	path	location of the taskrc
+ * @param[out]	length	number of bytes read
+ *
+ * @retval	content of the taskrc, released with free
+ * @retval	NULL	the taskrc is missing, empty or unreadable
+ */
+char* readTaskrc(char *path, size_t *length)
+{
+	char *data = readContent(path, length);
+
+	if(data != NULL && *length == 0) {
+		free(data);
+		return NULL;
+	}
+	return data;
+}
+
+/**
+ * @brief	check that the taskrc defines a context
+ *
+ * @param[in]	data	content of the taskrc
+ * @param[in]	length	number of bytes in data
+ * @param[in]	context	name of the context, none is always defined
+ *
+ * @retval	1	the context is defined
+ * @retval	0	neither context.<name> nor context.<name>.read is set
+ */
+int contextDefined(char *data, size_t length, char *context)
+{
+	char key[MAX_ROW] = {0};
+	char filter[MAX_FILTER] = {0};
+
+	if(strncmp(context, "none", 5) == 0)
+		return 1;
+	snprintf(key, MAX_ROW, "context.%s.read", context);
+	if(taskrcBuffer(data, length, key, filter, MAX_FILTER) == 0)
+		return 1;
+	snprintf(key, MAX_ROW, "context.%s", context);
+	return taskrcBuffer(data, length, key, filter, MAX_FILTER) == 0;
+}
+
+/**
+ * @brief	compare the context of the taskrc with the schedule, switch it
+ *
+ * The cache is accepted with any taskrc, the hook itself changes the
+ * taskrc. The context of the zone has to be defined in the taskrc. A
+ * context set by hand since the last switch is kept until the next
+ * boundary, the zones decide on the boundary (no timeline is mapped).
+ *
+ * @param[in]	taskrc_path	location of the taskrc
+ * @param[in]	rawtime	current unix timestamp
+ * @param[out]	context	context of the zone, string of length MAX_COMMAND
+ *
+ * @retval	HOOK_CURRENT	the context of the zone is set
+ * @retval	HOOK_SWITCHED	the context of the zone was written to the taskrc
+ * @retval	HOOK_SKIPPED	no cache, no zone or a run of csw in progress
+ * @retval	HOOK_FAILED	the context can't be switched
+ */
+HOOK_STATE hookContext(char *taskrc_path, time_t rawtime, char *context)
+{
+	char config_path[PATH_MAX] = {0};
+	char cache_path[PATH_MAX] = {0};
+	char current[MAX_FIELD] = {"none"};
+	char journal_path[PATH_MAX] = {0};
+	struct cache_header header = {0};
+	struct timeline timeline = {0};
+	struct file_key key = {0};
+	struct compiled compiled;
+	HOOK_STATE result = HOOK_SKIPPED;
+	size_t length = 0;
+	char *data = NULL;
+	int zone = -1;
+	int lock = -1;
+
+	context[0] = '\0';
+	/* the cache is keyed on the base too, a missing base has a zero key */
+	fileKey(BASE_CONFIG, &header.base);
+	if(hookConfig(config_path) != 0 || cachePath(cache_path, config_path) != 0 ||
+			fileKey(config_path, &header.config) != 0 ||
+			cacheTaskrc(cache_path, &header.taskrc) != 0 ||
+			loadCache(cache_path, &header, &compiled) != 0)
+		return HOOK_SKIPPED;
+	if((zone = scheduledZone(&compiled.config, config_path, rawtime)) < 0 ||
+			zone >= compiled.config.zone_amount)
+		return HOOK_SKIPPED;
+	snprintf(context, MAX_COMMAND, "%s", compiled.config.zone_context[zone]);
+
+	/* the key is taken first, an edit during the read never matches it */
+	if(fileKey(taskrc_path, &key) != 0 ||
+			(data = readTaskrc(taskrc_path, &length)) == NULL)
+		return HOOK_FAILED;
+	taskrcBuffer(data, length, "context", current, MAX_FIELD);
+	if(current[0] == '\0')
+		snprintf(current, MAX_FIELD, "none");
+	if(strncmp(current, context, MAX_COMMAND) == 0) {
+		result = HOOK_CURRENT;
+		goto hook_done;
+	}
+	/* a context set by hand is kept until the next boundary */
+	if(compiled.config.applied[0] != '\0' &&
+			strncmp(compiled.config.applied, current, MAX_COMMAND) != 0 &&
+			!boundaryPassed(&timeline, &compiled.config,
+				(time_t)compiled.config.applied_at, rawtime)) {
+		result = HOOK_CURRENT;
+		goto hook_done;
+	}
+
+	if(!contextDefined(data, length, context)) {
+		result = HOOK_FAILED;
+		goto hook_done;
+	}
+
+	/* a run of csw switches the context right now */
+	if(lockRun(config_path, 0, &lock) != RUN_LOCKED)
+		goto hook_done;
+	result = writeContext(taskrc_path, &key, data, length, context) == 0 ?
+		HOOK_SWITCHED : HOOK_FAILED;
+	if(result == HOOK_SWITCHED &&
+			journalPath(journal_path, config_path, compiled.config.persistent) == 0)
+		journalApplied(journal_path, &compiled.config, context, rawtime);
+	unlockRun(lock);
+
+	hook_done:
+		free(data);
+		return result;
+}
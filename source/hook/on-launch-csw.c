@@ -0,0 +1,41 @@
+/**
+ * @file on-launch-csw.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	on-launch hook of taskwarrior, applies the context of the schedule
+ *
+ * Install as ~/.task/hooks/on-launch-csw. Taskwarrior passes the location
+ * of the taskrc as rc:<path>, the output is shown as feedback and a
+ * non-zero exit status rejects the command.
+ */
+
+#define _DEFAULT_SOURCE
+#include "../include/hook.h"
+
+int verbose = 0;
+
+int main(int argc, char **argv)
+{
+	char taskrc_path[PATH_MAX] = {0};
+	char context[MAX_COMMAND] = {0};
+
+	for(int i = 1 ; i < argc ; i++) {
+		if(strncmp(argv[i], "rc:", 3) == 0)
+			snprintf(taskrc_path, PATH_MAX, "%s", argv[i] + 3);
+	}
+	if(taskrc_path[0] == '\0' && taskrcPath(taskrc_path) != 0)
+		return EXIT_SUCCESS;
+
+	switch(hookContext(taskrc_path, time(NULL), context)) {
+		case HOOK_SWITCHED:
+			printf("csw switched the context to %s, run the command again\n", context);
+			return EXIT_FAILURE;
+		case HOOK_FAILED:
+			printf("csw couldn't switch the context to %s\n", context);
+			break;
+		case HOOK_CURRENT:
+		case HOOK_SKIPPED:
+			break;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,30 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <sys/wait.h>
+#include "tick.h"
+#include "users.h"
+#include "pool.h"
+#include "deadline.h"
+#include "taskrc.h"
+#include "wheel.h"
+#include "control.h"
+#include "scan.h"
+#include "share.h"
+#include "layer.h"
+#include "spawn.h"
+
+int runUsers(struct flags*, char*);
+int runUser(struct user_entry*, struct flags*, struct base_layer*, time_t);
+int spawnedUser(struct spawn_request*);
+pid_t startUser(struct user_entry*, struct flags*, struct base_layer*, time_t);
+USER_STATE evaluateUser(struct user_job*);
+struct user_job* prepareJobs(struct user_list*, struct flags*, char*,
+		struct schedule_table*, struct spawner*);
+int runJobs(struct user_job*, int, int);
+int userFiles(struct user_job*);
+void releaseJobs(struct user_job*, int);
+void reportJobs(struct user_job*, int, long);
+void scheduleUser(struct wheel*, struct user_job*, time_t);
+long monotonicNs(void);
+#endif /* BATCH_H */
@@ -0,0 +1,15 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "config.h"
+
+int cachePath(char*, char*);
+int fileKey(char*, struct file_key*);
+unsigned int checksum(const void*, size_t);
+unsigned int extendChecksum(unsigned int, const void*, size_t);
+int checkCache(const void*, size_t, struct cache_header*, struct compiled*);
+int loadCache(char*, struct cache_header*, struct compiled*);
+int cacheTaskrc(char*, struct file_key*);
+int storeCache(char*, struct cache_header*, struct compiled*);
+int sameKey(struct file_key*, struct file_key*);
+#endif /* CACHE_H */
@@ -0,0 +1,11 @@
+#ifndef CHAMPION_H
+#define CHAMPION_H
+
+#include <stdio.h>
+#include <string.h>
+#include "types.h"
+
+TASK_BACKEND taskBackend(char*);
+int championActive(char*, char (*)[UUID_LEN], int);
+int championTasks(char*, struct active_task*, int);
+#endif /* CHAMPION_H */
@@ -28,8 +28,9 @@ CONFIG_STATE readConfig(struct configcontent*, struct error*, char*);
 OPTION_STATE getOption(struct configcontent*, char*, int);
 int indexInList(struct configcontent*, int);
 int syncConfig(struct config*,struct flags*,struct tm*);
-int writeConfig(struct config*, char*);
 int parseConfig(struct configcontent*, struct error*, struct config*);
+int parseLayer(struct configcontent*, struct error*, struct config*,
+		struct context*);
 void buildBoolFormat(int, char*, char*);
 void addError(struct error*, int, char*, int);
 int dirExist(char*);
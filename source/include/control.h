@@ -0,0 +1,23 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include "types.h"
+#include "helper.h"
+
+#ifndef CONFIG_H
+#include <stdio.h>
+#include <string.h>
+#endif
+
+int openControl(struct control_server*, int, char*);
+void closeControl(struct control_server*);
+CONTROL_STATE handleControl(struct control_server*, int, unsigned int,
+		struct flags*, int*);
+void replyControl(struct control_server*, int, int);
+void dropControl(struct control_server*, int);
+int parseControl(char*, struct flags*);
+int buildControl(struct flags*, char*);
+int controlPath(char*);
+int sendControl(struct flags*, char*);
+int requestControl(char*, char*, char*);
+#endif /* CONTROL_H */
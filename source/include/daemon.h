@@ -0,0 +1,18 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "tick.h"
+#include "control.h"
+#include "batch.h"
+#include "enforce.h"
+
+int runDaemon(struct runtime*, struct flags*);
+int armTimer(int, time_t, int);
+void resetFlags(struct flags*);
+void markDue(struct wheel_timer*, void*);
+void isolateJob(struct user_job*, int, int, int*);
+void restoreJobs(struct user_job*, int, int, int*);
+int armWheel(int, struct wheel*);
+int watchUsers(int, int*, struct user_job*, int);
+int runBatchDaemon(struct flags*, char*);
+#endif /* DAEMON_H */
@@ -0,0 +1,19 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "types.h"
+
+int queueCreate(struct deadline_queue*, int);
+int queueSubmit(struct deadline_queue*, long, long, void (*)(void*), void*);
+void queueWait(struct deadline_queue*);
+void queueStop(struct deadline_queue*);
+int pushDeadline(struct deadline_queue*, struct deadline_entry*);
+int popDeadline(struct deadline_queue*, struct deadline_entry*);
+int removeDeadline(struct deadline_queue*, int, struct deadline_entry*);
+int releasedDeadline(struct deadline_queue*, long, long*);
+int earlierEntry(struct deadline_entry*, struct deadline_entry*);
+long realtimeMs(void);
+#endif /* DEADLINE_H */
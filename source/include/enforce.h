@@ -0,0 +1,12 @@
+#ifndef ENFORCE_H
+#define ENFORCE_H
+
+#include "pending.h"
+
+int contextFilter(char*, char*);
+int filterMatch(char*, struct active_task*);
+int watchTasks(struct task_watch*);
+int tasksChanged(struct task_watch*);
+int enforceContext(struct task_watch*, char*);
+void closeWatch(struct task_watch*);
+#endif /* ENFORCE_H */
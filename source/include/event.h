@@ -0,0 +1,18 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include "types.h"
+
+#ifndef CONFIG_H
+#include <stdio.h>
+#include <string.h>
+#endif
+
+int openEvents(struct event_server*, int, char*);
+void closeEvents(struct event_server*);
+int handleEvents(struct event_server*, int, unsigned int);
+void emitEvent(struct event_server*, char*, const char*, ...);
+int queueEvent(struct event_server*, int, char*, size_t);
+int flushSubscriber(struct event_server*, int);
+void dropSubscriber(struct event_server*, int);
+#endif /* EVENT_H */
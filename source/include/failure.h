@@ -0,0 +1,20 @@
+#ifndef FAILURE_H
+#define FAILURE_H
+
+#include <time.h>
+#include "journal.h"
+#include "cache.h"
+#include "switch.h"
+
+int failurePath(char*, char*, int);
+int loadFailure(char*, struct failure_state*);
+int storeFailure(char*, struct failure_state*);
+time_t backoffDelay(int, unsigned int);
+int backedOff(struct failure_state*, char*, time_t);
+int recordFailure(struct failure_state*, char*, SEND_STATE, time_t);
+void clearFailure(struct failure_state*);
+int newErrors(struct failure_state*, struct error*);
+const char* sendReason(int);
+SEND_STATE sendContext(char*, char*, char*);
+int notifyFailure(struct failure_state*);
+#endif /* FAILURE_H */
@@ -25,6 +25,10 @@ struct context* initContext(struct context*);
 void getContext(struct context*);
 int contextValidation(struct context*, char*);
 int currentContext(char*);
+void quietTask(int);
+char* taskOverrides(void);
+int taskrcPath(char*);
+int expandHome(char*, char*);
 
 /* zone related functions */
 int zoneValidation(char*, struct zonetime*, char*);
@@ -43,6 +47,14 @@ void resetTm(struct tm*);
 void copyTm(struct tm*, struct tm*);
 int getDate(struct tm *, time_t);
 
+/* location of sockets and runtime files */
+int runtimeDir(char*);
+char* readContent(char*, size_t*);
+
+/* statistics */
+int compareLong(const void*, const void*);
+long percentile(long*, int, int);
+
 /* notification handling functions */
 int notifyError(struct error*);
 int sendNotification(char *);
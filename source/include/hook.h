@@ -0,0 +1,21 @@
+#ifndef HOOK_H
+#define HOOK_H
+
+#include <fcntl.h>
+#include "cache.h"
+#include "journal.h"
+#include "timeline.h"
+#include "taskrc.h"
+#include "switch.h"
+#include "runlock.h"
+
+int hookConfig(char*);
+int scheduledZone(struct config*, char*, time_t);
+int replaceContext(char*, size_t, char*, FILE*);
+int lockTaskrc(char*, struct file_key*);
+int copyContext(char*, char*, struct file_key*, char*, size_t, char*);
+int writeContext(char*, struct file_key*, char*, size_t, char*);
+char* readTaskrc(char*, size_t*);
+int contextDefined(char*, size_t, char*);
+HOOK_STATE hookContext(char*, time_t, char*);
+#endif /* HOOK_H */
@@ -0,0 +1,14 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "config.h"
+
+int journalPath(char*, char*, int);
+int replayJournal(struct config*, char*);
+int applyRecord(struct config*, char*);
+int appendJournal(char*, char*);
+int journalChanges(char*, struct config*, struct config*);
+int compactJournal(char*, struct config*);
+int buildRecords(struct config*, struct config*, char*);
+int journalApplied(char*, struct config*, char*, time_t);
+#endif /* JOURNAL_H */
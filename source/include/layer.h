@@ -0,0 +1,12 @@
+#ifndef LAYER_H
+#define LAYER_H
+
+#include "cache.h"
+
+void emptyLayer(struct config*);
+int mergeConfig(struct config*, struct config*, struct context*, struct config*,
+		struct error*);
+int loadBase(char*, struct base_layer*);
+int layerConfig(struct configcontent*, struct error*, struct base_layer*,
+		struct config*);
+#endif /* LAYER_H */
@@ -0,0 +1,19 @@
+#ifndef PENDING_H
+#define PENDING_H
+
+#include "taskrc.h"
+#include "switch.h"
+#include "champion.h"
+
+int dataLocation(char*);
+int profileLocation(char*, char*);
+int pendingActive(char*, size_t, char (*)[UUID_LEN], int);
+int activeTasks(char*, char (*)[UUID_LEN], int);
+int pendingTasks(char*, size_t, struct active_task*, int);
+int activeDetails(char*, struct active_task*, int);
+int userActive(char (*)[UUID_LEN], int);
+int hasActiveTask(void);
+int directoryActive(char*, char (*)[UUID_LEN], int);
+int stopProfile(char*, char*);
+int stopActive(void);
+#endif /* PENDING_H */
@@ -0,0 +1,15 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+
+int poolCreate(struct pool*, int, int);
+int poolSubmit(struct pool*, void (*)(void*), void*);
+void poolWait(struct pool*);
+void poolStop(struct pool*);
+int pushJob(struct deque*, struct job*);
+int popJob(struct deque*, struct job*);
+int stealJob(struct deque*, struct job*);
+#endif /* POOL_H */
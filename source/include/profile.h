@@ -0,0 +1,11 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <time.h>
+#include "pool.h"
+#include "pending.h"
+#include "failure.h"
+
+int profileActions(struct config*, char*, int, struct profile_action*);
+int fanOut(struct profile_action*, int);
+#endif /* PROFILE_H */
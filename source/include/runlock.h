@@ -0,0 +1,12 @@
+#ifndef RUNLOCK_H
+#define RUNLOCK_H
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "types.h"
+#include "helper.h"
+
+int lockPath(char*, char*);
+RUN_LOCK lockRun(char*, int, int*);
+void unlockRun(int);
+#endif /* RUNLOCK_H */
@@ -0,0 +1,10 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "cache.h"
+
+int scanFiles(struct scan_file**, int);
+int scanSync(struct scan_file**, int);
+int setFile(struct scan_file*, char*, int);
+void releaseFile(struct scan_file*);
+#endif /* SCAN_H */
@@ -0,0 +1,13 @@
+#ifndef SHARE_H
+#define SHARE_H
+
+#include <pthread.h>
+#include "timeline.h"
+
+void initSchedules(struct schedule_table*);
+void freeSchedules(struct schedule_table*);
+struct shared_schedule* acquireSchedule(struct schedule_table*, struct config*, time_t);
+void releaseSchedule(struct schedule_table*, struct shared_schedule*);
+int scheduleZone(struct schedule_table*, struct shared_schedule*, time_t, int*);
+int scheduleNext(struct schedule_table*, struct shared_schedule*, time_t);
+#endif /* SHARE_H */
@@ -0,0 +1,11 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <sys/wait.h>
+#include <pthread.h>
+#include "config.h"
+
+int startSpawner(struct spawner*, int (*)(struct spawn_request*));
+int spawnRequest(struct spawner*, struct spawn_request*, int*);
+void stopSpawner(struct spawner*);
+#endif /* SPAWN_H */
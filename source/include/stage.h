@@ -0,0 +1,16 @@
+#ifndef STAGE_H
+#define STAGE_H
+
+#include "hook.h"
+#include "pending.h"
+
+int stagePath(char*, char*, int);
+int loadStage(char*, struct stage*);
+int storeStage(char*, struct stage*);
+void dropStage(char*, struct stage*);
+void dataKeys(char*, struct file_key*);
+int prepareStage(struct stage*, char*, char*, char*, time_t, int);
+int stageCurrent(struct stage*, char*, char*, char*, time_t);
+int commitStage(struct stage*, char*, char*);
+void stagedTasks(struct stage*, char*, struct profile_action*);
+#endif /* STAGE_H */
@@ -0,0 +1,23 @@
+#ifndef STATUS_H
+#define STATUS_H
+
+#include "types.h"
+
+#ifndef CONFIG_H
+#include <stdio.h>
+#include <string.h>
+#endif
+
+#define STATUS_NAME_LEN (MAX_USER+6)
+
+int statusName(char*);
+struct status* openStatus(char*, int);
+void closeStatus(struct status*);
+void publishStatus(struct status*, struct status*);
+int readStatus(struct status*, struct status*);
+int queryStatus(struct status*);
+void fillStatus(struct status*, struct config*, struct tm*, time_t, char*);
+void statusError(struct status*, struct status*, int, char*);
+void recordSkip(struct status*, time_t);
+void showStatus(struct status*);
+#endif /* STATUS_H */
@@ -6,8 +6,12 @@
 
 EXCLUSION_STATE switchExclusion(struct exclusion*, struct tm*);
 SWITCH_STATE switchContext(struct config*, int, char*, char*);
+SWITCH_STATE switchZone(struct config*, int, char*, char*);
 int rangeMatch(struct format_type*, struct tm*);
-int sendCommand(char *);
+int activeZone(struct config*, int);
+int nextZone(struct config*, int, int*);
+SEND_STATE sendCommand(char*, char*, char*);
 int activeTask();
-int stopTask(); 
+int stopCommand(char*, size_t, char*, char (*)[UUID_LEN], int);
+int stopTasks(char*, char (*)[UUID_LEN], int);
 #endif
@@ -0,0 +1,16 @@
+#ifndef TASKRC_H
+#define TASKRC_H
+
+#ifndef CONFIG_H
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "types.h"
+#include "helper.h"
+#endif /* CONFIG_H */
+
+int taskrcRow(char*, char*, char*, size_t);
+int taskrcValue(char*, char*, char*, size_t);
+int taskrcContext(char*, size_t);
+int taskrcBuffer(char*, size_t, char*, char*, size_t);
+#endif /* TASKRC_H */
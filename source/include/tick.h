@@ -0,0 +1,22 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include "config.h"
+#include "switch.h"
+#include "status.h"
+#include "event.h"
+#include "journal.h"
+#include "cache.h"
+#include "timeline.h"
+#include "layer.h"
+#include "control.h"
+#include "runlock.h"
+#include "pending.h"
+#include "failure.h"
+#include "profile.h"
+#include "stage.h"
+#include "trigger.h"
+
+int runTick(struct runtime*, struct flags*, time_t);
+void reportError(struct runtime*, struct status*, int, char*);
+#endif /* TICK_H */
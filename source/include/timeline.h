@@ -0,0 +1,25 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include "config.h"
+#include "switch.h"
+#include "cache.h"
+
+int timelinePath(char*, char*);
+void zoneIdentity(char*);
+unsigned int scheduleHash(struct config*);
+int sameSchedule(struct config*, struct config*);
+int dayProfile(struct config*, struct transition*);
+int buildTimeline(struct config*, time_t, int, struct transition*);
+int writeTimeline(char*, struct timeline_header*, struct transition*);
+int openTimeline(struct timeline*, char*);
+void closeTimeline(struct timeline*);
+int validTimeline(struct timeline*, unsigned int, int);
+struct transition* composeTimeline(struct config*, time_t, struct timeline_header*);
+int loadTimeline(struct timeline*, char*, struct config*, time_t);
+int memoryTimeline(struct timeline*, struct config*, time_t);
+int lookupTimeline(struct timeline*, int);
+struct transition* nextTransition(struct timeline*, int);
+int boundaryPassed(struct timeline*, struct config*, time_t, time_t);
+void timelineStatus(struct timeline*, struct config*, struct status*, time_t);
+#endif /* TIMELINE_H */
@@ -0,0 +1,13 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <signal.h>
+#include <dirent.h>
+#include <sys/wait.h>
+#include "journal.h"
+
+int hookLogPath(char*, char*, int);
+int prepareHooks(struct config*, int, struct hook_run*);
+void superviseHooks(struct hook_run*);
+int startHooks(struct hook_run*);
+#endif /* TRIGGER_H */
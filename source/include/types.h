@@ -9,6 +9,8 @@
 #define TYPES_H
 
 #include <time.h>
+#include <sys/types.h>
+#include <pthread.h>
 
 #define PATH_MAX 4096
 #define MAX_ZONES 10
@@ -17,10 +19,15 @@
 #define MAX_MSG 1024
 #define MAX_OPTION 128
 #define MAX_OPTION_NAME 40
-#define VALID_OPTIONS 9
-/* 10*zones, 10*exclusion & cancel,notify,delay,intervall + 1 temp delay */
-#define MAX_AMOUNT_OPTIONS 25
-#define MAX_SUBOPTIONS 4
+#define VALID_OPTIONS 13
+/* delay, cancel, notify, interval, state & database: one row each */
+#define MAX_SETTINGS 6
+/* zones, exclusions, settings, profiles & hooks, one per row */
+#define MAX_CONFIG_ROWS (MAX_ZONES + MAX_EXCLUSION + MAX_SETTINGS + MAX_PROFILES + \
+		MAX_HOOKS)
+/* rows of the config + 3 for the temporary delay and errors beyond the rows */
+#define MAX_AMOUNT_OPTIONS (MAX_CONFIG_ROWS + 3)
+#define MAX_SUBOPTIONS 5
 #define MAX_FIELD 96
 #define MAX_COMMAND 35
 #define MAX_USER 128
@@ -44,6 +51,62 @@
 #define DELAY_FORMAT_LEN 17
 #define MAX_ARG_LENGTH 20
 #define BAD_KEY -1
+#define MAX_SUBSCRIBER 32
+#define MAX_EVENT 256
+#define SUBSCRIBER_BUFFER 8192
+#define MAX_CONTROL 8
+#define JOURNAL_COMPACT 64
+#define CACHE_MAGIC "CSWC"
+#define CACHE_VERSION 7
+#define TIMELINE_MAGIC "CSWT"
+#define TIMELINE_VERSION 1
+#define TIMELINE_DAYS 365
+#define TIMELINE_REFRESH 7
+#define DAY_TRANSITIONS (2*MAX_ZONES+2)
+#define HOME_ROOT "/home"
+#define BASE_CONFIG "/etc/csw/config"
+#define POOL_QUEUE 64
+#define POOL_MAX_WORKERS 64
+#define ACTION_WORKERS 4
+#define SYSTEM_CONTROL_DIR "/run/csw"
+#define SYSTEM_CONTROL "/run/csw/control"
+#define BATCH_RETRY 5
+#define WHEEL_MINUTES 60
+#define WHEEL_HOURS 24
+#define WHEEL_DAYS 512
+#define SCAN_RING 256
+#define SCAN_DRAIN_RETRIES 3
+#define SCAN_FILES 3
+#define SPAWN_CHANNELS ACTION_WORKERS
+#define HERD_JITTER 20
+#define HERD_SLO 45
+#define UUID_LEN 37
+#define CHAMPION_BUSY 200
+#define STOP_UUIDS 64
+/* rc overrides of every taskwarrior call with Database=large */
+#define TASK_QUIET " rc.gc=off rc.hooks=off rc.recurrence=off"
+/* rc overrides of a stop, the result is the exit status */
+#define TASK_STOP " rc.verbose=nothing rc.confirmation=off rc.bulk=0"
+#define MAX_FILTER 256
+/* seconds before the first retry of a failed switch, doubled per failure */
+#define BACKOFF_BASE 60
+#define BACKOFF_MAX 3600
+/* attempts of a switch that found the data of taskwarrior locked */
+#define LOCK_RETRIES 3
+#define LOCK_WAIT 250
+/* taskwarrior profiles (taskrc + data) beside the default one */
+#define MAX_PROFILES 4
+/* minutes before a transition that it is staged (at least one interval) */
+#define STAGE_LEAD 5
+#define STAGE_VERSION 1
+/* data files of taskwarrior that identify the active tasks */
+#define STAGE_FILES 3
+/* commands run after a transition (Hook=), global and one per zone */
+#define MAX_HOOKS 4
+#define HOOK_WORKERS 2
+/* seconds before a hook is killed */
+#define HOOK_TIMEOUT 30
+#define HOOK_LOG_MAX 65536
 
 extern int verbose_flag;
 
@@ -91,6 +154,19 @@ struct exclusion {
  *
  * @var	interval	the interval in min, used for the cronjob execution
  *
+ * @var	persistent	keep the state journal in .task/csw instead of the
+ * 					runtime directory
+ *
+ * @var	large	taskwarrior is called without reports, gc, hooks and
+ * 				recurrence, active tasks are stopped by UUID
+ *
+ * @var	applied	context csw applied last, applied_at	its unix timestamp
+ *
+ * @var	profile	taskrc of further taskwarrior profiles
+ *
+ * @var	hook	commands run after every transition
+ * @var	zone_hook	command run after a transition into the zone (empty if none)
+ *
  * @date	2019-12-27
  */
 struct config {
@@ -103,6 +179,15 @@ struct config {
 	int cancel;
 	int notify;
 	int interval;
+	int persistent;
+	int large;
+	char applied[MAX_COMMAND];
+	long applied_at;
+	char profile[MAX_PROFILES][MAX_OPTION];
+	int profile_amount;
+	char hook[MAX_HOOKS][MAX_OPTION];
+	int hook_amount;
+	char zone_hook[MAX_ZONES][MAX_OPTION];
 };
 
 /**
@@ -141,6 +226,10 @@ struct substr {
 struct flags {
 	int delay;
 	int show;
+	int query;
+	int daemon;
+	int switch_now;
+	int all_users;
 	int cancel_on;
 	int notify_on;
 	int cron_interval;
@@ -173,6 +262,772 @@ struct loc_env {
 	int cron_env;
 };
 
+/**
+ * @struct status
+ * @brief	snapshot of the scheduler state, published in shared memory
+ *
+ * The record is guarded by a sequence lock, the writer increments the
+ * sequence before and after an update, a reader retries as long as the
+ * sequence is odd or changed during the copy.
+ *
+ * @var sequence	sequence lock counter, odd while an update is in progress
+ * @var	pid	process id of the last writer
+ * @var	updated	unix timestamp of the last update
+ * @var	context	active context in taskwarrior
+ * @var	zone	name of the zone covering the current time (empty if none)
+ * @var	next_zone	name of the zone that starts next
+ * @var	next_transition	unix timestamp of the start of the next zone
+ * @var	delay	unix timestamp of the end of the active delay (0 if none)
+ * @var	error_code	code of the last error (0 if the last run succeeded)
+ * @var	error_msg	description of the last error
+ * @var	skipped	ticks skipped because a run was in progress, updated
+ * 				atomically outside of the sequence lock
+ * @var	skipped_at	unix timestamp of the last skipped tick
+ *
+ * @date	2026-10-19
+ */
+struct status {
+	unsigned int sequence;
+	int pid;
+	time_t updated;
+	char context[MAX_FIELD];
+	char zone[MAX_FIELD];
+	char next_zone[MAX_FIELD];
+	time_t next_transition;
+	time_t delay;
+	int error_code;
+	char error_msg[MAX_ROW];
+	unsigned int skipped;
+	time_t skipped_at;
+};
+
+/**
+ * @struct file_key
+ * @brief	identity of a file version, all zero for a missing file
+ *
+ * @var	device	device of the file system
+ * @var	inode	inode number
+ * @var	size	size in bytes
+ * @var	mtime	modification time, seconds
+ * @var	mtime_nsec	modification time, nanoseconds
+ */
+struct file_key {
+	unsigned long long device;
+	unsigned long long inode;
+	long long size;
+	long long mtime;
+	long long mtime_nsec;
+};
+
+/**
+ * @struct cache_header
+ * @brief	header of the compiled config cache (config.bin)
+ *
+ * The cache is only valid if magic, version and size match the running
+ * binary, the keys match the config, the taskrc and the system-wide base
+ * on disk and the checksum matches the payload.
+ *
+ * @var	magic	CACHE_MAGIC
+ * @var	version	CACHE_VERSION
+ * @var	size	size of the payload (struct compiled)
+ * @var	checksum	FNV-1a checksum of the payload
+ * @var	config	key of the config of the user
+ * @var	taskrc	key of the taskwarrior config (contexts)
+ * @var	base	key of the system-wide base config (zero without a base)
+ */
+struct cache_header {
+	char magic[4];
+	unsigned int version;
+	unsigned int size;
+	unsigned int checksum;
+	struct file_key config;
+	struct file_key taskrc;
+	struct file_key base;
+};
+
+/**
+ * @struct compiled
+ * @brief	payload of the cache, the parsed and validated config
+ *
+ * @var	config	parsed config, contexts validated against taskwarrior
+ * @var	error	errors found while parsing
+ */
+struct compiled {
+	struct config config;
+	struct error error;
+};
+
+/**
+ * @struct base_layer
+ * @brief	compiled system-wide base config (BASE_CONFIG)
+ *
+ * @var	key	identity of the base config (zero without a base)
+ * @var	compiled	parsed base, contexts are validated per user
+ * @var	state	0 base available, 1 no base, -1 base unusable
+ */
+struct base_layer {
+	struct file_key key;
+	struct compiled compiled;
+	int state;
+};
+
+/**
+ * @struct transition
+ * @brief	point in time from which on a zone is active
+ *
+ * @var	minute	minutes since the epoch
+ * @var	zone	index of the zone, -1 if no zone is active or the day is
+ * 				excluded
+ */
+struct transition {
+	int minute;
+	int zone;
+};
+
+/**
+ * @struct timeline_header
+ * @brief	header of the precomputed timeline file
+ *
+ * @var	magic	TIMELINE_MAGIC
+ * @var	version	TIMELINE_VERSION
+ * @var	source	hash of the zones and exclusions the timeline was built from
+ * @var	checksum	FNV-1a checksum of the transitions
+ * @var	start	first minute covered by the timeline
+ * @var	end	first minute after the horizon of the timeline
+ * @var	amount	number of transitions following the header
+ */
+struct timeline_header {
+	char magic[4];
+	unsigned int version;
+	unsigned int source;
+	unsigned int checksum;
+	int start;
+	int end;
+	unsigned int amount;
+};
+
+/**
+ * @struct timeline
+ * @brief	mapped timeline with a cursor for forward moving lookups
+ *
+ * @var	header	start of the mapping (NULL if not mapped)
+ * @var	entry	sorted transitions behind the header
+ * @var	size	length of the mapping
+ * @var	cursor	index of the transition found by the last lookup
+ */
+struct timeline {
+	struct timeline_header *header;
+	struct transition *entry;
+	size_t size;
+	unsigned int cursor;
+};
+
+/**
+ * @struct user_entry
+ * @brief	account with a csw config, evaluated by the multi-user mode
+ *
+ * @var	uid	user id the actions are executed with
+ * @var	gid	primary group id
+ * @var	name	login name
+ * @var	home	home directory from the password database
+ */
+struct user_entry {
+	uid_t uid;
+	gid_t gid;
+	char name[MAX_USER];
+	char home[PATH_MAX];
+};
+
+/**
+ * @struct user_list
+ * @brief	growing array of the discovered users
+ *
+ * @var	user	array of users on the heap
+ * @var	amount	number of users
+ * @var	size	allocated number of users
+ */
+struct user_list {
+	struct user_entry *user;
+	int amount;
+	int size;
+};
+
+/**
+ * @struct wheel_timer
+ * @brief	timer of the timer wheel, linked into one slot of the wheel
+ *
+ * @var	expiry	minute since the epoch the timer fires at
+ * @var	owner	index of the owner (user) of the timer
+ * @var	kind	TIMER_KIND of the timer
+ * @var	prev	previous timer in the slot (NULL if not scheduled)
+ * @var	next	next timer in the slot (NULL if not scheduled)
+ */
+struct wheel_timer {
+	int expiry;
+	int owner;
+	int kind;
+	struct wheel_timer *prev;
+	struct wheel_timer *next;
+};
+
+/**
+ * @struct wheel
+ * @brief	hashed hierarchical timer wheel with minute resolution
+ *
+ * A timer is placed on the minute level if it fires within the next hour,
+ * on the hour level within the next day and on the day level otherwise.
+ * Hour and day slots are moved down a level when their boundary is
+ * reached. Every slot is the sentinel of a circular list.
+ *
+ * @var	minute	slots for the next WHEEL_MINUTES minutes
+ * @var	hour	slots for the next WHEEL_HOURS hours
+ * @var	day	slots hashed by the day since the epoch
+ * @var	current	next minute to process
+ * @var	amount	number of scheduled timers
+ */
+struct wheel {
+	struct wheel_timer minute[WHEEL_MINUTES];
+	struct wheel_timer hour[WHEEL_HOURS];
+	struct wheel_timer day[WHEEL_DAYS];
+	int current;
+	int amount;
+};
+
+/**
+ * @struct scan_file
+ * @brief	file of a user that is checked by the batched scan
+ *
+ * @var	path	location of the file (on the heap)
+ * @var	key	identity at the last scan, all zero if the file is missing
+ * @var	data	content at the last change (NULL if not read or missing)
+ * @var	size	number of bytes in data
+ * @var	read	1 if the content is required, 0 for the identity alone
+ * @var	state	SCAN_STATE of the last scan
+ */
+struct scan_file {
+	char *path;
+	struct file_key key;
+	char *data;
+	size_t size;
+	int read;
+	int state;
+};
+
+/**
+ * @struct ring
+ * @brief	io_uring instance used by the batched scan
+ *
+ * @var	fd	file descriptor of the ring
+ * @var	entries	number of submission queue entries
+ * @var	sq_head	consumer index of the submission queue (kernel)
+ * @var	sq_tail	producer index of the submission queue
+ * @var	sq_mask	index mask of the submission queue
+ * @var	sq_array	indexes into the submission queue entries
+ * @var	cq_head	consumer index of the completion queue
+ * @var	cq_tail	producer index of the completion queue (kernel)
+ * @var	cq_mask	index mask of the completion queue
+ * @var	sqe	submission queue entries
+ * @var	cqe	completion queue entries
+ * @var	sq_map	mapping of the submission queue ring
+ * @var	sq_size	size of sq_map
+ * @var	cq_map	mapping of the completion queue ring (equal to sq_map
+ * 				with a single mapping)
+ * @var	cq_size	size of cq_map
+ * @var	sqe_size	size of the mapping of the entries
+ */
+struct ring {
+	int fd;
+	unsigned entries;
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_sqe *sqe;
+	struct io_uring_cqe *cqe;
+	void *sq_map;
+	size_t sq_size;
+	void *cq_map;
+	size_t cq_size;
+	size_t sqe_size;
+};
+
+/**
+ * @struct shared_schedule
+ * @brief	timeline shared by all users with the same schedule
+ *
+ * @var	hash	scheduleHash of the zones, exclusions and time zone
+ * @var	references	number of users that use the schedule
+ * @var	tz	zoneIdentity of the time zone the timeline was built for
+ * @var	config	config of the first user, used to rebuild the timeline
+ * @var	timeline	timeline in anonymous memory
+ * @var	next	next schedule of the table
+ */
+struct shared_schedule {
+	unsigned int hash;
+	int references;
+	char tz[PATH_MAX];
+	struct config config;
+	struct timeline timeline;
+	struct shared_schedule *next;
+};
+
+/**
+ * @struct schedule_table
+ * @brief	distinct schedules of a multi-user process
+ *
+ * @var	first	list of the schedules
+ * @var	amount	number of schedules
+ * @var	builds	number of timelines built since the table was created
+ * @var	lock	protects the list and the timelines
+ */
+struct schedule_table {
+	struct shared_schedule *first;
+	int amount;
+	int builds;
+	pthread_mutex_t lock;
+};
+
+/**
+ * @struct job
+ * @brief	unit of work executed by a thread pool
+ *
+ * @var	run	function executed by a worker
+ * @var	arg	argument of the function
+ */
+struct job {
+	void (*run)(void*);
+	void *arg;
+};
+
+/**
+ * @struct deque
+ * @brief	growing ring buffer of jobs owned by one worker
+ *
+ * The owner takes the newest job, idle workers steal the oldest one.
+ *
+ * @var	job	ring buffer on the heap
+ * @var	capacity	allocated number of jobs
+ * @var	head	index of the oldest job
+ * @var	amount	number of queued jobs
+ * @var	lock	protects the deque
+ */
+struct deque {
+	struct job *job;
+	int capacity;
+	int head;
+	int amount;
+	pthread_mutex_t lock;
+};
+
+/**
+ * @struct pool_worker
+ * @brief	argument of a worker thread
+ *
+ * @var	pool	pool the worker belongs to
+ * @var	index	index of the own deque
+ */
+struct pool_worker {
+	struct pool *pool;
+	int index;
+};
+
+/**
+ * @struct pool
+ * @brief	work-stealing thread pool
+ *
+ * @var	thread	worker threads
+ * @var	worker	arguments of the worker threads
+ * @var	queue	one deque per worker
+ * @var	workers	number of worker threads
+ * @var	pending	submitted jobs that didn't finish yet
+ * @var	queued	submitted jobs that didn't start yet
+ * @var	limit	maximum of pending jobs, a submit blocks at the limit
+ * 				(0 for no limit)
+ * @var	stop	1 once the pool shuts down
+ * @var	next	deque that receives the next submitted job
+ * @var	lock	protects the counters
+ * @var	work	signaled when a job is queued or the pool stops
+ * @var	done	signaled when the last pending job finished
+ * @var	space	signaled when a pending job finished
+ */
+struct pool {
+	pthread_t *thread;
+	struct pool_worker *worker;
+	struct deque *queue;
+	int workers;
+	int pending;
+	int queued;
+	int limit;
+	int stop;
+	unsigned int next;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	pthread_cond_t space;
+};
+
+/**
+ * @struct deadline_entry
+ * @brief	job of the deadline queue
+ *
+ * @var	deadline	point in time the job has to be finished at (ms since
+ * 				the epoch)
+ * @var	release	the job doesn't start before this point in time (ms since
+ * 				the epoch)
+ * @var	run	function executed by a worker
+ * @var	arg	argument of the function
+ */
+struct deadline_entry {
+	long deadline;
+	long release;
+	void (*run)(void*);
+	void *arg;
+};
+
+/**
+ * @struct deadline_queue
+ * @brief	fixed number of workers serving a min-heap of deadlines
+ *
+ * @var	thread	worker threads, their number caps the concurrent jobs
+ * @var	heap	queued jobs, earliest deadline first
+ * @var	capacity	allocated number of jobs
+ * @var	amount	number of queued jobs
+ * @var	workers	number of worker threads
+ * @var	running	jobs executed right now
+ * @var	depth	highest number of queued jobs since the start
+ * @var	stop	1 once the queue shuts down
+ * @var	lock	protects the heap and the counters
+ * @var	work	signaled when a job is queued or the queue stops
+ * @var	done	signaled when the last job finished
+ */
+struct deadline_queue {
+	pthread_t *thread;
+	struct deadline_entry *heap;
+	int capacity;
+	int amount;
+	int workers;
+	int running;
+	int depth;
+	int stop;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+};
+
+/**
+ * @struct spawn_request
+ * @brief	run of the scheduler requested from the spawn server
+ *
+ * @var	user	target user
+ * @var	flag	parsed command line options (verbose is replaced)
+ * @var	rawtime	point in time shared by all users of the batch
+ * @var	base	system-wide base compiled by the process for the batch
+ */
+struct spawn_request {
+	struct user_entry user;
+	struct flags flag;
+	time_t rawtime;
+	struct base_layer base;
+};
+
+/**
+ * @struct spawner
+ * @brief	connection to the spawn server (zygote) of a multi-user process
+ *
+ * The server is forked before the process grows, every channel carries
+ * one request at a time.
+ *
+ * @var	pid	process of the spawn server
+ * @var	channel	parent side of the socket pairs
+ * @var	busy	1 while a request is pending on the channel
+ * @var	lock	protects busy
+ * @var	idle	signaled when a channel becomes free
+ */
+struct spawner {
+	pid_t pid;
+	int channel[SPAWN_CHANNELS];
+	int busy[SPAWN_CHANNELS];
+	pthread_mutex_t lock;
+	pthread_cond_t idle;
+};
+
+/**
+ * @struct user_job
+ * @brief	evaluation and action of one user in the multi-user mode
+ *
+ * @var	user	target user
+ * @var	flag	parsed command line options
+ * @var	actions	deadline queue for the runs that call taskwarrior
+ * @var	home_root	directory containing the home directories
+ * @var	rawtime	point in time shared by all users of the batch
+ * @var	start	begin of the evaluation in ns (monotonic clock)
+ * @var	latency	time from the evaluation to the end of the action in ns
+ * @var	boundary	minute the batch of the user belongs to (ms since the epoch)
+ * @var	deadline	end of the SLO of the run (ms since the epoch)
+ * @var	release	start of the run after the jitter (ms since the epoch)
+ * @var	finished	end of the run (ms since the epoch, 0 without a run)
+ * @var	state	result for the user
+ * @var	due	1 if the user is part of the next batch
+ * @var	timer	timers of the user in the multi-user daemon, by TIMER_KIND
+ * @var	file	config, taskrc and compiled cache of the user, by SCAN_FILE
+ * @var	schedules	distinct schedules of all users
+ * @var	schedule	schedule of the user (NULL before the first evaluation)
+ * @var	base	system-wide base config, loaded once per batch
+ * @var	spawner	spawn server for the runs (NULL to fork directly)
+ */
+struct user_job {
+	struct user_entry *user;
+	struct flags *flag;
+	struct deadline_queue *actions;
+	char *home_root;
+	time_t rawtime;
+	long start;
+	long latency;
+	long boundary;
+	long deadline;
+	long release;
+	long finished;
+	int state;
+	int due;
+	struct wheel_timer timer[2];
+	struct scan_file file[SCAN_FILES];
+	struct schedule_table *schedules;
+	struct shared_schedule *schedule;
+	struct base_layer *base;
+	struct spawner *spawner;
+};
+
+/**
+ * @struct subscriber
+ * @brief	client of the event stream with a bounded output buffer
+ *
+ * @var fd	connected socket of the client (-1 for an unused slot)
+ * @var	buffer	events not yet accepted by the socket
+ * @var	length	number of pending bytes in the buffer
+ */
+struct subscriber {
+	int fd;
+	char buffer[SUBSCRIBER_BUFFER];
+	size_t length;
+};
+
+/**
+ * @struct event_server
+ * @brief	listening socket and subscribers of the event stream
+ *
+ * @var	epoll	epoll instance of the daemon, the sockets are registered there
+ * @var	fd	listening socket
+ * @var	path	location of the socket in the file system
+ * @var	client	subscriber slots
+ * @var	dropped	number of subscribers dropped for not keeping up
+ */
+struct event_server {
+	int epoll;
+	int fd;
+	char path[PATH_MAX];
+	struct subscriber client[MAX_SUBSCRIBER];
+	int dropped;
+};
+
+/**
+ * @struct control_client
+ * @brief	connection to the control socket with a partial request line
+ *
+ * @var	fd	connected socket of the client (-1 for an unused slot)
+ * @var	buffer	request line received so far
+ * @var	length	number of received bytes
+ * @var	uid	user id of the peer
+ */
+struct control_client {
+	int fd;
+	char buffer[MAX_ROW];
+	size_t length;
+	uid_t uid;
+};
+
+/**
+ * @struct control_server
+ * @brief	listening socket of the daemon for command line mutations
+ *
+ * @var	epoll	epoll instance of the daemon
+ * @var	fd	listening socket
+ * @var	path	location of the socket in the file system
+ * @var	client	pending connections
+ */
+struct control_server {
+	int epoll;
+	int fd;
+	char path[PATH_MAX];
+	struct control_client client[MAX_CONTROL];
+};
+
+/**
+ * @struct active_task
+ * @brief	attributes of an active task a context filter is evaluated on
+ *
+ * @var	uuid	UUID of the task
+ * @var	project	project of the task (empty if none)
+ * @var	tags	tags of the task, separated by commas
+ * @var	modified	last modification (unix timestamp)
+ */
+struct active_task {
+	char uuid[UUID_LEN];
+	char project[MAX_FIELD];
+	char tags[MAX_ROW];
+	long modified;
+};
+
+/**
+ * @struct task_watch
+ * @brief	inotify watch of the taskwarrior data directory
+ *
+ * @var	fd	inotify instance (-1 if the directory isn't watched)
+ * @var	directory	data directory of taskwarrior
+ * @var	seen	active tasks found by the last check
+ * @var	amount	number of tasks in seen
+ */
+struct task_watch {
+	int fd;
+	char directory[PATH_MAX];
+	struct active_task seen[STOP_UUIDS];
+	int amount;
+};
+
+/**
+ * @struct failure_state
+ * @brief	persisted failures of the switch, the retries back off
+ *
+ * @var	context	target context of the failed switch
+ * @var	reason	SEND_STATE of the last attempt
+ * @var	count	consecutive failures of the switch to context
+ * @var	retry	earliest retry of the switch (unix timestamp)
+ * @var	notified	checksum of the config errors notified last (0 if none)
+ */
+struct failure_state {
+	char context[MAX_COMMAND];
+	int reason;
+	int count;
+	time_t retry;
+	unsigned int notified;
+};
+
+/**
+ * @struct profile_action
+ * @brief	switch of one taskwarrior profile, run concurrently with the others
+ *
+ * @var	name	taskrc of the profile ("default" for the taskrc of the user)
+ * @var	rc	rc overrides that select the profile (empty for the default)
+ * @var	directory	data directory of the profile (empty if unknown)
+ * @var	context	target context
+ * @var	cancel	1 to stop the active tasks after the switch
+ * @var	result	SEND_STATE of the switch
+ * @var	stopped	0 on success, -1 if the active tasks couldn't be stopped
+ * @var	elapsed	duration of the switch and the stop in ns
+ * @var	reaction	first line of the reaction of taskwarrior
+ * @var	staged	1 if the context was applied from the stage, only the stop is left
+ * @var	amount	staged active tasks to stop, -1 to read the data directory
+ * @var	uuid	UUIDs of the staged active tasks
+ */
+struct profile_action {
+	char name[MAX_OPTION];
+	char rc[PATH_MAX + MAX_ROW];
+	char directory[PATH_MAX];
+	char context[MAX_COMMAND];
+	int cancel;
+	int result;
+	int stopped;
+	long elapsed;
+	char reaction[MAX_ROW];
+	int staged;
+	int amount;
+	char uuid[STOP_UUIDS][UUID_LEN];
+};
+
+/**
+ * @struct stage
+ * @brief	transition prepared ahead of its boundary
+ *
+ * The copy of the taskrc with the next context (the artifact) replaces the
+ * taskrc at the boundary, as long as the taskrc is unchanged since the
+ * copy was written.
+ *
+ * @var	version	STAGE_VERSION of the stored stage
+ * @var	context	validated context of the next zone
+ * @var	at	unix timestamp of the boundary
+ * @var	taskrc	key of the taskrc the artifact was copied from
+ * @var	artifact	location of the copy of the taskrc
+ * @var	data	keys of the data files when the active tasks were read
+ * @var	amount	active tasks to stop, -1 if unknown
+ * @var	uuid	UUIDs of the active tasks
+ */
+struct stage {
+	int version;
+	char context[MAX_COMMAND];
+	long at;
+	struct file_key taskrc;
+	char artifact[PATH_MAX];
+	struct file_key data[STAGE_FILES];
+	int amount;
+	char uuid[STOP_UUIDS][UUID_LEN];
+};
+
+/**
+ * @struct hook_run
+ * @brief	commands of a transition, run in the background
+ *
+ * @var	command	commands to run
+ * @var	amount	number of commands
+ * @var	workers	commands running at the same time
+ * @var	timeout	seconds before a command is killed
+ * @var	zone	name of the new zone
+ * @var	from	previous context
+ * @var	to	new context
+ * @var	log	location of the log of the results
+ */
+struct hook_run {
+	char command[MAX_HOOKS + 1][MAX_OPTION];
+	int amount;
+	int workers;
+	int timeout;
+	char zone[MAX_FIELD];
+	char from[MAX_FIELD];
+	char to[MAX_COMMAND];
+	char log[PATH_MAX];
+};
+
+/**
+ * @struct runtime
+ * @brief	state that survives between two runs of the scheduler
+ *
+ * In the cron mode a single run is executed, the daemon keeps the runtime
+ * for the lifetime of the process.
+ *
+ * @var	status	mapped shared memory status record (NULL if unavailable)
+ * @var	events	event stream of the daemon (NULL in the cron mode)
+ * @var	interval	interval in minutes between two runs from the config
+ * @var	delay	end of the delay seen by the last run (0 if none)
+ * @var	excluded	1 if the last run matched an exclusion
+ * @var	applied	1 if the last run applied the flags to the config
+ * @var	timeline	precomputed transitions of the schedule
+ * @var	base	compiled base of the parent process (NULL to load it)
+ * @var	enforce	context of the active zone with Cancel=on, the daemon stops
+ * 				started tasks outside of it (empty if nothing is enforced)
+ */
+struct runtime {
+	struct status *status;
+	struct event_server *events;
+	struct timeline timeline;
+	struct base_layer *base;
+	int interval;
+	time_t delay;
+	int excluded;
+	int applied;
+	char enforce[MAX_COMMAND];
+};
+
 typedef enum{
 	CONFIG_SUCCESS,
 	CONFIG_BAD,
@@ -227,7 +1082,11 @@ typedef enum {
 	FIND_CANCEL,
 	FIND_NOTIFY,
 	FIND_INTERVAL,
-	FIND_EXCLUDE
+	FIND_EXCLUDE,
+	FIND_STATE,
+	FIND_DATABASE,
+	FIND_PROFILE,
+	FIND_HOOK
 }FIND;
 
 typedef enum {
@@ -245,6 +1104,63 @@ typedef enum {
 	TIME_ERROR
 }TIME_CMP;
 
+typedef enum {
+	CONTROL_IGNORED = -1,
+	CONTROL_HANDLED,
+	CONTROL_REQUEST
+}CONTROL_STATE;
+
+typedef enum {
+	TIMER_TRANSITION,
+	TIMER_DELAY
+}TIMER_KIND;
+
+typedef enum {
+	SCAN_MISSING,
+	SCAN_UNCHANGED,
+	SCAN_CHANGED,
+	SCAN_FAILED
+}SCAN_STATE;
+
+typedef enum {
+	FILE_CONFIG,
+	FILE_TASKRC,
+	FILE_CACHE
+}SCAN_FILE;
+
+typedef enum {
+	USER_IDLE,
+	USER_ACTION,
+	USER_FAILED
+}USER_STATE;
+
+typedef enum {
+	BACKEND_CHAMPION,
+	BACKEND_PENDING,
+	BACKEND_TASK
+}TASK_BACKEND;
+
+typedef enum {
+	RUN_LOCKED,
+	RUN_BUSY,
+	RUN_UNLOCKED
+}RUN_LOCK;
+
+typedef enum {
+	HOOK_CURRENT,
+	HOOK_SWITCHED,
+	HOOK_SKIPPED,
+	HOOK_FAILED
+}HOOK_STATE;
+
+typedef enum {
+	SEND_SUCCESS,
+	SEND_UNKNOWN,
+	SEND_LOCKED,
+	SEND_MISSING,
+	SEND_FAILURE
+}SEND_STATE;
+
 typedef enum {
 	CRON_ACTIVE,
 	CRON_CHANGE,
@@ -0,0 +1,14 @@
+#ifndef USERS_H
+#define USERS_H
+
+#include <pwd.h>
+#include <grp.h>
+#include "config.h"
+
+int userConfig(char*, char*, char*);
+int addUser(struct user_list*, struct passwd*);
+int discoverUsers(struct user_list*, char*);
+void freeUsers(struct user_list*);
+int userEnvironment(struct user_entry*);
+int dropPrivileges(struct user_entry*);
+#endif /* USERS_H */
@@ -0,0 +1,13 @@
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+
+void initWheel(struct wheel*, int);
+void addTimer(struct wheel*, struct wheel_timer*, int);
+void cancelTimer(struct wheel*, struct wheel_timer*);
+int advanceWheel(struct wheel*, int, void (*)(struct wheel_timer*, void*), void*);
+int nextExpiry(struct wheel*);
+#endif /* WHEEL_H */
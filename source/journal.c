@@ -0,0 +1,320 @@
+/**
+ * @file journal.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	append-only journal for the runtime state of the scheduler
+ *
+ * Delay, cancel, notify and interval changes from the command line are
+ * appended as config style records ("Cancel=on") to a journal instead of
+ * rewriting the config of the user, which is only read by csw.
+ * Replaying the journal on top of the parsed config restores the state,
+ * the last record of a key wins. Once the journal grows beyond
+ * JOURNAL_COMPACT records it is replaced by a snapshot of the current state.
+ * A switch by csw is recorded as well ("Applied=work@<unix time>"), a
+ * context that differs from it was set by hand.
+ *
+ * The journal is located in the runtime directory (tmpfs) by default,
+ * with State=persistent in the config it is kept next to the config.
+ */
+
+#define _DEFAULT_SOURCE
+#include <sys/file.h>
+#include "include/journal.h"
+
+/**
+ * @brief	locate the journal file
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	path of the config of the user
+ * @param[in]	persistent	1 to keep the journal in the config folder
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int journalPath(char *path, char *config_path, int persistent)
+{
+	char *separator = NULL;
+
+	if(persistent) {
+		if(config_path == NULL || (separator = strrchr(config_path, '/')) == NULL)
+			return -1;
+
+		snprintf(path, PATH_MAX, "%.*s/state",
+				(int)(separator - config_path), config_path);
+		return 0;
+	}
+	if(runtimeDir(path) != 0)
+		return -1;
+
+	strncat(path, "/state", PATH_MAX - strnlen(path, PATH_MAX) - 1);
+	return 0;
+}
+
+/**
+ * @brief	apply a single journal record to the config
+ *
+ * @param[out]	config	parsed config
+ * @param[in]	record	"Key=value" string, without the newline
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	unknown key or invalid value
+ */
+int applyRecord(struct config *config, char *record)
+{
+	char key[MAX_OPTION_NAME] = {0};
+	char value[MAX_OPTION] = {0};
+	struct tm delay = {0};
+	char *separator = NULL;
+	int number = 0;
+
+	if(sscanf(record, "%39[^=]=%127s", key, value) != 2)
+		return -1;
+
+	lowerCase(key, strnlen(key, MAX_OPTION_NAME));
+	if(strncmp(key, "delay", 6) == 0) {
+		if(strncmp(value, "none", 5) == 0) {
+			resetTm(&config->delay);
+			return 0;
+		}
+		if(parseDelay(&delay, value) != 0)
+			return -1;
+		copyTm(&config->delay, &delay);
+	} else if(strncmp(key, "cancel", 7) == 0) {
+		config->cancel = strncmp(value, "on", 3) == 0;
+	} else if(strncmp(key, "notify", 7) == 0) {
+		config->notify = strncmp(value, "on", 3) == 0;
+	} else if(strncmp(key, "interval", 9) == 0) {
+		if((number = parseTimeSpan(value)) == -1)
+			return -1;
+		config->interval = number;
+	} else if(strncmp(key, "applied", 8) == 0) {
+		if((separator = strrchr(value, '@')) == NULL || separator == value)
+			return -1;
+		*separator = '\0';
+		snprintf(config->applied, MAX_COMMAND, "%.*s", MAX_COMMAND - 1, value);
+		config->applied_at = strtol(separator + 1, NULL, 10);
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	apply every record of the journal on top of the parsed config
+ *
+ * @param[out]	config	parsed config
+ * @param[in]	path	location of the journal
+ *
+ * @retval	number of records in the journal on SUCCESS
+ * @retval	-1	the journal exists but can't be read
+ */
+int replayJournal(struct config *config, char *path)
+{
+	FILE *journal = NULL;
+	char record[MAX_ROW] = {0};
+	int amount = 0;
+
+	journal = fopen(path, "r");
+	if(!journal)
+		return errno == ENOENT ? 0 : -1;
+
+	while(fgets(record, MAX_ROW, journal) != NULL) {
+		stripChar(record, '\n');
+		if(record[0] == '\0')
+			continue;
+
+		applyRecord(config, record);
+		amount++;
+	}
+	fclose(journal);
+	return amount;
+}
+
+/**
+ * @brief	append records to the journal with a single write
+ *
+ * The journal is locked for the write, a journal replaced by a concurrent
+ * compaction is reopened.
+ *
+ * @param[in]	path	location of the journal
+ * @param[in]	records	newline terminated records
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int appendJournal(char *path, char *records)
+{
+	struct stat opened;
+	struct stat current;
+	size_t length = strnlen(records, MAX_ROW*4);
+	ssize_t written = 0;
+	int fd = -1;
+
+	for(int attempt = 0 ; attempt < 3 ; attempt++) {
+		fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+		if(fd == -1)
+			return -1;
+
+		if(flock(fd, LOCK_EX) != 0) {
+			close(fd);
+			return -1;
+		}
+		if(fstat(fd, &opened) == 0 && stat(path, &current) == 0 &&
+				opened.st_ino == current.st_ino) {
+			written = write(fd, records, length);
+			close(fd);
+			return written == (ssize_t)length ? 0 : -1;
+		}
+		close(fd);
+	}
+	return -1;
+}
+
+/**
+ * @brief	build the records for every runtime option that differs
+ *
+ * @param[in]	before	config before the change (NULL for a full snapshot)
+ * @param[in]	after	config after the change
+ * @param[out]	records	string of length MAX_ROW*4
+ *
+ * @retval	number of records
+ */
+int buildRecords(struct config *before, struct config *after, char *records)
+{
+	char buffer[MAX_ROW] = {0};
+	int amount = 0;
+
+	records[0] = '\0';
+	if(!before || before->delay.tm_year != after->delay.tm_year ||
+			before->delay.tm_mon != after->delay.tm_mon ||
+			before->delay.tm_mday != after->delay.tm_mday ||
+			before->delay.tm_hour != after->delay.tm_hour ||
+			before->delay.tm_min != after->delay.tm_min) {
+		buffer[0] = '\0';
+		if(after->delay.tm_year + after->delay.tm_mon + after->delay.tm_mday > 0)
+			buildDelayFormat(&after->delay, buffer);
+		if(buffer[0] == '\0')
+			strncpy(buffer, "Delay=none\n", MAX_ROW);
+		strncat(records, buffer, MAX_ROW*4 - strnlen(records, MAX_ROW*4) - 1);
+		amount++;
+	}
+	if(!before || before->cancel != after->cancel) {
+		buildBoolFormat(after->cancel, "Cancel", buffer);
+		strncat(records, buffer, MAX_ROW*4 - strnlen(records, MAX_ROW*4) - 1);
+		amount++;
+	}
+	if(!before || before->notify != after->notify) {
+		buildBoolFormat(after->notify, "Notify", buffer);
+		strncat(records, buffer, MAX_ROW*4 - strnlen(records, MAX_ROW*4) - 1);
+		amount++;
+	}
+	if((!before || before->interval != after->interval) && after->interval > 0) {
+		snprintf(buffer, MAX_ROW, "Interval=%dmin\n", after->interval);
+		strncat(records, buffer, MAX_ROW*4 - strnlen(records, MAX_ROW*4) - 1);
+		amount++;
+	}
+	if((!before || before->applied_at != after->applied_at ||
+			strncmp(before->applied, after->applied, MAX_COMMAND) != 0) &&
+			after->applied[0] != '\0') {
+		snprintf(buffer, MAX_ROW, "Applied=%s@%ld\n", after->applied, after->applied_at);
+		strncat(records, buffer, MAX_ROW*4 - strnlen(records, MAX_ROW*4) - 1);
+		amount++;
+	}
+	return amount;
+}
+
+/**
+ * @brief	append the runtime options changed by the command line
+ *
+ * @param[in]	path	location of the journal
+ * @param[in]	before	config before syncConfig
+ * @param[in]	after	config after syncConfig
+ *
+ * @retval	number of appended records on SUCCESS
+ * @retval	-1	FAILURE
+ */
+int journalChanges(char *path, struct config *before, struct config *after)
+{
+	char records[MAX_ROW*4] = {0};
+	int amount = buildRecords(before, after, records);
+
+	if(amount == 0)
+		return 0;
+
+	if(appendJournal(path, records) != 0)
+		return -1;
+
+	return amount;
+}
+
+/**
+ * @brief	replace the journal with a snapshot of the current state
+ *
+ * The snapshot is written to a temporary file in the same directory and
+ * renamed over the journal, readers either see the old or the new journal.
+ *
+ * @param[in]	path	location of the journal
+ * @param[in]	config	config with the replayed state
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int compactJournal(char *path, struct config *config)
+{
+	char records[MAX_ROW*4] = {0};
+	char tmp_name[PATH_MAX] = {0};
+	size_t length = 0;
+	int lock = -1;
+	int fd = -1;
+
+	snprintf(tmp_name, PATH_MAX, "%.*s.XXXXXX", PATH_MAX-8, path);
+	lock = open(path, O_RDONLY | O_CLOEXEC);
+	if(lock == -1 || flock(lock, LOCK_EX) != 0)
+		goto compact_failed;
+
+	fd = mkstemp(tmp_name);
+	if(fd == -1)
+		goto compact_failed;
+
+	buildRecords(NULL, config, records);
+	length = strnlen(records, MAX_ROW*4);
+	if(write(fd, records, length) != (ssize_t)length || fsync(fd) != 0) {
+		unlink(tmp_name);
+		goto compact_failed;
+	}
+	close(fd);
+	if(rename(tmp_name, path) != 0) {
+		unlink(tmp_name);
+		close(lock);
+		return -1;
+	}
+	close(lock);
+	return 0;
+
+	compact_failed:
+		if(fd != -1)
+			close(fd);
+		if(lock != -1)
+			close(lock);
+		return -1;
+}
+
+/**
+ * @brief	record the context applied by csw
+ *
+ * @param[in]	path	location of the journal
+ * @param[in,out]	config	config with the replayed state
+ * @param[in]	context	applied context
+ * @param[in]	rawtime	point in time of the switch
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int journalApplied(char *path, struct config *config, char *context, time_t rawtime)
+{
+	struct config before = *config;
+
+	snprintf(config->applied, MAX_COMMAND, "%s", context);
+	config->applied_at = (long)rawtime;
+	return journalChanges(path, &before, config) == -1 ? -1 : 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file layer.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	system-wide base config with per-user overrides
+ *
+ * BASE_CONFIG holds the schedule of the company (holidays, core hours).
+ * It is parsed once, without validating the contexts, and cached next to
+ * the base (config.bin, written by root). The config of a user is parsed
+ * as a small diff on top of the compiled base: a zone with the name of a
+ * base zone replaces it, other zones and the exclusions are added, the
+ * options of the user replace the options of the base. The contexts of
+ * the base zones are validated against the taskwarrior of the user.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/layer.h"
+
+/**
+ * @brief	prepare a config for the options of the user
+ *
+ * Options the user doesn't set keep the value -1 and are taken from the
+ * base by mergeConfig.
+ *
+ * @param[out]	diff	empty config
+ */
+void emptyLayer(struct config *diff)
+{
+	memset(diff, 0, sizeof(struct config));
+	diff->cancel = -1;
+	diff->notify = -1;
+	diff->interval = -1;
+	diff->persistent = -1;
+	diff->large = -1;
+}
+
+/**
+ * @brief	apply the options of the user on top of the base
+ *
+ * @param[in]	base	compiled base
+ * @param[in]	diff	options of the user, prepared with emptyLayer
+ * @param[in]	context	contexts of the user, NULL to skip the validation
+ * @param[out]	merged	resulting config
+ * @param[out]	error	errors of the merge (invalid base context, limits)
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	a limit was exceeded, zones or exclusions were dropped
+ */
+int mergeConfig(struct config *base, struct config *diff, struct context *context,
+		struct config *merged, struct error *error)
+{
+	char msg[MAX_ROW] = {0};
+	int overridden[MAX_ZONES] = {0};
+	int base_zones = base->zone_amount;
+	int result = 0;
+	int index = 0;
+
+	*merged = *base;
+	memset(merged->zone_hook, 0, sizeof(merged->zone_hook));
+	for(int i = 0 ; i < diff->zone_amount ; i++) {
+		for(index = 0 ; index < base_zones ; index++) {
+			if(strncmp(merged->zone_name[index], diff->zone_name[i], MAX_FIELD) == 0)
+				break;
+		}
+		if(index == base_zones) {
+			if(merged->zone_amount == MAX_ZONES) {
+				snprintf(msg, MAX_ROW, "Too many zones with the base:%s",
+						diff->zone_name[i]);
+				addError(error, -9, msg, 0);
+				result = 1;
+				continue;
+			}
+			index = merged->zone_amount++;
+		}
+		overridden[index] = 1;
+		memcpy(merged->zone_hook[index], diff->zone_hook[i], MAX_OPTION);
+		memcpy(merged->zone_name[index], diff->zone_name[i], MAX_FIELD);
+		memcpy(merged->zone_context[index], diff->zone_context[i], MAX_COMMAND);
+		merged->ztime[index] = diff->ztime[i];
+	}
+
+	for(int i = 0 ; context != NULL && i < base_zones ; i++) {
+		if(overridden[i] || merged->zone_context[i][0] == '\0' ||
+				contextValidation(context, merged->zone_context[i]) == 0)
+			continue;
+		snprintf(msg, MAX_ROW, "Invalid context in the base:%s",
+				merged->zone_context[i]);
+		addError(error, -5, msg, 0);
+		merged->zone_context[i][0] = '\0';
+	}
+
+	for(int i = 0 ; i < diff->excl.amount ; i++) {
+		if(merged->excl.amount == MAX_EXCLUSION) {
+			snprintf(msg, MAX_ROW, "Too many exclusions with the base:%s",
+					diff->excl.type_name[i]);
+			addError(error, -9, msg, 0);
+			result = 1;
+			continue;
+		}
+		index = merged->excl.amount++;
+		merged->excl.type[index] = diff->excl.type[i];
+		memcpy(merged->excl.type_name[index], diff->excl.type_name[i], TYPE_LEN);
+	}
+
+	/* a delay, the profiles and the hooks belong to the user, never inherited */
+	merged->delay = diff->delay;
+	memcpy(merged->profile, diff->profile, sizeof(diff->profile));
+	merged->profile_amount = diff->profile_amount;
+	memcpy(merged->hook, diff->hook, sizeof(diff->hook));
+	merged->hook_amount = diff->hook_amount;
+	if(diff->cancel != -1)
+		merged->cancel = diff->cancel;
+	if(diff->notify != -1)
+		merged->notify = diff->notify;
+	if(diff->interval != -1)
+		merged->interval = diff->interval;
+	if(diff->persistent != -1)
+		merged->persistent = diff->persistent;
+	if(diff->large != -1)
+		merged->large = diff->large;
+	return result;
+}
+
+/**
+ * @brief	provide the compiled base, from its cache or by parsing it
+ *
+ * @param[in]	path	location of the base config
+ * @param[out]	base	compiled base
+ *
+ * @retval	0	base available
+ * @retval	1	no base config
+ * @retval	-1	base config unreadable
+ */
+int loadBase(char *path, struct base_layer *base)
+{
+	struct configcontent content = {
+		.amount = 0, .rowindex = {0}, .option_name = {{{0}}}, .option_value = {{{0}}},
+		.sub_option_amount = {0} };
+	struct cache_header header = {0};
+	char cache_path[PATH_MAX] = {0};
+
+	memset(base, 0, sizeof(struct base_layer));
+	base->state = fileKey(path, &base->key);
+	if(base->state != 0)
+		return base->state;
+
+	header.config = base->key;
+	if(cachePath(cache_path, path) == 0 &&
+			loadCache(cache_path, &header, &base->compiled) == 0)
+		return 0;
+
+	if(readConfig(&content, &base->compiled.error, path) != CONFIG_SUCCESS) {
+		base->state = -1;
+		return -1;
+	}
+	parseLayer(&content, &base->compiled.error, &base->compiled.config, NULL);
+
+	/* only root can write next to the base, users parse it themselves */
+	if(storeCache(cache_path, &header, &base->compiled) == 0)
+		chmod(cache_path, 0644);
+	return 0;
+}
+
+/**
+ * @brief	parse the config of the user on top of the base
+ *
+ * @param[in]	content	config of the user from readConfig()
+ * @param[out]	error	errors of the base and of the config of the user
+ * @param[in]	base	compiled base
+ * @param[out]	config	merged config
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int layerConfig(struct configcontent *content, struct error *error,
+		struct base_layer *base, struct config *config)
+{
+	char msg[MAX_ROW] = {0};
+	struct error *base_error = &base->compiled.error;
+	struct context *context = NULL;
+	struct config diff;
+
+	context = initContext(context);
+	if(!context)
+		return -1;
+
+	for(int i = 0 ; i < base_error->amount ; i++) {
+		snprintf(msg, MAX_ROW, "base: %.*s", MAX_ROW-7, base_error->error_msg[i]);
+		addError(error, base_error->error_code[i], msg, base_error->rowindex[i]);
+	}
+	emptyLayer(&diff);
+	parseLayer(content, error, &diff, context);
+	mergeConfig(&base->compiled.config, &diff, context, config, error);
+	free(context);
+	return 0;
+}
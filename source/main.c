@@ -24,6 +24,7 @@
  * - Let the program notify you when certain actions are pending
  * - Cancel active tasks automatically on a switch, in order to prevent tasks
  *   from getting excess length
+ * - Keep the daemon (-D) stopping tasks that are started outside of the context
  * - Delay an imminent switch or cancel from happening with the delay command
  *
  * \section install_sec	How to install the tool
@@ -60,6 +61,15 @@
  *   	+ Exclude=temporary(2020-08-12,2020-08-15) (Exclude the 12th and
  *   	15th august of 2020)
  *
+ * \subsection	base	System-wide base schedule
+ *
+ * - zones and exclusions for everyone (core hours, company holidays) can be
+ *   placed in /etc/csw/config, the config of a user extends it
+ *   	+ a zone with the name of a base zone replaces the base zone
+ *   	+ other zones and exclusions of the user are added to the base
+ *   	+ Cancel, Notify, Interval and State of the user replace the base
+ * - the base is compiled once into /etc/csw/config.bin when csw runs as root
+ *
  * \subsection	cronjob	Cronjob
  *
  * - initially the program will create a cronjob with a 1 minute interval, if you
@@ -80,6 +90,31 @@
  *   	+ When a new delay is created upon an existing old one the new one is added to
  *   	the old
  *   	 => 20min remaining on the old one , create new for 30min => 50min delay
+ *
+ * \subsection	daemon	Daemon mode and event stream
+ *
+ * - csw -D runs the scheduler in the foreground on every interval instead of
+ *   a cronjob, use it from a systemd user unit or a session startup script
+ * - subscribers of the socket $XDG_RUNTIME_DIR/csw/events receive one line
+ *   per transition, delay, exclusion match and error as they happen
+ *   	+ Example: socat - UNIX-CONNECT:$XDG_RUNTIME_DIR/csw/events
+ * - while the daemon runs, -d, -c, -n, -i and -S (switch now) are sent to it
+ *   over $XDG_RUNTIME_DIR/csw/control and applied immediately
+ *
+ * \subsection	multiuser	Multi-user mode
+ *
+ * - csw -a run from the crontab of root serves every user with a config in
+ *   /home/$USER/.task/csw/config, the crontab entries of the users can be
+ *   removed
+ * - every user is evaluated with the credentials and the environment of the
+ *   user, failures of one user don't affect the others
+ * - csw -D -a keeps running as root and only wakes up for the transitions and
+ *   delays of the users, edits of a config are picked up immediately and
+ *   -d, -c, -n and -S of a user are sent to it over /run/csw/control
+ * - the switches of a common zone boundary are spread over the first 20
+ *   seconds (the same offset per user every time), at most 4 run at once and
+ *   all should end within 45 seconds, -v reports the queue depth and the
+ *   completion latency
  */
 
 #include <stdlib.h>
@@ -87,36 +122,23 @@
 #include "include/switch.h"
 #include "include/cronjob.h"
 #include "include/args.h"
+#include "include/status.h"
+#include "include/daemon.h"
+#include "include/batch.h"
 
 int verbose = 0;
 
 int main(int argc, char **argv) {
 	CRON_STATE cronjob_state = 0;
-	CONFIG_STATE config_state = 0;
-	FILE_STATE file_state = 0;
-	SWITCH_STATE switch_state = 0;
-	struct tm datetime = {0};
-	char config_path[PATH_MAX] = {0};
-	time_t rawtime;
-	struct config config = {
-		.zone_name={{0}}, .ztime={{0}}, .zone_context={{0}}, .zone_amount=0,
-		.excl={
-			.type={{.weekdays={0}, .single_days={{0}}, .holiday_start={0},
-				.holiday_end={0}, .list_len=0, .sub_type={0}}},
-			.type_name={{0}}, .amount=0, },
-		.delay={0}, .cancel=0, .notify=0, .interval=0 }; 
-	struct error error = {
-		.amount = 0, .rowindex = {0}, .error_code = {0}, .error_msg = {{0}} };
-	struct configcontent content = {
-		.amount = 0, .rowindex = {0}, .option_name = {{{0}}}, .option_value = {{{0}}},
-		.sub_option_amount = {0} };
 	struct flags flag = {
 		.verbose = &verbose,.cancel_on=-1,
 		.notify_on=-1,.cron_interval=-1 };
-	char current_context[MAX_CONTEXT] = {0};
-	char command[MAX_COMMAND] = {0};
+	char status_name[STATUS_NAME_LEN] = {0};
+	char response[MAX_ROW] = {0};
+	struct runtime rt = {0};
+	struct status state = {0};
 
-	if(getArgs(&flag, argc, argv, "hd:si:c:n:v::") == -1)
+	if(getArgs(&flag, argc, argv, "hd:si:c:n:qDSav::") == -1)
 		return 1;
 
 	if(flag.notify_on == 1) {
@@ -129,6 +151,42 @@ int main(int argc, char **argv) {
 		showHelp();
 		return EXIT_SUCCESS;
 	}
+	if(flag.query == 1) {
+		if(queryStatus(&state) != 0) {
+			fprintf(stderr, "No status published yet\n");
+			return EXIT_FAILURE;
+		}
+		showStatus(&state);
+		return EXIT_SUCCESS;
+	}
+
+	if(flag.all_users == 1) {
+		if(flag.switch_now || flag.delay || flag.cancel_on != -1 ||
+				flag.notify_on != -1 || flag.cron_interval != -1) {
+			fprintf(stderr, "Option -a: can only be combined with -D, -v and -s\n");
+			return EXIT_FAILURE;
+		}
+		if(flag.daemon == 1)
+			return runBatchDaemon(&flag, HOME_ROOT);
+		return runUsers(&flag, HOME_ROOT);
+	}
+
+	if(statusName(status_name) == 0)
+		rt.status = openStatus(status_name, 1);
+
+	if(flag.daemon == 1)
+		return runDaemon(&rt, &flag);
+
+	switch(sendControl(&flag, response)) {
+		case 0:
+			if(verbose)
+				printf("Request applied by the running daemon\n");
+			return EXIT_SUCCESS;
+		case -1:
+			fprintf(stderr, "ERROR: daemon answered: %s\n", response);
+			return EXIT_FAILURE;
+	}
+
 	cronjob_state = handleCrontab("csw", flag.cron_interval);
 	switch(cronjob_state) {
 		case CRON_ACTIVE:
@@ -151,107 +209,5 @@ int main(int argc, char **argv) {
 			fprintf(stderr, "ERROR, handleCrontab failed\n");
 	};
 
-	time(&rawtime);
-	if(getDate(&datetime, rawtime) == -1)
-		return EXIT_FAILURE;
-
-	file_state = findConfig("config", &config_path[0]);
-	switch(file_state) {
-		case FILE_GOOD:
-			if(verbose)
-				printf("File found and in good state at: %s\n", config_path);
-			break;
-		case FILE_NOTFOUND:
-			if(verbose)
-				printf("File was not found in .task/csw/\n");
-			return EXIT_FAILURE;
-		case FILE_ERROR:
-			fprintf(stderr,"ERROR: config file finder caused an error\n");
-			return EXIT_FAILURE;
-	}
-
-	config_state=readConfig(&content, &error, config_path);
-	switch(config_state) {
-		case CONFIG_SUCCESS:
-			if(verbose)
-				printf("config read success\n");
-			break;
-		case CONFIG_BAD:
-			fprintf(stderr, "config has a bad format, reading failed!\n");
-			return EXIT_FAILURE;
-		case CONFIG_NOTFOUND:
-			fprintf(stderr, "Config file was not found!\n");
-			return EXIT_FAILURE;
-	}
-
-	if(currentContext(current_context) != 0) {
-		fprintf(stderr, "ERROR: Couldn't aquire the active context\n");
-		return EXIT_FAILURE;
-	}
-	if(parseConfig(&content, &error, &config) != 0)
-		return EXIT_FAILURE;
-
-	if(flag.show == 1)
-		showZones(&config);
-
-	if(syncConfig(&config, &flag, &datetime) == 1) {
-		if(verbose)
-			printf("write changes to the config file\n");
-
-		if(writeConfig(&config, config_path) == -1)
-			return EXIT_FAILURE;
-	}
-
-	if(config.notify == 1 && error.amount > 0) {
-		if(notifyError(&error) == -1 && verbose)
-			fprintf(stderr, "WARNING: sending notification to notify daemon failed\n");
-	}
-
-	if(verbose) {
-		printf("current date & time : %d%s day of the week\t%4d-%02d-%02dT%02d:%02dZ\n",
-		       datetime.tm_wday, datetime.tm_wday==1?
-		       "st":datetime.tm_wday==2?"nd":
-		       datetime.tm_wday==3?"rd":"th",
-		       datetime.tm_year+1900, datetime.tm_mon+1,
-		       datetime.tm_mday, datetime.tm_hour, datetime.tm_min);
-	}
-
-	if(config.delay.tm_year + config.delay.tm_mon)
-		return EXIT_SUCCESS;
-
-	if(flag.show == 1 && config.excl.amount > 0)
-		showExclusions(&config.excl);
-
-	if(switchExclusion(&config.excl, &datetime) == 0) {
-		if(verbose)
-			printf("found a exclusion that matches\n");
-		return EXIT_SUCCESS;
-	}
-
-	switch_state = switchContext(&config, (datetime.tm_hour*60+datetime.tm_min),
-				     &command[0], current_context);
-	switch(switch_state) {
-		case SWITCH_SUCCESS:
-			if(sendCommand(command) != 0) {
-				fprintf(stderr, "Sending the command failed.\n");
-				return EXIT_FAILURE;
-			}
-			if(config.cancel && activeTask()) {
-				if(stopTask() != 0)
-					fprintf(stderr, "Task stop failed!\n");
-			}
-			if(verbose)
-				printf("Switch succesful!\n");
-			break;
-		case SWITCH_NOTNEEDED:
-			if(verbose)
-				printf("Switch not needed!\n");
-			return EXIT_SUCCESS;
-		case SWITCH_FAILURE:
-			if(verbose)
-				printf("Switch failed!\n");
-			return EXIT_FAILURE;
-	}
-
-	return EXIT_SUCCESS;
+	return runTick(&rt, &flag, time(NULL));
 }
@@ -0,0 +1,345 @@
+/**
+ * @file pending.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	find active tasks in the data files of taskwarrior 2.x
+ *
+ * task +ACTIVE renders a full report to answer a yes/no question. The
+ * pending tasks of taskwarrior 2.x are kept in pending.data, one task per
+ * line in the format [name:"value" name:"value"], quotes within a value
+ * are escaped. A task is active as long as it has a start attribute and
+ * the status pending. The file is read (taskwarrior truncates and rewrites
+ * it on a commit, a mapping could fault) and the lines are searched with
+ * memchr, a check for existence stops at the first hit. Taskwarrior 3
+ * replicas are read by champion.c, without a readable data file the
+ * report of taskwarrior is used. The found tasks are stopped by UUID.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "include/pending.h"
+
+char* attributeValue(char*, size_t, char*, size_t*);
+char* readPending(char*, size_t*);
+
+/**
+ * @brief	locate the data directory of taskwarrior
+ *
+ * $TASKDATA has precedence over data.location in the taskrc, the default
+ * is ~/.task. A leading ~ is expanded with $HOME.
+ *
+ * @param[out]	path	string of length PATH_MAX
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no home directory in the environment
+ */
+int dataLocation(char *path)
+{
+	char taskrc_path[PATH_MAX] = {0};
+	char *taskdata = getenv("TASKDATA");
+
+	if(taskdata != NULL && taskdata[0] != '\0')
+		return expandHome(taskdata, path);
+	if(taskrcPath(taskrc_path) != 0)
+		return expandHome("~/.task", path);
+	return profileLocation(taskrc_path, path);
+}
+
+/**
+ * @brief	locate the data directory of the given taskrc
+ *
+ * @param[in]	taskrc_path	location of the taskrc
+ * @param[out]	path	string of length PATH_MAX, data.location or ~/.task
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no home directory in the environment
+ */
+int profileLocation(char *taskrc_path, char *path)
+{
+	char location[PATH_MAX] = {0};
+
+	if(taskrcValue(taskrc_path, "data.location", location, PATH_MAX) != 0)
+		snprintf(location, PATH_MAX, "~/.task");
+	return expandHome(location, path);
+}
+
+/**
+ * @brief	find an attribute within a line of pending.data
+ *
+ * @param[in]	line	start of the line
+ * @param[in]	length	length of the line
+ * @param[in]	name	name of the attribute followed by :" (e.g. start:")
+ * @param[out]	value_len	length of the value
+ *
+ * @retval	pointer to the value within the line
+ * @retval	NULL	the task has no such attribute
+ */
+char* attributeValue(char *line, size_t length, char *name, size_t *value_len)
+{
+	size_t name_len = strlen(name);
+	char *match = line;
+	char *end = NULL;
+
+	while((match = memmem(match, length - (size_t)(match - line), name, name_len)) != NULL) {
+		/* an escaped value never contains a quote, the match is a name */
+		if(match == line || match[-1] == '[' || match[-1] == ' ')
+			break;
+		match++;
+	}
+	if(match == NULL)
+		return NULL;
+
+	match += name_len;
+	end = memchr(match, '"', length - (size_t)(match - line));
+	if(end == NULL)
+		return NULL;
+	*value_len = (size_t)(end - match);
+	return match;
+}
+
+/**
+ * @brief	collect the active tasks of the content of pending.data
+ *
+ * @param[in]	data	content of pending.data
+ * @param[in]	length	number of bytes in data
+ * @param[out]	uuid	UUIDs of the active tasks (NULL to count only)
+ * @param[in]	max	stop after max active tasks (1 to check for existence)
+ *
+ * @retval	number of active tasks, at most max
+ */
+int pendingActive(char *data, size_t length, char (*uuid)[UUID_LEN], int max)
+{
+	char *line = data;
+	char *end = NULL;
+	char *value = NULL;
+	size_t line_len = 0;
+	size_t value_len = 0;
+	int found = 0;
+
+	while(length > 0 && found < max) {
+		end = memchr(line, '\n', length);
+		line_len = end != NULL ? (size_t)(end - line) : length;
+
+		if(attributeValue(line, line_len, "start:\"", &value_len) != NULL &&
+				(value = attributeValue(line, line_len, "status:\"", &value_len)) != NULL &&
+				value_len == 7 && strncmp(value, "pending", 7) == 0) {
+			if(uuid != NULL) {
+				value = attributeValue(line, line_len, "uuid:\"", &value_len);
+				snprintf(uuid[found], UUID_LEN, "%.*s",
+						value != NULL ? (int)value_len : 0, value != NULL ? value : "");
+			}
+			found++;
+		}
+
+		line_len += end != NULL;
+		line += line_len;
+		length -= line_len;
+	}
+	return found;
+}
+
+/**
+ * @brief	read pending.data of a taskwarrior 2.x data directory
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ * @param[out]	length	number of bytes read (0 for an empty file)
+ *
+ * @retval	content of pending.data, released with free
+ * @retval	NULL	pending.data is not readable
+ */
+char* readPending(char *directory, size_t *length)
+{
+	char path[PATH_MAX] = {0};
+
+	snprintf(path, PATH_MAX, "%.*s/pending.data", PATH_MAX - 14, directory);
+	return readContent(path, length);
+}
+
+/**
+ * @brief	collect the active tasks of a taskwarrior 2.x data directory
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ * @param[out]	uuid	UUIDs of the active tasks (NULL to count only)
+ * @param[in]	max	stop after max active tasks (1 to check for existence)
+ *
+ * @retval	number of active tasks, at most max
+ * @retval	-1	pending.data is not readable
+ */
+int activeTasks(char *directory, char (*uuid)[UUID_LEN], int max)
+{
+	size_t length = 0;
+	char *data = readPending(directory, &length);
+	int found = 0;
+
+	if(data == NULL)
+		return -1;
+	found = pendingActive(data, length, uuid, max);
+	free(data);
+	return found;
+}
+
+/**
+ * @brief	read the attributes of the active tasks of the content of pending.data
+ *
+ * @param[in]	data	content of pending.data
+ * @param[in]	length	number of bytes in data
+ * @param[out]	task	attributes of the active tasks
+ * @param[in]	max	stop after max active tasks
+ *
+ * @retval	number of active tasks, at most max
+ */
+int pendingTasks(char *data, size_t length, struct active_task *task, int max)
+{
+	char *line = data;
+	char *end = NULL;
+	char *value = NULL;
+	size_t line_len = 0;
+	size_t value_len = 0;
+	int found = 0;
+
+	while(length > 0 && found < max) {
+		end = memchr(line, '\n', length);
+		line_len = end != NULL ? (size_t)(end - line) : length;
+
+		if(pendingActive(line, line_len, &task[found].uuid, 1) == 1) {
+			value = attributeValue(line, line_len, "project:\"", &value_len);
+			snprintf(task[found].project, MAX_FIELD, "%.*s",
+					value != NULL ? (int)value_len : 0, value != NULL ? value : "");
+			value = attributeValue(line, line_len, "tags:\"", &value_len);
+			snprintf(task[found].tags, MAX_ROW, "%.*s",
+					value != NULL ? (int)value_len : 0, value != NULL ? value : "");
+			value = attributeValue(line, line_len, "modified:\"", &value_len);
+			task[found].modified = value != NULL ? strtol(value, NULL, 10) : 0;
+			found++;
+		}
+
+		line_len += end != NULL;
+		line += line_len;
+		length -= line_len;
+	}
+	return found;
+}
+
+/**
+ * @brief	read the attributes of the active tasks of the user
+ *
+ * @param[in]	directory	data directory (see dataLocation)
+ * @param[out]	task	attributes of the active tasks
+ * @param[in]	max	stop after max active tasks
+ *
+ * @retval	number of active tasks, at most max
+ * @retval	-1	neither pending.data nor the replica can be read
+ */
+int activeDetails(char *directory, struct active_task *task, int max)
+{
+	size_t length = 0;
+	char *data = NULL;
+	int found = 0;
+
+	switch(taskBackend(directory)) {
+		case BACKEND_CHAMPION:
+			return championTasks(directory, task, max);
+		case BACKEND_PENDING:
+			break;
+		case BACKEND_TASK:
+			return -1;
+	}
+	if((data = readPending(directory, &length)) == NULL)
+		return -1;
+	found = pendingTasks(data, length, task, max);
+	free(data);
+	return found;
+}
+
+/**
+ * @brief	collect the active tasks of a data directory
+ *
+ * Reads the replica of taskwarrior 3 or pending.data of taskwarrior 2.x
+ * directly, whichever the data directory contains (taskBackend).
+ *
+ * @param[in]	directory	data directory of taskwarrior
+ * @param[out]	uuid	UUIDs of the active tasks (NULL to count only)
+ * @param[in]	max	stop after max active tasks (1 to check for existence)
+ *
+ * @retval	number of active tasks, at most max
+ * @retval	-1	neither can be read, only taskwarrior knows
+ */
+int directoryActive(char *directory, char (*uuid)[UUID_LEN], int max)
+{
+	switch(taskBackend(directory)) {
+		case BACKEND_CHAMPION:
+			return championActive(directory, uuid, max);
+		case BACKEND_PENDING:
+			return activeTasks(directory, uuid, max);
+		case BACKEND_TASK:
+			break;
+	}
+	return -1;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int userActive(char (*uuid)[UUID_LEN], int max)
+{
+	char directory[PATH_MAX] = {0};
+
+	if(dataLocation(directory) != 0)
+		return -1;
+	return directoryActive(directory, uuid, max);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	check if the user has an active task
+ *
+ * Asks taskwarrior only if the data directory can't be read (userActive).
+ *
+ * @retval	1	at least one task is active
+ * @retval	0	no active task
+ */
+int hasActiveTask(void)
+{
+	int found = userActive(NULL, 1);
+
+	if(found == -1)
+		return activeTask();
+	return found > 0;
+}
+
+/**
+ * @brief	stop the active tasks of a taskwarrior profile
+ *
+ * Detection and stop are a single call of taskwarrior: the active tasks
+ * are read from the data directory and stopped by UUID. No call at all
+ * is made without an active task. If the data directory can't be read or
+ * holds more than STOP_UUIDS active tasks, taskwarrior filters +ACTIVE.
+ *
+ * @param[in]	profile	rc overrides of the profile (empty for the default taskrc)
+ * @param[in]	directory	data directory of the profile (empty if unknown)
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	taskwarrior failed to stop the tasks
+ */
+int stopProfile(char *profile, char *directory)
+{
+	char uuid[STOP_UUIDS][UUID_LEN];
+	int found = directory[0] != '\0' ? directoryActive(directory, uuid, STOP_UUIDS) : -1;
+
+	if(found == 0)
+		return 0;
+	if(found == -1 || found == STOP_UUIDS)
+		return stopTasks(profile, NULL, 0);
+	return stopTasks(profile, uuid, found);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int stopActive(void)
+{
+	char directory[PATH_MAX] = {0};
+
+	if(dataLocation(directory) != 0)
+		directory[0] = '\0';
+	return stopProfile("", directory);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -0,0 +1,275 @@
+/**
+ * @file pool.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	work-stealing thread pool
+ *
+ * Every worker owns a deque, submitted jobs are spread over the deques.
+ * A worker takes the newest job of its own deque and steals the oldest
+ * job of another deque once its own is empty, so a few slow jobs don't
+ * hold back the rest. A pool with a limit blocks the submitter while
+ * the limit of pending jobs is reached.
+ */
+
+#include "include/pool.h"
+
+void* runWorker(void*);
+int takeJob(struct pool*, int, struct job*);
+
+/**
+ * @brief	append a job to the deque, grow the deque if it is full
+ *
+ * @param[in,out]	deque	target deque, locked by the caller
+ * @param[in]	job	job to append
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	allocation failed
+ */
+int pushJob(struct deque *deque, struct job *job)
+{
+	struct job *grown = NULL;
+	int capacity = 0;
+
+	if(deque->amount == deque->capacity) {
+		capacity = deque->capacity ? deque->capacity*2 : POOL_QUEUE;
+		grown = malloc(capacity * sizeof(struct job));
+		if(grown == NULL)
+			return -1;
+		for(int i = 0 ; i < deque->amount ; i++)
+			grown[i] = deque->job[(deque->head + i) % deque->capacity];
+		free(deque->job);
+		deque->job = grown;
+		deque->capacity = capacity;
+		deque->head = 0;
+	}
+	deque->job[(deque->head + deque->amount) % deque->capacity] = *job;
+	deque->amount++;
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int popJob(struct deque *deque, struct job *job)
+{
+	if(deque->amount == 0)
+		return -1;
+
+	deque->amount--;
+	*job = deque->job[(deque->head + deque->amount) % deque->capacity];
+	return 0;
+}
+
+int stealJob(struct deque *deque, struct job *job)
+{
+	if(deque->amount == 0)
+		return -1;
+
+	*job = deque->job[deque->head];
+	deque->head = (deque->head + 1) % deque->capacity;
+	deque->amount--;
+	return 0;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	take a job from the own deque or steal one from another worker
+ *
+ * @param[in]	pool	thread pool
+ * @param[in]	index	index of the calling worker
+ * @param[out]	job	job to execute
+ *
+ * @retval	0	job found
+ * @retval	-1	every deque is empty
+ */
+int takeJob(struct pool *pool, int index, struct job *job)
+{
+	struct deque *deque = NULL;
+	int result = -1;
+
+	for(int i = 0 ; i < pool->workers && result != 0 ; i++) {
+		deque = &pool->queue[(index + i) % pool->workers];
+		pthread_mutex_lock(&deque->lock);
+		result = i == 0 ? popJob(deque, job) : stealJob(deque, job);
+		pthread_mutex_unlock(&deque->lock);
+	}
+	if(result == 0) {
+		pthread_mutex_lock(&pool->lock);
+		pool->queued--;
+		pthread_mutex_unlock(&pool->lock);
+	}
+	return result;
+}
+
+/**
+ * @brief	main loop of a worker, runs jobs until the pool stops
+ *
+ * @param[in]	arg	struct pool_worker of the thread
+ *
+ * @retval	NULL
+ */
+void* runWorker(void *arg)
+{
+	struct pool_worker *worker = arg;
+	struct pool *pool = worker->pool;
+	struct job job;
+
+	for(;;) {
+		if(takeJob(pool, worker->index, &job) == 0) {
+			job.run(job.arg);
+			pthread_mutex_lock(&pool->lock);
+			pool->pending--;
+			if(pool->pending == 0)
+				pthread_cond_broadcast(&pool->done);
+			pthread_cond_signal(&pool->space);
+			pthread_mutex_unlock(&pool->lock);
+			continue;
+		}
+
+		pthread_mutex_lock(&pool->lock);
+		while(pool->queued == 0 && !pool->stop)
+			pthread_cond_wait(&pool->work, &pool->lock);
+		if(pool->queued == 0 && pool->stop) {
+			pthread_mutex_unlock(&pool->lock);
+			break;
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+	return NULL;
+}
+
+/**
+ * @brief	start the worker threads of a pool
+ *
+ * @param[out]	pool	thread pool
+ * @param[in]	workers	number of worker threads
+ * @param[in]	limit	maximum of pending jobs (0 for no limit)
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int poolCreate(struct pool *pool, int workers, int limit)
+{
+	int started = 0;
+
+	memset(pool, 0, sizeof(struct pool));
+	if(workers < 1)
+		workers = 1;
+	if(workers > POOL_MAX_WORKERS)
+		workers = POOL_MAX_WORKERS;
+
+	pool->thread = calloc(workers, sizeof(pthread_t));
+	pool->worker = calloc(workers, sizeof(struct pool_worker));
+	pool->queue = calloc(workers, sizeof(struct deque));
+	if(pool->thread == NULL || pool->worker == NULL || pool->queue == NULL)
+		goto create_failed;
+
+	pool->workers = workers;
+	pool->limit = limit;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	pthread_cond_init(&pool->space, NULL);
+	for(int i = 0 ; i < workers ; i++)
+		pthread_mutex_init(&pool->queue[i].lock, NULL);
+
+	for(started = 0 ; started < workers ; started++) {
+		pool->worker[started].pool = pool;
+		pool->worker[started].index = started;
+		if(pthread_create(&pool->thread[started], NULL, runWorker,
+					&pool->worker[started]) != 0)
+			break;
+	}
+	if(started == 0)
+		goto create_failed;
+
+	pool->workers = started;
+	return 0;
+
+	create_failed:
+		free(pool->thread);
+		free(pool->worker);
+		free(pool->queue);
+		memset(pool, 0, sizeof(struct pool));
+		return -1;
+}
+
+/**
+ * @brief	queue a job, block while the limit of the pool is reached
+ *
+ * @param[in]	pool	thread pool
+ * @param[in]	run	function executed by a worker
+ * @param[in]	arg	argument of the function
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	allocation failed, the job was not queued
+ */
+int poolSubmit(struct pool *pool, void (*run)(void*), void *arg)
+{
+	struct job job = {.run = run, .arg = arg};
+	struct deque *deque = NULL;
+	int result = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	while(pool->limit > 0 && pool->pending >= pool->limit)
+		pthread_cond_wait(&pool->space, &pool->lock);
+	pool->pending++;
+	deque = &pool->queue[pool->next++ % pool->workers];
+	pthread_mutex_unlock(&pool->lock);
+
+	pthread_mutex_lock(&deque->lock);
+	result = pushJob(deque, &job);
+	pthread_mutex_unlock(&deque->lock);
+
+	pthread_mutex_lock(&pool->lock);
+	if(result == 0) {
+		pool->queued++;
+		pthread_cond_signal(&pool->work);
+	} else {
+		pool->pending--;
+		if(pool->pending == 0)
+			pthread_cond_broadcast(&pool->done);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return result;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void poolWait(struct pool *pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	while(pool->pending > 0)
+		pthread_cond_wait(&pool->done, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	finish the queued jobs, join the workers and release the pool
+ *
+ * @param[in]	pool	thread pool
+ */
+void poolStop(struct pool *pool)
+{
+	if(pool->thread == NULL)
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->work);
+	pthread_mutex_unlock(&pool->lock);
+
+	for(int i = 0 ; i < pool->workers ; i++)
+		pthread_join(pool->thread[i], NULL);
+
+	for(int i = 0 ; i < pool->workers ; i++) {
+		free(pool->queue[i].job);
+		pthread_mutex_destroy(&pool->queue[i].lock);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->work);
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->space);
+	free(pool->thread);
+	free(pool->worker);
+	free(pool->queue);
+	memset(pool, 0, sizeof(struct pool));
+}
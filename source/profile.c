@@ -0,0 +1,195 @@
+/**
+ * @file profile.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	switch several taskwarrior profiles at once
+ *
+ * Separate databases (e.g. work and personal) are selected by their own
+ * taskrc. Every Profile=<taskrc> of the config follows the schedule next
+ * to the taskrc of the user: the profile is addressed with rc:<taskrc>
+ * and the data.location of that taskrc (both quoted for the shell), the
+ * environment of the user ($TASKRC, $TASKDATA) never leaks into it. A profile that already has
+ * the context of the zone (read from its taskrc) is left alone.
+ *
+ * The switch and the stop of the active tasks of every profile run
+ * concurrently on a thread pool with a worker per profile, a transition
+ * takes as long as the slowest profile instead of the sum of all.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/profile.h"
+
+extern int verbose;
+
+void runProfile(void*);
+int appendQuoted(char*, size_t, char*, char*);
+
+/**
+ * @brief	append a value in single quotes to a command line of the shell
+ *
+ * A single quote within the value is written as '\''.
+ *
+ * @param[in,out]	line	command line
+ * @param[in]	size	size of the line
+ * @param[in]	prefix	text in front of the value (e.g. " rc:")
+ * @param[in]	value	value to quote
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the quoted value doesn't fit, the line is unchanged
+ */
+int appendQuoted(char *line, size_t size, char *prefix, char *value)
+{
+	size_t start = strnlen(line, size);
+	size_t length = start;
+	int written = snprintf(line + length, size - length, "%s'", prefix);
+
+	if(written < 0 || (size_t)written >= size - length)
+		goto quote_overflow;
+	length += (size_t)written;
+	for(char *letter = value ; *letter != '\0' ; letter++) {
+		if(length + 4 >= size)
+			goto quote_overflow;
+		if(*letter == '\'') {
+			memcpy(line + length, "'\\''", 4);
+			length += 4;
+		} else {
+			line[length++] = *letter;
+		}
+	}
+	if(length + 1 >= size)
+		goto quote_overflow;
+	line[length++] = '\'';
+	line[length] = '\0';
+	return 0;
+
+	quote_overflow:
+		line[start] = '\0';
+		return -1;
+}
+
+/**
+ * @brief	prepare the switch of every profile that needs it
+ *
+ * @param[in]	config	parsed config
+ * @param[in]	context	context of the active zone
+ * @param[in]	own	1 to switch the default taskrc of the user as well
+ * @param[out]	action	array of length MAX_PROFILES+1
+ *
+ * @retval	number of prepared switches
+ */
+int profileActions(struct config *config, char *context, int own,
+		struct profile_action *action)
+{
+	char taskrc[PATH_MAX] = {0};
+	char current[MAX_FIELD] = {0};
+	int amount = 0;
+
+	if(own) {
+		memset(&action[amount], 0, sizeof(struct profile_action));
+		snprintf(action[amount].name, MAX_OPTION, "default");
+		if(dataLocation(action[amount].directory) != 0)
+			action[amount].directory[0] = '\0';
+		amount++;
+	}
+	for(int i = 0 ; i < config->profile_amount ; i++) {
+		if(expandHome(config->profile[i], taskrc) != 0)
+			continue;
+		current[0] = '\0';
+		if(taskrcValue(taskrc, "context", current, MAX_FIELD) != -1) {
+			if(current[0] == '\0')
+				snprintf(current, MAX_FIELD, "none");
+			if(strncmp(current, context, MAX_COMMAND) == 0)
+				continue;
+		}
+		memset(&action[amount], 0, sizeof(struct profile_action));
+		snprintf(action[amount].name, MAX_OPTION, "%s", config->profile[i]);
+		if(profileLocation(taskrc, action[amount].directory) != 0)
+			action[amount].directory[0] = '\0';
+		/* the paths go through the shell of popen */
+		if(appendQuoted(action[amount].rc, sizeof(action[amount].rc), " rc:",
+					taskrc) != 0 || (action[amount].directory[0] != '\0' &&
+					appendQuoted(action[amount].rc, sizeof(action[amount].rc),
+						" rc.data.location=", action[amount].directory) != 0)) {
+			fprintf(stderr, "WARNING: path of the profile %s too long\n",
+					config->profile[i]);
+			continue;
+		}
+		amount++;
+	}
+	for(int i = 0 ; i < amount ; i++) {
+		snprintf(action[i].context, MAX_COMMAND, "%s", context);
+		action[i].cancel = config->cancel;
+		action[i].result = SEND_FAILURE;
+		action[i].amount = -1;
+	}
+	return amount;
+}
+
+/**
+ * @brief	switch one profile and stop its active tasks (job of the pool)
+ *
+ * A staged switch only stops the active tasks found by the stage.
+ *
+ * @param[in,out]	arg	struct profile_action of the profile
+ */
+void runProfile(void *arg)
+{
+	struct profile_action *action = arg;
+	struct timespec start = {0};
+	struct timespec end = {0};
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(action->staged)
+		action->result = SEND_SUCCESS;
+	else
+		action->result = sendContext(action->rc, action->context, action->reaction);
+	if(action->result == SEND_SUCCESS && action->cancel) {
+		if(action->amount > 0)
+			action->stopped = stopTasks(action->rc, action->uuid, action->amount);
+		else if(action->amount == -1)
+			action->stopped = stopProfile(action->rc, action->directory);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	action->elapsed = (end.tv_sec - start.tv_sec) * 1000000000L +
+		(end.tv_nsec - start.tv_nsec);
+}
+
+/**
+ * @brief	run the switches of all profiles concurrently
+ *
+ * A single switch runs on the calling thread.
+ *
+ * @param[in,out]	action	prepared switches, the results are filled in
+ * @param[in]	amount	number of switches
+ *
+ * @retval	number of failed switches or stops
+ */
+int fanOut(struct profile_action *action, int amount)
+{
+	struct pool pool = {0};
+	int failed = 0;
+
+	if(amount > 1 && poolCreate(&pool, amount, 0) == 0) {
+		for(int i = 0 ; i < amount ; i++) {
+			if(poolSubmit(&pool, runProfile, &action[i]) != 0)
+				runProfile(&action[i]);
+		}
+		poolWait(&pool);
+		poolStop(&pool);
+	} else {
+		for(int i = 0 ; i < amount ; i++)
+			runProfile(&action[i]);
+	}
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(action[i].result != SEND_SUCCESS || action[i].stopped != 0)
+			failed++;
+		if(verbose)
+			printf("profile %s: %s to %s in %.1f ms%s\n", action[i].name,
+					action[i].staged ? "staged" :
+				action[i].result == SEND_SUCCESS ? "switched" : "failed",
+					action[i].context, action[i].elapsed / 1000000.0,
+					action[i].stopped != 0 ? ", stop failed" : "");
+	}
+	return failed;
+}
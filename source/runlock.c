@@ -0,0 +1,76 @@
+/**
+ * @file runlock.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	keep the runs of a user from overlapping
+ *
+ * A slow taskwarrior can stretch a run beyond the cron interval, the next
+ * tick would switch the same context and stop the same tasks again. Every
+ * run holds a flock on config.lock next to the config of the user (shared
+ * by the crontab of the user, csw -a and the daemons). A tick that finds
+ * the lock taken is skipped, the run in progress already evaluates the
+ * same schedule. The skip is counted in the status segment. A run with a
+ * request from the command line waits for the lock instead, the request
+ * must not get lost.
+ */
+
+#define _DEFAULT_SOURCE
+#include <sys/file.h>
+#include "include/runlock.h"
+
+/**
+ * @brief	locate the run lock of a user
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	path of the config of the user
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int lockPath(char *path, char *config_path)
+{
+	if(config_path == NULL || config_path[0] == '\0')
+		return -1;
+
+	snprintf(path, PATH_MAX, "%.*s.lock", PATH_MAX-6, config_path);
+	return 0;
+}
+
+/**
+ * @brief	take the run lock of a user
+ *
+ * @param[in]	config_path	path of the config of the user
+ * @param[in]	wait	1 to wait for a run in progress, 0 to give up
+ * @param[out]	fd	descriptor holding the lock, -1 without a lock
+ *
+ * @retval	RUN_LOCKED	the lock is held, release it with unlockRun
+ * @retval	RUN_BUSY	another run holds the lock
+ * @retval	RUN_UNLOCKED	the lock file is unavailable, run without it
+ */
+RUN_LOCK lockRun(char *config_path, int wait, int *fd)
+{
+	char path[PATH_MAX] = {0};
+
+	*fd = -1;
+	if(lockPath(path, config_path) != 0)
+		return RUN_UNLOCKED;
+	if((*fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600)) == -1)
+		return RUN_UNLOCKED;
+
+	while(flock(*fd, wait ? LOCK_EX : LOCK_EX | LOCK_NB) != 0) {
+		if(errno == EINTR)
+			continue;
+		close(*fd);
+		*fd = -1;
+		return errno == EWOULDBLOCK ? RUN_BUSY : RUN_UNLOCKED;
+	}
+	return RUN_LOCKED;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void unlockRun(int fd)
+{
+	if(fd != -1)
+		close(fd);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -0,0 +1,579 @@
+/**
+ * @file scan.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	batched identity checks and reads of the files of many users
+ *
+ * The multi-user mode needs the identity of the config and the taskrc of
+ * every user and the content of the files that changed since the last
+ * scan. On network file systems every stat, open and read is a round trip
+ * to the server, one after the other. The scan submits the statx calls of
+ * all users in one io_uring submission, then the opens and the reads of
+ * the changed files, so a scan costs three round trips regardless of the
+ * number of users. Kernels without io_uring (or with io_uring disabled,
+ * or without the statx, openat and read operations) get the same result
+ * from plain system calls.
+ *
+ * The files belong to the users while the scan runs as root: only regular
+ * files are read and they are opened without blocking, a FIFO or a device
+ * in place of a config never stalls the scan of the other users.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <linux/io_uring.h>
+#include "include/scan.h"
+
+int openRing(struct ring*, unsigned);
+void closeRing(struct ring*);
+struct io_uring_sqe* nextEntry(struct ring*);
+int reapRing(struct ring*, int*);
+int drainRing(struct ring*, int*, unsigned);
+int completeRing(struct ring*, int*, unsigned);
+int scanRing(struct ring*, struct scan_file**, int);
+int compareFile(struct scan_file*, struct file_key*, int);
+void storeFile(struct scan_file*, struct file_key*, int, char*, size_t);
+int readFile(char*, size_t, char**, size_t*);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void statxKey(struct statx *stx, struct file_key *key)
+{
+	memset(key, 0, sizeof(struct file_key));
+	key->device = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+	key->inode = stx->stx_ino;
+	key->size = stx->stx_size;
+	key->mtime = stx->stx_mtime.tv_sec;
+	key->mtime_nsec = stx->stx_mtime.tv_nsec;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	set up an io_uring instance and map its queues
+ *
+ * @param[out]	ring	io_uring instance
+ * @param[in]	entries	size of the submission queue
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	io_uring is not available
+ */
+int openRing(struct ring *ring, unsigned entries)
+{
+	struct io_uring_params params;
+	char *sq = NULL;
+	char *cq = NULL;
+
+	memset(ring, 0, sizeof(struct ring));
+	memset(&params, 0, sizeof(struct io_uring_params));
+	ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+	if(ring->fd == -1)
+		return -1;
+
+	ring->entries = params.sq_entries;
+	ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cq_size = params.cq_off.cqes +
+		params.cq_entries * sizeof(struct io_uring_cqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP) {
+		if(ring->cq_size > ring->sq_size)
+			ring->sq_size = ring->cq_size;
+		ring->cq_size = ring->sq_size;
+	}
+
+	ring->sq_map = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if(ring->sq_map == MAP_FAILED)
+		goto ring_error;
+	ring->cq_map = ring->sq_map;
+	if(!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+		ring->cq_map = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if(ring->cq_map == MAP_FAILED)
+			goto ring_error;
+	}
+	ring->sqe_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqe = mmap(NULL, ring->sqe_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if(ring->sqe == MAP_FAILED)
+		goto ring_error;
+
+	sq = ring->sq_map;
+	cq = ring->cq_map;
+	ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+	ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+	ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+	ring->cqe = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+	return 0;
+
+	ring_error:
+		if(ring->sqe == MAP_FAILED)
+			ring->sqe = NULL;
+		if(ring->cq_map == MAP_FAILED)
+			ring->cq_map = NULL;
+		if(ring->sq_map == MAP_FAILED)
+			ring->sq_map = NULL;
+		closeRing(ring);
+		return -1;
+}
+
+/**
+ * @brief	unmap the queues and close the io_uring instance
+ *
+ * @param[in,out]	ring	io_uring instance
+ */
+void closeRing(struct ring *ring)
+{
+	if(ring->sqe != NULL)
+		munmap(ring->sqe, ring->sqe_size);
+	if(ring->cq_map != NULL && ring->cq_map != ring->sq_map)
+		munmap(ring->cq_map, ring->cq_size);
+	if(ring->sq_map != NULL)
+		munmap(ring->sq_map, ring->sq_size);
+	if(ring->fd != -1)
+		close(ring->fd);
+	memset(ring, 0, sizeof(struct ring));
+	ring->fd = -1;
+}
+
+/**
+ * @brief	reserve the next entry of the submission queue
+ *
+ * @param[in,out]	ring	io_uring instance
+ *
+ * @retval	cleared entry
+ * @retval	NULL	the submission queue is full
+ */
+struct io_uring_sqe* nextEntry(struct ring *ring)
+{
+	struct io_uring_sqe *sqe = NULL;
+	unsigned tail = *ring->sq_tail;
+	unsigned index = 0;
+
+	if(tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->entries)
+		return NULL;
+
+	index = tail & *ring->sq_mask;
+	sqe = &ring->sqe[index];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	return sqe;
+}
+
+/**
+ * @brief	consume the available completions
+ *
+ * @param[in,out]	ring	io_uring instance
+ * @param[out]	result	result of every entry, indexed by its user_data
+ *
+ * @retval	number of consumed completions
+ */
+int reapRing(struct ring *ring, int *result)
+{
+	struct io_uring_cqe *cqe = NULL;
+	unsigned head = *ring->cq_head;
+	int reaped = 0;
+
+	while(head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+		cqe = &ring->cqe[head & *ring->cq_mask];
+		result[cqe->user_data] = cqe->res;
+		head++;
+		reaped++;
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	return reaped;
+}
+
+/**
+ * @brief	wait for the entries that are submitted but not completed
+ *
+ * The kernel writes into the buffers of these entries, they can only be
+ * released once the entries completed.
+ *
+ * @param[in,out]	ring	io_uring instance
+ * @param[out]	result	result of every entry, indexed by its user_data
+ * @param[in]	inflight	number of submitted entries without completion
+ *
+ * @retval	0	SUCCESS, no entry is in flight
+ * @retval	-1	entries may still be in flight
+ */
+int drainRing(struct ring *ring, int *result, unsigned inflight)
+{
+	int failures = 0;
+
+	while(inflight > 0) {
+		if(syscall(__NR_io_uring_enter, ring->fd, 0, inflight,
+					IORING_ENTER_GETEVENTS, NULL, 0) == -1 &&
+				errno != EINTR && ++failures > SCAN_DRAIN_RETRIES)
+			return -1;
+		inflight -= (unsigned)reapRing(ring, result);
+	}
+	return 0;
+}
+
+/**
+ * @brief	submit the queued entries and wait for all of their completions
+ *
+ * Entries that were not submitted when io_uring_enter fails are dropped
+ * with the ring, the submitted ones are drained.
+ *
+ * @param[in,out]	ring	io_uring instance
+ * @param[out]	result	result of every entry, indexed by its user_data
+ * @param[in]	pending	number of queued entries
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	io_uring_enter failed, no entry is in flight
+ * @retval	-2	io_uring_enter failed, entries may still be in flight
+ */
+int completeRing(struct ring *ring, int *result, unsigned pending)
+{
+	unsigned submit = pending;
+	int submitted = 0;
+
+	while(pending > 0) {
+		submitted = syscall(__NR_io_uring_enter, ring->fd, submit, pending,
+				IORING_ENTER_GETEVENTS, NULL, 0);
+		if(submitted == -1) {
+			if(errno == EINTR)
+				continue;
+			return drainRing(ring, result, pending - submit) == 0 ? -1 : -2;
+		}
+		submit -= (unsigned)submitted;
+		pending -= (unsigned)reapRing(ring, result);
+	}
+	return 0;
+}
+
+/**
+ * @brief	decide what the scan has to do with a file after the stat
+ *
+ * @param[in]	file	file with the identity of the last scan
+ * @param[in]	key	current identity of the file
+ * @param[in]	found	result of the stat (0 found, 1 missing, -1 failed)
+ *
+ * @retval	SCAN_CHANGED	identity changed (content has to be read if
+ * 				file->read is set)
+ * @retval	SCAN_UNCHANGED	data of the last scan is still valid
+ * @retval	SCAN_MISSING	file doesn't exist
+ * @retval	SCAN_FAILED	stat failed
+ */
+int compareFile(struct scan_file *file, struct file_key *key, int found)
+{
+	if(found == 1)
+		return SCAN_MISSING;
+	if(found == -1)
+		return SCAN_FAILED;
+	if(sameKey(&file->key, key) && (!file->read || file->data != NULL))
+		return SCAN_UNCHANGED;
+	return SCAN_CHANGED;
+}
+
+/**
+ * @brief	replace the identity and the content of a file after a scan
+ *
+ * @param[in,out]	file	scanned file
+ * @param[in]	key	current identity of the file
+ * @param[in]	state	SCAN_STATE of the scan
+ * @param[in]	data	new content on the heap (NULL if not read)
+ * @param[in]	size	number of bytes in data
+ */
+void storeFile(struct scan_file *file, struct file_key *key, int state,
+		char *data, size_t size)
+{
+	file->state = state;
+	if(state == SCAN_UNCHANGED)
+		return;
+
+	free(file->data);
+	file->data = data;
+	file->size = data != NULL ? size : 0;
+	if(state == SCAN_CHANGED)
+		file->key = *key;
+	else
+		memset(&file->key, 0, sizeof(struct file_key));
+}
+
+/**
+ * @brief	read a whole regular file into a NUL terminated buffer
+ *
+ * @param[in]	path	location of the file
+ * @param[in]	size	size of the file from the stat
+ * @param[out]	data	content on the heap
+ * @param[out]	length	number of bytes read
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE or not a regular file
+ */
+int readFile(char *path, size_t size, char **data, size_t *length)
+{
+	ssize_t amount = 0;
+	struct stat s;
+	int fd = open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+
+	if(fd == -1)
+		return -1;
+	if(fstat(fd, &s) != 0 || !S_ISREG(s.st_mode) ||
+			(*data = malloc(size + 1)) == NULL) {
+		close(fd);
+		return -1;
+	}
+	amount = read(fd, *data, size);
+	close(fd);
+	if(amount == -1) {
+		free(*data);
+		*data = NULL;
+		return -1;
+	}
+	(*data)[amount] = '\0';
+	*length = (size_t)amount;
+	return 0;
+}
+
+/**
+ * @brief	scan the files with one system call per operation and file
+ *
+ * @param[in,out]	file	files to scan
+ * @param[in]	amount	number of files
+ *
+ * @retval	number of changed files
+ */
+int scanSync(struct scan_file **file, int amount)
+{
+	struct file_key key;
+	char *data = NULL;
+	size_t size = 0;
+	int changed = 0;
+	int state = 0;
+
+	for(int i = 0 ; i < amount ; i++) {
+		data = NULL;
+		size = 0;
+		state = compareFile(file[i], &key, fileKey(file[i]->path, &key));
+		if(state == SCAN_CHANGED && file[i]->read &&
+				readFile(file[i]->path, key.size, &data, &size) != 0)
+			state = SCAN_FAILED;
+		if(state == SCAN_CHANGED)
+			changed++;
+		storeFile(file[i], &key, state, data, size);
+	}
+	return changed;
+}
+
+/**
+ * @brief	scan the files with one io_uring submission per operation
+ *
+ * The statx calls of all files go out first, the opens and reads only for
+ * the changed regular files. Nothing is stored on failure or if the kernel
+ * doesn't know an operation (-EINVAL), the caller can repeat the scan
+ * synchronously.
+ *
+ * @param[in,out]	ring	io_uring instance
+ * @param[in,out]	file	files to scan
+ * @param[in]	amount	number of files
+ *
+ * @retval	number of changed files
+ * @retval	-1	FAILURE
+ */
+int scanRing(struct ring *ring, struct scan_file **file, int amount)
+{
+	struct io_uring_sqe *sqe = NULL;
+	struct statx *stx = calloc(amount, sizeof(struct statx));
+	struct file_key *key = calloc(amount, sizeof(struct file_key));
+	size_t *size = calloc(amount, sizeof(size_t));
+	char **data = calloc(amount, sizeof(char*));
+	int *state = calloc(amount, sizeof(int));
+	int *result = calloc(amount, sizeof(int));
+	int *fd = calloc(amount, sizeof(int));
+	unsigned queued = 0;
+	int changed = -1;
+	int found = 0;
+	int busy = 0;
+
+	if(stx == NULL || key == NULL || size == NULL || data == NULL ||
+			state == NULL || result == NULL || fd == NULL)
+		goto scan_done;
+	for(int i = 0 ; i < amount ; i++)
+		fd[i] = -1;
+
+	/* round trip 1: identity of every file */
+	for(int i = 0 ; i < amount ; i++) {
+		if((sqe = nextEntry(ring)) == NULL) {
+			if((busy = completeRing(ring, result, queued)) != 0)
+				goto scan_done;
+			queued = 0;
+			sqe = nextEntry(ring);
+		}
+		sqe->opcode = IORING_OP_STATX;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (uint64_t)(uintptr_t)file[i]->path;
+		sqe->len = STATX_BASIC_STATS;
+		sqe->off = (uint64_t)(uintptr_t)&stx[i];
+		sqe->user_data = i;
+		queued++;
+	}
+	if((busy = completeRing(ring, result, queued)) != 0)
+		goto scan_done;
+	queued = 0;
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(result[i] == -EINVAL)
+			goto scan_done;
+		found = result[i] == 0 ? 0 : result[i] == -ENOENT ? 1 : -1;
+		if(found == 0)
+			statxKey(&stx[i], &key[i]);
+		state[i] = compareFile(file[i], &key[i], found);
+		if(state[i] == SCAN_CHANGED && file[i]->read && !S_ISREG(stx[i].stx_mode))
+			state[i] = SCAN_FAILED;
+	}
+
+	/* round trip 2: open the changed files that have to be read */
+	for(int i = 0 ; i < amount ; i++) {
+		result[i] = -1;
+		if(state[i] != SCAN_CHANGED || !file[i]->read)
+			continue;
+		if((sqe = nextEntry(ring)) == NULL) {
+			if((busy = completeRing(ring, result, queued)) != 0)
+				goto scan_done;
+			queued = 0;
+			sqe = nextEntry(ring);
+		}
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (uint64_t)(uintptr_t)file[i]->path;
+		sqe->open_flags = O_RDONLY | O_CLOEXEC | O_NONBLOCK;
+		sqe->user_data = i;
+		queued++;
+	}
+	if((busy = completeRing(ring, result, queued)) != 0)
+		goto scan_done;
+	queued = 0;
+
+	/* round trip 3: read the opened files */
+	for(int i = 0 ; i < amount ; i++) {
+		if(state[i] != SCAN_CHANGED || !file[i]->read)
+			continue;
+		fd[i] = result[i];
+		if(fd[i] == -EINVAL)
+			goto scan_done;
+		if(fd[i] < 0 || (data[i] = malloc(key[i].size + 1)) == NULL) {
+			state[i] = SCAN_FAILED;
+			continue;
+		}
+		if((sqe = nextEntry(ring)) == NULL) {
+			if((busy = completeRing(ring, result, queued)) != 0)
+				goto scan_done;
+			queued = 0;
+			sqe = nextEntry(ring);
+		}
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = fd[i];
+		sqe->addr = (uint64_t)(uintptr_t)data[i];
+		sqe->len = (unsigned)key[i].size;
+		sqe->user_data = i;
+		queued++;
+	}
+	if((busy = completeRing(ring, result, queued)) != 0)
+		goto scan_done;
+
+	for(int i = 0 ; i < amount ; i++) {
+		if(data[i] != NULL && result[i] == -EINVAL)
+			goto scan_done;
+	}
+
+	changed = 0;
+	for(int i = 0 ; i < amount ; i++) {
+		if(data[i] != NULL) {
+			if(result[i] < 0) {
+				free(data[i]);
+				data[i] = NULL;
+				state[i] = SCAN_FAILED;
+			} else {
+				data[i][result[i]] = '\0';
+				size[i] = (size_t)result[i];
+			}
+		}
+		if(state[i] == SCAN_CHANGED)
+			changed++;
+		storeFile(file[i], &key[i], state[i], data[i], size[i]);
+		data[i] = NULL;
+	}
+
+	scan_done:
+		/* the kernel may still write into stx and data, they are leaked */
+		if(busy == -2)
+			stx = NULL;
+		for(int i = 0 ; fd != NULL && i < amount ; i++) {
+			if(fd[i] >= 0)
+				close(fd[i]);
+			if(data != NULL && busy != -2)
+				free(data[i]);
+		}
+		if(busy == -2)
+			data = NULL;
+		free(stx);
+		free(key);
+		free(size);
+		free(data);
+		free(state);
+		free(result);
+		free(fd);
+		return changed;
+}
+
+/**
+ * @brief	update the identity and the changed content of many files
+ *
+ * @param[in,out]	file	files to scan
+ * @param[in]	amount	number of files
+ *
+ * @retval	number of changed files
+ */
+int scanFiles(struct scan_file **file, int amount)
+{
+	struct ring ring;
+	int changed = -1;
+
+	if(amount <= 0)
+		return 0;
+
+	if(openRing(&ring, SCAN_RING) == 0) {
+		changed = scanRing(&ring, file, amount);
+		closeRing(&ring);
+	}
+	if(changed == -1)
+		changed = scanSync(file, amount);
+	return changed;
+}
+
+/**
+ * @brief	prepare a file for the scan
+ *
+ * @param[out]	file	file to prepare
+ * @param[in]	path	location of the file
+ * @param[in]	read	1 if the content is required
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int setFile(struct scan_file *file, char *path, int read)
+{
+	memset(file, 0, sizeof(struct scan_file));
+	file->read = read;
+	file->path = strdup(path);
+	return file->path != NULL ? 0 : -1;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void releaseFile(struct scan_file *file)
+{
+	free(file->path);
+	free(file->data);
+	memset(file, 0, sizeof(struct scan_file));
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -0,0 +1,210 @@
+/**
+ * @file share.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	timelines shared between users with the same schedule
+ *
+ * Most users run one of a few team schedules. A multi-user process keys
+ * the timelines by the hash of the normalized schedule (scheduleHash:
+ * zones, exclusions and time zone, after parsing), so two configs that
+ * only differ in comments, order or context names share one timeline.
+ * The hash only selects the candidates, a schedule is shared once its
+ * zones, exclusions and time zone equal the ones of the config.
+ * A timeline is built once per distinct schedule and released with the
+ * last user that references it.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/share.h"
+
+int refreshSchedule(struct schedule_table*, struct shared_schedule*, time_t);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void initSchedules(struct schedule_table *table)
+{
+	table->first = NULL;
+	table->amount = 0;
+	table->builds = 0;
+	pthread_mutex_init(&table->lock, NULL);
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	release every schedule of the table
+ *
+ * @param[in,out]	table	distinct schedules
+ */
+void freeSchedules(struct schedule_table *table)
+{
+	struct shared_schedule *schedule = table->first;
+	struct shared_schedule *next = NULL;
+
+	while(schedule != NULL) {
+		next = schedule->next;
+		closeTimeline(&schedule->timeline);
+		free(schedule);
+		schedule = next;
+	}
+	table->first = NULL;
+	table->amount = 0;
+	pthread_mutex_destroy(&table->lock);
+}
+
+/**
+ * @brief	rebuild the timeline once the horizon is too close
+ *
+ * Called with the lock of the table held.
+ *
+ * @param[in,out]	table	distinct schedules
+ * @param[in,out]	schedule	shared schedule
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int refreshSchedule(struct schedule_table *table, struct shared_schedule *schedule,
+		time_t rawtime)
+{
+	if(validTimeline(&schedule->timeline, schedule->hash, (int)(rawtime / 60)))
+		return 0;
+
+	closeTimeline(&schedule->timeline);
+	if(memoryTimeline(&schedule->timeline, &schedule->config, rawtime) != 0)
+		return -1;
+	table->builds++;
+	return 0;
+}
+
+/**
+ * @brief	take a reference to the schedule of a config
+ *
+ * @param[in,out]	table	distinct schedules
+ * @param[in]	config	parsed config of the user
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	shared schedule
+ * @retval	NULL	FAILURE
+ */
+struct shared_schedule* acquireSchedule(struct schedule_table *table,
+		struct config *config, time_t rawtime)
+{
+	struct shared_schedule *schedule = NULL;
+	unsigned int hash = scheduleHash(config);
+	char tz[PATH_MAX] = {0};
+
+	zoneIdentity(tz);
+	pthread_mutex_lock(&table->lock);
+	for(schedule = table->first ; schedule != NULL ; schedule = schedule->next) {
+		if(schedule->hash == hash && strncmp(schedule->tz, tz, PATH_MAX) == 0 &&
+				sameSchedule(&schedule->config, config))
+			break;
+	}
+	if(schedule == NULL) {
+		schedule = calloc(1, sizeof(struct shared_schedule));
+		if(schedule == NULL)
+			goto acquire_done;
+		schedule->hash = hash;
+		snprintf(schedule->tz, PATH_MAX, "%s", tz);
+		schedule->config = *config;
+		if(refreshSchedule(table, schedule, rawtime) != 0) {
+			free(schedule);
+			schedule = NULL;
+			goto acquire_done;
+		}
+		schedule->next = table->first;
+		table->first = schedule;
+		table->amount++;
+	}
+	schedule->references++;
+
+	acquire_done:
+		pthread_mutex_unlock(&table->lock);
+		return schedule;
+}
+
+/**
+ * @brief	drop a reference, the last one releases the timeline
+ *
+ * @param[in,out]	table	distinct schedules
+ * @param[in]	schedule	shared schedule (NULL is ignored)
+ */
+void releaseSchedule(struct schedule_table *table, struct shared_schedule *schedule)
+{
+	struct shared_schedule **link = NULL;
+
+	if(schedule == NULL)
+		return;
+
+	pthread_mutex_lock(&table->lock);
+	if(--schedule->references == 0) {
+		for(link = &table->first ; *link != NULL ; link = &(*link)->next) {
+			if(*link == schedule) {
+				*link = schedule->next;
+				break;
+			}
+		}
+		table->amount--;
+		closeTimeline(&schedule->timeline);
+		free(schedule);
+	}
+	pthread_mutex_unlock(&table->lock);
+}
+
+/**
+ * @brief	zone of a shared schedule at a point in time
+ *
+ * Every lookup works on its own cursor, the users of a schedule are
+ * evaluated in parallel.
+ *
+ * @param[in,out]	table	distinct schedules
+ * @param[in,out]	schedule	shared schedule
+ * @param[in]	rawtime	point in time
+ * @param[out]	zone	index of the active zone, -1 for no zone
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the timeline couldn't be rebuilt
+ */
+int scheduleZone(struct schedule_table *table, struct shared_schedule *schedule,
+		time_t rawtime, int *zone)
+{
+	struct timeline view;
+	int result = 0;
+
+	pthread_mutex_lock(&table->lock);
+	if((result = refreshSchedule(table, schedule, rawtime)) == 0) {
+		view = schedule->timeline;
+		*zone = lookupTimeline(&view, (int)(rawtime / 60));
+	}
+	pthread_mutex_unlock(&table->lock);
+	return result;
+}
+
+/**
+ * @brief	minute of the next transition of a shared schedule
+ *
+ * @param[in,out]	table	distinct schedules
+ * @param[in,out]	schedule	shared schedule
+ * @param[in]	rawtime	point in time
+ *
+ * @retval	minute since the epoch of the next transition, or of the next
+ * 			rebuild if no transition is left on the horizon
+ * @retval	-1	FAILURE
+ */
+int scheduleNext(struct schedule_table *table, struct shared_schedule *schedule,
+		time_t rawtime)
+{
+	struct transition *next = NULL;
+	struct timeline view;
+	int minute = -1;
+
+	pthread_mutex_lock(&table->lock);
+	if(refreshSchedule(table, schedule, rawtime) == 0) {
+		view = schedule->timeline;
+		if((next = nextTransition(&view, (int)(rawtime / 60))) != NULL)
+			minute = next->minute;
+		else
+			minute = view.header->end - TIMELINE_REFRESH*24*60;
+	}
+	pthread_mutex_unlock(&table->lock);
+	return minute;
+}
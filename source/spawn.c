@@ -0,0 +1,237 @@
+/**
+ * @file spawn.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	spawn server (zygote) for the runs of a multi-user process
+ *
+ * A multi-user process grows with the number of users (jobs, scanned
+ * files, shared timelines). Every fork copies its page tables, so the
+ * cost of a run would grow with the resident set. The spawn server is
+ * forked once, while the process is still small, and forks the runs of
+ * the users on request. The runs call task and crontab from there and
+ * inherit stdout and stderr of the process, the exit status is sent back
+ * over the socket pair of the request.
+ */
+
+#define _DEFAULT_SOURCE
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
+#include "include/spawn.h"
+
+extern int verbose;
+
+void runSpawner(int*, int, int (*)(struct spawn_request*));
+void reapChildren(int*, pid_t*, int);
+
+/**
+ * @brief	fork the spawn server
+ *
+ * Has to be called before the process starts threads or grows.
+ *
+ * @param[out]	spawner	connection to the spawn server
+ * @param[in]	run	function executed by the child of every request
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE, runs have to be forked directly
+ */
+int startSpawner(struct spawner *spawner, int (*run)(struct spawn_request*))
+{
+	int pair[SPAWN_CHANNELS][2];
+	int server[SPAWN_CHANNELS];
+	int created = 0;
+
+	memset(spawner, 0, sizeof(struct spawner));
+	spawner->pid = -1;
+	for(created = 0 ; created < SPAWN_CHANNELS ; created++) {
+		if(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair[created]) != 0)
+			goto spawner_error;
+		spawner->channel[created] = pair[created][0];
+		server[created] = pair[created][1];
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	spawner->pid = fork();
+	if(spawner->pid == -1)
+		goto spawner_error;
+	if(spawner->pid == 0) {
+		for(int i = 0 ; i < SPAWN_CHANNELS ; i++)
+			close(spawner->channel[i]);
+		runSpawner(server, SPAWN_CHANNELS, run);
+		_exit(EXIT_SUCCESS);
+	}
+
+	for(int i = 0 ; i < SPAWN_CHANNELS ; i++)
+		close(server[i]);
+	pthread_mutex_init(&spawner->lock, NULL);
+	pthread_cond_init(&spawner->idle, NULL);
+	return 0;
+
+	spawner_error:
+		for(int i = 0 ; i < created ; i++) {
+			close(pair[i][0]);
+			close(pair[i][1]);
+		}
+		spawner->pid = -1;
+		return -1;
+}
+
+/**
+ * @brief	answer every finished child on the channel of its request
+ *
+ * @param[in]	channel	server side of the socket pairs
+ * @param[in,out]	owner	pid of the pending child per channel
+ * @param[in]	amount	number of channels
+ */
+void reapChildren(int *channel, pid_t *owner, int amount)
+{
+	int status = 0;
+	pid_t pid = 0;
+
+	while((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+		for(int i = 0 ; i < amount ; i++) {
+			if(owner[i] != pid)
+				continue;
+			owner[i] = 0;
+			if(send(channel[i], &status, sizeof(int), MSG_NOSIGNAL) != sizeof(int))
+				perror("spawn server reply failed");
+		}
+	}
+}
+
+/**
+ * @brief	main loop of the spawn server
+ *
+ * Serves one request per channel at a time and exits once the process
+ * closed every channel and the last child finished.
+ *
+ * @param[in]	channel	server side of the socket pairs
+ * @param[in]	amount	number of channels
+ * @param[in]	run	function executed by the child of every request
+ */
+void runSpawner(int *channel, int amount, int (*run)(struct spawn_request*))
+{
+	struct pollfd ready[SPAWN_CHANNELS + 1];
+	struct signalfd_siginfo info;
+	struct spawn_request request;
+	pid_t owner[SPAWN_CHANNELS] = {0};
+	sigset_t mask;
+	sigset_t previous;
+	ssize_t length = 0;
+	int open_channels = amount;
+	int pending = 0;
+	int failed = -1;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &mask, &previous);
+	ready[amount].fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	ready[amount].events = POLLIN;
+	if(ready[amount].fd == -1)
+		return;
+	for(int i = 0 ; i < amount ; i++) {
+		ready[i].fd = channel[i];
+		ready[i].events = POLLIN;
+	}
+
+	while(open_channels > 0 || pending > 0) {
+		if(poll(ready, amount + 1, -1) == -1) {
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		if(ready[amount].revents & POLLIN) {
+			while(read(ready[amount].fd, &info, sizeof(info)) == sizeof(info));
+			reapChildren(channel, owner, amount);
+		}
+		for(int i = 0 ; i < amount ; i++) {
+			if(ready[i].fd == -1 || ready[i].revents == 0)
+				continue;
+			length = read(channel[i], &request, sizeof(request));
+			if(length <= 0) {
+				/* the process closed the channel */
+				ready[i].fd = -1;
+				open_channels--;
+				continue;
+			}
+			if(length != sizeof(request) || owner[i] != 0 ||
+					(owner[i] = fork()) == -1) {
+				owner[i] = 0;
+				if(send(channel[i], &failed, sizeof(int), MSG_NOSIGNAL) != sizeof(int))
+					perror("spawn server reply failed");
+				continue;
+			}
+			if(owner[i] == 0) {
+				sigprocmask(SIG_SETMASK, &previous, NULL);
+				close(ready[amount].fd);
+				for(int j = 0 ; j < amount ; j++)
+					close(channel[j]);
+				request.flag.verbose = &verbose;
+				_exit(run(&request));
+			}
+		}
+		pending = 0;
+		for(int i = 0 ; i < amount ; i++)
+			pending += owner[i] != 0;
+	}
+	close(ready[amount].fd);
+}
+
+/**
+ * @brief	run a request on the spawn server and wait for its end
+ *
+ * @param[in,out]	spawner	connection to the spawn server
+ * @param[in]	request	run to execute
+ * @param[out]	status	wait status of the run
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the spawn server failed
+ */
+int spawnRequest(struct spawner *spawner, struct spawn_request *request, int *status)
+{
+	int channel = 0;
+	int result = -1;
+
+	pthread_mutex_lock(&spawner->lock);
+	while(1) {
+		for(channel = 0 ; channel < SPAWN_CHANNELS && spawner->busy[channel] ;
+				channel++);
+		if(channel < SPAWN_CHANNELS)
+			break;
+		pthread_cond_wait(&spawner->idle, &spawner->lock);
+	}
+	spawner->busy[channel] = 1;
+	pthread_mutex_unlock(&spawner->lock);
+
+	if(send(spawner->channel[channel], request, sizeof(struct spawn_request),
+				MSG_NOSIGNAL) == (ssize_t)sizeof(struct spawn_request) &&
+			read(spawner->channel[channel], status, sizeof(int)) == sizeof(int) &&
+			*status != -1)
+		result = 0;
+
+	pthread_mutex_lock(&spawner->lock);
+	spawner->busy[channel] = 0;
+	pthread_cond_signal(&spawner->idle);
+	pthread_mutex_unlock(&spawner->lock);
+	return result;
+}
+
+/**
+ * @brief	close the channels and wait for the spawn server to exit
+ *
+ * @param[in,out]	spawner	connection to the spawn server
+ */
+void stopSpawner(struct spawner *spawner)
+{
+	if(spawner->pid == -1)
+		return;
+
+	for(int i = 0 ; i < SPAWN_CHANNELS ; i++)
+		close(spawner->channel[i]);
+	waitpid(spawner->pid, NULL, 0);
+	pthread_mutex_destroy(&spawner->lock);
+	pthread_cond_destroy(&spawner->idle);
+	spawner->pid = -1;
+}
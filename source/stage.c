@@ -0,0 +1,293 @@
+/**
+ * @file stage.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	prepare the next transition ahead of its boundary
+ *
+ * A switch at the boundary validated the context, called taskwarrior and
+ * looked for active tasks, all after the boundary. A run up to STAGE_LEAD
+ * minutes (at least one interval) before a transition stages it instead:
+ * the context of the next zone is validated against the taskrc, a copy of
+ * the taskrc with that context (the artifact) is written next to the
+ * taskrc and the active tasks are collected. The stage is stored next to
+ * the journal (the file "stage").
+ *
+ * At the boundary the artifact is renamed over the taskrc, a single
+ * rename instead of a call of taskwarrior. A taskrc changed since the copy
+ * (a context set by hand, an edit) invalidates the artifact, the switch is
+ * sent to taskwarrior as before. The taskrc is compared and replaced under
+ * an exclusive flock (see lockTaskrc), the other writers of csw never
+ * change it in between; taskwarrior and editors don't take the lock, an
+ * edit of theirs is only detected up to the comparison. The collected tasks are only used while
+ * the data files of taskwarrior are unchanged.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/stage.h"
+
+/**
+ * @brief	build the path of the stage next to the journal
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	location of the config
+ * @param[in]	persistent	1 if the state is kept next to the config
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no location for the stage
+ */
+int stagePath(char *path, char *config_path, int persistent)
+{
+	char *separator = NULL;
+
+	if(journalPath(path, config_path, persistent) != 0 ||
+			(separator = strrchr(path, '/')) == NULL)
+		return -1;
+	snprintf(separator + 1, PATH_MAX - (separator + 1 - path), "stage");
+	return 0;
+}
+
+/**
+ * @brief	read the stored stage
+ *
+ * @param[in]	path	location of the stage
+ * @param[out]	stage	stored stage, empty without a valid file
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	no stage or a stage of another version
+ */
+int loadStage(char *path, struct stage *stage)
+{
+	int fd = -1;
+	ssize_t length = 0;
+
+	memset(stage, 0, sizeof(struct stage));
+	if((fd = open(path, O_RDONLY | O_CLOEXEC)) == -1)
+		return 1;
+	length = read(fd, stage, sizeof(struct stage));
+	close(fd);
+	if(length != (ssize_t)sizeof(struct stage) || stage->version != STAGE_VERSION) {
+		memset(stage, 0, sizeof(struct stage));
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	replace the stored stage
+ *
+ * @param[in]	path	location of the stage
+ * @param[in]	stage	stage to store
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int storeStage(char *path, struct stage *stage)
+{
+	char tmp_name[PATH_MAX] = {0};
+	int fd = -1;
+
+	stage->version = STAGE_VERSION;
+	snprintf(tmp_name, PATH_MAX, "%.*s.XXXXXX", PATH_MAX-8, path);
+	if((fd = mkstemp(tmp_name)) == -1)
+		return -1;
+	if(write(fd, stage, sizeof(struct stage)) != (ssize_t)sizeof(struct stage)) {
+		close(fd);
+		unlink(tmp_name);
+		return -1;
+	}
+	close(fd);
+	if(rename(tmp_name, path) != 0) {
+		unlink(tmp_name);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	remove the artifact and the stored stage
+ *
+ * @param[in]	path	location of the stage
+ * @param[in,out]	stage	stage to drop, emptied
+ */
+void dropStage(char *path, struct stage *stage)
+{
+	if(stage->artifact[0] != '\0')
+		unlink(stage->artifact);
+	if(stage->version != 0)
+		unlink(path);
+	memset(stage, 0, sizeof(struct stage));
+}
+
+/**
+ * @brief	read the keys of the files that hold the tasks of taskwarrior
+ *
+ * pending.data of taskwarrior 2.x, the replica of taskwarrior 3 and its
+ * write-ahead log, all zero for a missing file.
+ *
+ * @param[in]	directory	data directory of taskwarrior
+ * @param[out]	key	array of length STAGE_FILES
+ */
+void dataKeys(char *directory, struct file_key *key)
+{
+	const char *name[STAGE_FILES] = {
+		"pending.data", "taskchampion.sqlite3", "taskchampion.sqlite3-wal"};
+	char path[PATH_MAX] = {0};
+
+	for(int i = 0 ; i < STAGE_FILES ; i++) {
+		snprintf(path, PATH_MAX, "%.*s/%s", PATH_MAX - 26, directory, name[i]);
+		fileKey(path, &key[i]);
+	}
+}
+
+/**
+ * @brief	validate the next context and write the artifact
+ *
+ * The key of the taskrc is taken before the taskrc is read, a taskrc
+ * changed while the copy is written never matches the stage.
+ *
+ * @param[out]	stage	prepared stage
+ * @param[in]	taskrc_path	location of the taskrc
+ * @param[in]	directory	data directory of taskwarrior (empty if unknown)
+ * @param[in]	context	context of the next zone
+ * @param[in]	at	unix timestamp of the boundary
+ * @param[in]	cancel	1 to collect the active tasks
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	the context is already set, nothing to stage
+ * @retval	-1	the taskrc is unreadable or doesn't define the context
+ */
+int prepareStage(struct stage *stage, char *taskrc_path, char *directory,
+		char *context, time_t at, int cancel)
+{
+	char current[MAX_FIELD] = {0};
+	char path[PATH_MAX] = {0};
+	size_t length = 0;
+	char *data = NULL;
+	int result = -1;
+
+	memset(stage, 0, sizeof(struct stage));
+	if(fileKey(taskrc_path, &stage->taskrc) != 0 ||
+			realpath(taskrc_path, path) == NULL ||
+			(data = readTaskrc(taskrc_path, &length)) == NULL)
+		return -1;
+
+	taskrcBuffer(data, length, "context", current, MAX_FIELD);
+	if(current[0] == '\0')
+		snprintf(current, MAX_FIELD, "none");
+	if(strncmp(current, context, MAX_COMMAND) == 0) {
+		result = 1;
+		goto prepare_done;
+	}
+	if(!contextDefined(data, length, context))
+		goto prepare_done;
+
+	snprintf(stage->artifact, PATH_MAX, "%.*s.stage", PATH_MAX - 7, path);
+	if(copyContext(taskrc_path, stage->artifact, NULL, data, length, context) != 0) {
+		stage->artifact[0] = '\0';
+		goto prepare_done;
+	}
+	stage->version = STAGE_VERSION;
+	snprintf(stage->context, MAX_COMMAND, "%s", context);
+	stage->at = (long)at;
+
+	stage->amount = -1;
+	if(cancel && directory[0] != '\0') {
+		dataKeys(directory, stage->data);
+		stage->amount = directoryActive(directory, stage->uuid, STOP_UUIDS);
+		if(stage->amount == STOP_UUIDS)
+			stage->amount = -1;
+	}
+	result = 0;
+
+	prepare_done:
+		free(data);
+		return result;
+}
+
+/**
+ * @brief	check if the stage still prepares the next transition
+ *
+ * @param[in]	stage	stored stage
+ * @param[in]	taskrc_path	location of the taskrc
+ * @param[in]	directory	data directory of taskwarrior (empty if unknown)
+ * @param[in]	context	context of the next zone
+ * @param[in]	at	unix timestamp of the boundary
+ *
+ * @retval	1	the stage is current
+ * @retval	0	the stage has to be prepared again
+ */
+int stageCurrent(struct stage *stage, char *taskrc_path, char *directory,
+		char *context, time_t at)
+{
+	struct file_key taskrc = {0};
+	struct file_key data[STAGE_FILES];
+
+	if(stage->version != STAGE_VERSION || stage->at != (long)at ||
+			strncmp(stage->context, context, MAX_COMMAND) != 0 ||
+			fileKey(taskrc_path, &taskrc) != 0 || !sameKey(&taskrc, &stage->taskrc) ||
+			access(stage->artifact, F_OK) != 0)
+		return 0;
+	if(stage->amount == -1 || directory[0] == '\0')
+		return 1;
+
+	dataKeys(directory, data);
+	for(int i = 0 ; i < STAGE_FILES ; i++) {
+		if(!sameKey(&data[i], &stage->data[i]))
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief	apply the context by renaming the artifact over the taskrc
+ *
+ * @param[in,out]	stage	stored stage, the artifact is used up
+ * @param[in]	taskrc_path	location of the taskrc
+ * @param[in]	context	context of the active zone
+ *
+ * @retval	0	the context is set
+ * @retval	-1	no matching stage, the context has to be sent
+ */
+int commitStage(struct stage *stage, char *taskrc_path, char *context)
+{
+	char path[PATH_MAX] = {0};
+	int lock = -1;
+	int result = -1;
+
+	if(stage->version != STAGE_VERSION || stage->artifact[0] == '\0' ||
+			strncmp(stage->context, context, MAX_COMMAND) != 0 ||
+			realpath(taskrc_path, path) == NULL)
+		return -1;
+	/* the taskrc is compared and replaced under its lock */
+	if((lock = lockTaskrc(path, &stage->taskrc)) == -1)
+		return -1;
+	if(rename(stage->artifact, path) == 0) {
+		stage->artifact[0] = '\0';
+		result = 0;
+	}
+	close(lock);
+	return result;
+}
+
+/**
+ * @brief	hand the active tasks of the stage to the switch of the taskrc
+ *
+ * @param[in]	stage	committed stage
+ * @param[in]	directory	data directory of taskwarrior (empty if unknown)
+ * @param[out]	action	switch of the default taskrc
+ */
+void stagedTasks(struct stage *stage, char *directory, struct profile_action *action)
+{
+	struct file_key data[STAGE_FILES];
+
+	action->amount = -1;
+	if(stage->amount == -1 || directory[0] == '\0')
+		return;
+	dataKeys(directory, data);
+	for(int i = 0 ; i < STAGE_FILES ; i++) {
+		if(!sameKey(&data[i], &stage->data[i]))
+			return;
+	}
+	action->amount = stage->amount;
+	memcpy(action->uuid, stage->uuid, sizeof(stage->uuid));
+}
@@ -0,0 +1,296 @@
+/**
+ * @file status.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	publish the scheduler state in a shared memory segment
+ *
+ * The segment /dev/shm/csw-$USER contains a single status record.
+ * Updates are guarded by a sequence lock, so readers never block the
+ * writer and never copy a half written record. After the initial mmap
+ * a query is a plain memory read.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "include/status.h"
+#include "include/switch.h"
+
+/**
+ * @brief	number of attempts of a reader before it gives up on a busy writer
+ */
+#define STATUS_RETRIES 1000
+
+/**
+ * @brief	build the name of the shared memory segment for the current user
+ *
+ * @param[out]	name	string of length STATUS_NAME_LEN
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no user found in the environment
+ */
+int statusName(char *name)
+{
+	char *username = getenv("USER");
+	if(username == NULL || username[0] == '\0')
+		return -1;
+
+	snprintf(name, STATUS_NAME_LEN, "/csw-%s", username);
+	return 0;
+}
+
+/**
+ * @brief	map the shared memory segment into the address space
+ *
+ * The writer creates the segment and sizes it to one status record,
+ * a reader maps an existing segment read-only.
+ *
+ * @param[in]	name	name of the segment (see statusName)
+ * @param[in]	writable	1 for the writer, 0 for a reader
+ *
+ * @retval	pointer to the mapped status record on SUCCESS
+ * @retval	NULL	FAILURE
+ */
+struct status* openStatus(char *name, int writable)
+{
+	struct status *status = NULL;
+	struct stat s;
+	int fd = 0;
+
+	if(name == NULL)
+		return NULL;
+
+	fd = shm_open(name, writable ? O_RDWR | O_CREAT : O_RDONLY, 0600);
+	if(fd == -1)
+		return NULL;
+
+	if(fstat(fd, &s) != 0)
+		goto open_failed;
+
+	if((size_t)s.st_size < sizeof(struct status)) {
+		if(!writable || ftruncate(fd, sizeof(struct status)) != 0)
+			goto open_failed;
+	}
+
+	status = mmap(NULL, sizeof(struct status),
+			writable ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_SHARED, fd, 0);
+	close(fd);
+	if(status == MAP_FAILED)
+		return NULL;
+
+	return status;
+
+	open_failed:
+		close(fd);
+		return NULL;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void closeStatus(struct status *status)
+{
+	if(status != NULL)
+		munmap(status, sizeof(struct status));
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	copy the update into the shared record under the sequence lock
+ *
+ * The sequence of the update is ignored, the sequence of the shared record
+ * is odd for the duration of the copy.
+ *
+ * @param[out]	status	mapped status record
+ * @param[in]	update	new content of the record
+ */
+void publishStatus(struct status *status, struct status *update)
+{
+	unsigned int sequence = 0;
+
+	if(status == NULL || update == NULL)
+		return;
+
+	sequence = __atomic_load_n(&status->sequence, __ATOMIC_RELAXED);
+	__atomic_store_n(&status->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	status->pid = update->pid;
+	status->updated = update->updated;
+	memcpy(status->context, update->context, MAX_FIELD);
+	memcpy(status->zone, update->zone, MAX_FIELD);
+	memcpy(status->next_zone, update->next_zone, MAX_FIELD);
+	status->next_transition = update->next_transition;
+	status->delay = update->delay;
+	status->error_code = update->error_code;
+	memcpy(status->error_msg, update->error_msg, MAX_ROW);
+
+	__atomic_store_n(&status->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief	take a consistent snapshot of the shared record
+ *
+ * Retry as long as the writer is active or the sequence changed during
+ * the copy, the writer is never blocked by the reader.
+ *
+ * @param[in]	status	mapped status record
+ * @param[out]	snapshot	copy of the record
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE, no record or writer permanently busy
+ */
+int readStatus(struct status *status, struct status *snapshot)
+{
+	unsigned int begin = 0;
+	unsigned int end = 0;
+
+	if(status == NULL || snapshot == NULL)
+		return -1;
+
+	for(int i = 0 ; i < STATUS_RETRIES ; i++) {
+		begin = __atomic_load_n(&status->sequence, __ATOMIC_ACQUIRE);
+		if(begin & 1)
+			continue;
+
+		memcpy(snapshot, status, sizeof(struct status));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		end = __atomic_load_n(&status->sequence, __ATOMIC_RELAXED);
+		if(begin == end) {
+			snapshot->sequence = begin;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief	read the status of the current user
+ *
+ * The segment is mapped on the first call and kept for the lifetime
+ * of the process, every further call is a memory read.
+ *
+ * @param[out]	snapshot	copy of the record
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no status published yet
+ */
+int queryStatus(struct status *snapshot)
+{
+	static struct status *mapping = NULL;
+	char name[STATUS_NAME_LEN] = {0};
+
+	if(mapping == NULL) {
+		if(statusName(name) != 0)
+			return -1;
+
+		mapping = openStatus(name, 0);
+		if(mapping == NULL)
+			return -1;
+	}
+	return readStatus(mapping, snapshot);
+}
+
+/**
+ * @brief	describe the schedule at the given time within a status record
+ *
+ * @param[out]	state	status record to be filled
+ * @param[in]	config	parsed config
+ * @param[in]	datetime	current date & time
+ * @param[in]	rawtime	current unix timestamp
+ * @param[in]	context	active context in taskwarrior
+ */
+void fillStatus(struct status *state, struct config *config,
+		struct tm *datetime, time_t rawtime, char *context)
+{
+	struct tm delay = {0};
+	int minutes = datetime->tm_hour*60 + datetime->tm_min;
+	int distance = 0;
+	int index = 0;
+
+	state->pid = getpid();
+	state->updated = rawtime;
+	strncpy(state->context, context, MAX_FIELD-1);
+	stripChar(state->context, '\n');
+
+	memset(state->zone, 0, MAX_FIELD);
+	if((index = activeZone(config, minutes)) != -1)
+		strncpy(state->zone, config->zone_name[index], MAX_FIELD-1);
+
+	memset(state->next_zone, 0, MAX_FIELD);
+	state->next_transition = 0;
+	if((index = nextZone(config, minutes, &distance)) != -1) {
+		strncpy(state->next_zone, config->zone_name[index], MAX_FIELD-1);
+		state->next_transition = rawtime - datetime->tm_sec + distance*60;
+	}
+
+	state->delay = 0;
+	if(config->delay.tm_year + config->delay.tm_mon + config->delay.tm_mday > 0) {
+		copyTm(&delay, &config->delay);
+		delay.tm_isdst = -1;
+		state->delay = mktime(&delay);
+	}
+}
+
+/**
+ * @brief	record an error within the status record and publish it
+ *
+ * @param[out]	status	mapped status record (ignored if NULL)
+ * @param[in]	state	local status record
+ * @param[in]	error_code	negative error code
+ * @param[in]	error_msg	description of the error
+ */
+void statusError(struct status *status, struct status *state, int error_code,
+		char *error_msg)
+{
+	state->error_code = error_code;
+	strncpy(state->error_msg, error_msg, MAX_ROW-1);
+	publishStatus(status, state);
+}
+
+/**
+ * @brief	count a tick that was skipped for a run in progress
+ *
+ * The run in progress owns the sequence lock, the counter is updated
+ * atomically next to it and never copied by publishStatus.
+ *
+ * @param[out]	status	mapped status record (ignored if NULL)
+ * @param[in]	rawtime	point in time of the skipped tick
+ */
+void recordSkip(struct status *status, time_t rawtime)
+{
+	if(status == NULL)
+		return;
+
+	__atomic_fetch_add(&status->skipped, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&status->skipped_at, rawtime, __ATOMIC_RELAXED);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void showStatus(struct status *status)
+{
+	struct tm date = {0};
+
+	printf("Context: %s\n", status->context[0] ? status->context : "none");
+	printf("Zone: %s\n", status->zone[0] ? status->zone : "none");
+	if(status->next_zone[0] && getDate(&date, status->next_transition) == 0) {
+		printf("Next zone: %s at %4d-%02d-%02dT%02d:%02dZ\n", status->next_zone,
+				date.tm_year+1900, date.tm_mon+1, date.tm_mday,
+				date.tm_hour, date.tm_min);
+	}
+	if(status->delay > 0 && getDate(&date, status->delay) == 0) {
+		printf("Delay until: %4d-%02d-%02dT%02d:%02dZ\n",
+				date.tm_year+1900, date.tm_mon+1, date.tm_mday,
+				date.tm_hour, date.tm_min);
+	}
+	if(status->error_code != 0)
+		printf("Last error(%d): %s\n", status->error_code, status->error_msg);
+	if(status->skipped > 0 && getDate(&date, status->skipped_at) == 0) {
+		printf("Skipped ticks: %u, last at %4d-%02d-%02dT%02d:%02dZ\n",
+				status->skipped, date.tm_year+1900, date.tm_mon+1, date.tm_mday,
+				date.tm_hour, date.tm_min);
+	}
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -9,6 +9,7 @@
  * Send commands to task warrior to stop tasks, find active tasks or switch a context
  */
 #include "include/switch.h"
+#include <sys/wait.h>
 #ifndef CONFIG_H
 #include <string.h>
 #include <stdio.h>
@@ -72,30 +73,103 @@ EXCLUSION_STATE switchExclusion(struct exclusion* excl, struct tm *date)
  */
 SWITCH_STATE switchContext(struct config* conf, int time, char* new_context,
 			   char* current_context)
+{
+	if(conf == NULL)
+		return SWITCH_FAILURE;
+
+	return switchZone(conf, activeZone(conf, time), new_context, current_context);
+}
+
+/**
+ * @brief	compare the context of a zone with the active context
+ *
+ * @param[in]	conf	config structure instance pointer
+ * @param[in]	zone	index of the zone, -1 if no zone is active
+ * @param[out]	new_context	context of the zone
+ * @param[in]	current_context	active context in taskwarrior
+ *
+ * @retval	SWITCH_SUCCESS	current & new context differ
+ * @retval	SWITCH_NOTNEEDED	current & new context are equal
+ * @retval	SWITCH_FAILURE	no zone active
+ */
+SWITCH_STATE switchZone(struct config* conf, int zone, char* new_context,
+			   char* current_context)
+{
+	if(conf == NULL || zone < 0 || zone >= conf->zone_amount)
+		return SWITCH_FAILURE;
+
+	if(strncmp(conf->zone_context[zone], current_context, MAX_COMMAND) == 0) {
+		strncpy(new_context, "none", 5);
+		return SWITCH_NOTNEEDED;
+	}
+	strncpy(new_context, conf->zone_context[zone], MAX_COMMAND);
+	return SWITCH_SUCCESS;
+}
+
+/**
+ * @brief	find the zone that covers the given time
+ *
+ * @param[in]	conf	config structure instance pointer
+ * @param[in]	time	current time in minutes
+ *
+ * @retval	index of the zone on a match
+ * @retval	-1	time is not within any zone
+ */
+int activeZone(struct config* conf, int time)
 {
 	int start_time = 0;
 	int end_time = 0;
 
 	if(conf == NULL)
-		return SWITCH_FAILURE;
+		return -1;
 
 	for(int i = 0 ; i < conf->zone_amount ; i++) {
 		start_time = (conf->ztime[i].start_hour)*60 +
 						(conf->ztime[i].start_minute);
 		end_time = (conf->ztime[i].end_hour)*60 +
 						(conf->ztime[i].end_minute);
-		if(time >= start_time && time <= end_time) {
-			if(strncmp(conf->zone_context[i], current_context, MAX_COMMAND) == 0) {
-				strncpy(new_context, "none", 5);
-				return SWITCH_NOTNEEDED;
-			}
-			else {
-				strncpy(new_context, conf->zone_context[i], MAX_COMMAND);
-				return SWITCH_SUCCESS;
-			}
+		if(time >= start_time && time <= end_time)
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * @brief	find the zone with the nearest start after the given time
+ *
+ * A zone that already started today is considered for the next day.
+ *
+ * @param[in]	conf	config structure instance pointer
+ * @param[in]	time	current time in minutes
+ * @param[out]	distance	minutes until the start of the zone
+ *
+ * @retval	index of the next zone
+ * @retval	-1	no zones defined
+ */
+int nextZone(struct config* conf, int time, int *distance)
+{
+	int start_time = 0;
+	int next = -1;
+	int shortest = 0;
+
+	if(conf == NULL)
+		return -1;
+
+	for(int i = 0 ; i < conf->zone_amount ; i++) {
+		start_time = (conf->ztime[i].start_hour)*60 +
+						(conf->ztime[i].start_minute);
+		if(start_time <= time)
+			start_time += 24*60;
+
+		if(next == -1 || start_time - time < shortest) {
+			shortest = start_time - time;
+			next = i;
 		}
 	}
-	return SWITCH_FAILURE;
+	if(distance != NULL)
+		*distance = shortest;
+
+	return next;
 }
 
 /**
@@ -136,44 +210,51 @@ int rangeMatch(struct format_type *range, struct tm *date)
 /**
  * @brief	send a command to taskwarrior to switch to the specified context
  *
- * watch the reaction from taskwarrior for success
+ * watch the reaction from taskwarrior for success, the reason of a failure
+ * decides on the retry (see failure.c)
  *
+ * @param[in]	profile	rc overrides of the profile (empty for the default taskrc)
  * param[in]	input	specified context
+ * @param[out]	reaction	first line of the reaction, string of length MAX_ROW
  *
- * @retval	0	SUCCESS
- * @retval	-1	FAILURE
+ * @retval	SEND_SUCCESS	the context is set
+ * @retval	SEND_UNKNOWN	the context is not defined in the taskrc
+ * @retval	SEND_LOCKED	the data of taskwarrior is locked by another process
+ * @retval	SEND_MISSING	taskwarrior is not installed
+ * @retval	SEND_FAILURE	any other reaction
  */
-int sendCommand(char *input)
+SEND_STATE sendCommand(char *profile, char *input, char *reaction)
 {
 	FILE *process = NULL;
-	char command[40] = {"task context "};
-	char buffer[2][256] = {{0}};
+	char command[PATH_MAX + 2*MAX_ROW] = {0};
+	char buffer[MAX_ROW] = {0};
 	char *token = NULL;
-	int index = 0;
+	SEND_STATE result = SEND_FAILURE;
+	int status = 0;
 
-	strncat(command, input, 20);
-	strncat(command, " 2>&1", 6);
-	process = popen(command, "r");
-	while(fgets(buffer[index], 256, process) != NULL) {
-		strtok(buffer[index], " ");
+	reaction[0] = '\0';
+	snprintf(command, sizeof(command), "task%s%s context %.20s 2>&1", taskOverrides(),
+			profile, input);
+	if((process = popen(command, "r")) == NULL)
+		return SEND_FAILURE;
+	if(fgets(reaction, MAX_ROW, process) != NULL) {
+		reaction[strcspn(reaction, "\n")] = '\0';
+		snprintf(buffer, MAX_ROW, "%s", reaction);
+		strtok(buffer, " ");
 		strtok(NULL, " ");
 		token = strtok(NULL, " ");
-		if(strncmp(token, "not", 4) == 0) {
-			goto failure;
-		} else if(strncmp(token, "set.", 4) == 0) {
-			goto success;
-		} else{
-			fprintf(stderr,"Reaction from Taskwarrior:\n\n%s\n", buffer[index]);
-			goto failure;
-		}
-		index++;
+		if(token != NULL && strncmp(token, "set.", 4) == 0)
+			result = SEND_SUCCESS;
+		else if(strstr(reaction, "lock") != NULL)
+			result = SEND_LOCKED;
+		else if(token != NULL && strncmp(token, "not", 4) == 0)
+			result = SEND_UNKNOWN;
+		while(fgets(buffer, MAX_ROW, process) != NULL);
 	}
-	success:
-		pclose(process);
-		return 0;
-	failure:
-		pclose(process);
-		return -1;
+	status = pclose(process);
+	if(status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 127)
+		return SEND_MISSING;
+	return result;
 }
 
 /**
@@ -186,10 +267,11 @@ int sendCommand(char *input)
  */
 int activeTask()
 {
-	char command[MAX_COMMAND] = {"task +ACTIVE 2<&1"};
+	char command[MAX_ROW] = {0};
 	char buffer[MAX_FIELD] = {0};
 	FILE *process = NULL;
 
+	snprintf(command, MAX_ROW, "task%s +ACTIVE 2<&1", taskOverrides());
 	process = popen(command, "r");
 
 	fgets(buffer, MAX_FIELD, process);
@@ -202,26 +284,62 @@ int activeTask()
 }
 
 /**
- * @brief	send a command to taskwarrior, stop any Active task
+ * @brief	build the command to stop active tasks
  *
- * uses '2<&1' to redirect the stderr output to stdout
+ * The tasks are addressed by UUID, taskwarrior neither filters nor renders
+ * a report. Without UUIDs every active task is stopped.
+ *
+ * @param[out]	command	string for the command
+ * @param[in]	size	size of the command string
+ * @param[in]	profile	rc overrides of the profile (empty for the default taskrc)
+ * @param[in]	uuid	UUIDs of the active tasks
+ * @param[in]	amount	number of UUIDs (0 for +ACTIVE)
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	the command does not fit into the string
+ */
+int stopCommand(char *command, size_t size, char *profile, char (*uuid)[UUID_LEN],
+		int amount)
+{
+	size_t length = 0;
+
+	length = snprintf(command, size, "task%s%s%s", taskOverrides(), profile, TASK_STOP);
+	for(int i = 0 ; i < amount && length < size ; i++)
+		length += snprintf(command + length, size - length, " %s", uuid[i]);
+	if(amount == 0 && length < size)
+		length += snprintf(command + length, size - length, " +ACTIVE");
+	if(length < size)
+		length += snprintf(command + length, size - length, " stop 2>&1");
+	return length < size ? 0 : -1;
+}
+
+/**
+ * @brief	send a command to taskwarrior, stop the given active tasks
+ *
+ * The output is discarded, the exit status tells the result.
+ *
+ * @param[in]	profile	rc overrides of the profile (empty for the default taskrc)
+ * @param[in]	uuid	UUIDs of the active tasks
+ * @param[in]	amount	number of UUIDs (0 to stop any active task)
  *
  * @retval	0	SUCCESS
  * @retval	-1	FAILURE
  */
-int stopTask()
+int stopTasks(char *profile, char (*uuid)[UUID_LEN], int amount)
 {
-	char command[40] = {"task +ACTIVE stop 2<&1"};
-	char buffer[6] = {0};
+	char command[STOP_UUIDS*UUID_LEN + PATH_MAX + 2*MAX_ROW] = {0};
+	char buffer[MAX_ROW] = {0};
 	FILE *process = NULL;
+	int status = 0;
 
-	process = popen(command, "r");
-
-	fgets(buffer, 5, process);
-	if(strncmp(buffer, "Stop", 4) == 0) {
-		pclose(process);
-		return 0;
-	}
-	return -1;
-	pclose(process);
+	if(amount > STOP_UUIDS ||
+			stopCommand(command, sizeof(command), profile, uuid, amount) != 0)
+		return -1;
+	if((process = popen(command, "r")) == NULL)
+		return -1;
+	while(fgets(buffer, MAX_ROW, process) != NULL);
+	status = pclose(process);
+	if(status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		return -1;
+	return 0;
 }
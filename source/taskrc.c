@@ -0,0 +1,145 @@
+/**
+ * @file taskrc.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	read settings from the taskwarrior config without taskwarrior
+ *
+ * Asking taskwarrior for a setting costs a process per question, the
+ * taskrc is a plain key=value file. Includes are not followed, a setting
+ * that is missing in the taskrc has to be asked from taskwarrior.
+ */
+
+#include "include/taskrc.h"
+
+/**
+ * @brief	match one row of a taskrc against a key
+ *
+ * @param[in]	row	row of the taskrc, modified
+ * @param[in]	key	name of the setting
+ * @param[out]	value	string of length size
+ * @param[in]	size	size of value
+ *
+ * @retval	0	row assigns the key
+ * @retval	1	row doesn't assign the key
+ */
+int taskrcRow(char *row, char *key, char *value, size_t size)
+{
+	char *comment = NULL;
+	char *start = NULL;
+	char *end = NULL;
+	size_t key_len = strlen(key);
+
+	if((comment = strchr(row, '#')) != NULL)
+		*comment = '\0';
+
+	start = row;
+	while(*start == ' ' || *start == '\t')
+		start++;
+	if(strncmp(start, key, key_len) != 0)
+		return 1;
+
+	start += key_len;
+	while(*start == ' ' || *start == '\t')
+		start++;
+	if(*start != '=')
+		return 1;
+
+	start++;
+	while(*start == ' ' || *start == '\t')
+		start++;
+	end = start + strlen(start);
+	while(end > start && (end[-1] == '\n' || end[-1] == '\r' ||
+				end[-1] == ' ' || end[-1] == '\t'))
+		end--;
+
+	snprintf(value, size, "%.*s", (int)(end - start), start);
+	return 0;
+}
+
+/**
+ * @brief	find the value of a key in a taskrc
+ *
+ * Comments start with #, the last assignment of a key wins like in
+ * taskwarrior.
+ *
+ * @param[in]	path	location of the taskrc
+ * @param[in]	key	name of the setting (e.g. context, data.location)
+ * @param[out]	value	string of length size
+ * @param[in]	size	size of value
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	key not found
+ * @retval	-1	taskrc not readable
+ */
+int taskrcValue(char *path, char *key, char *value, size_t size)
+{
+	char row[MAX_ROW] = {0};
+	FILE *taskrc = NULL;
+	int found = 1;
+
+	taskrc = fopen(path, "r");
+	if(taskrc == NULL)
+		return -1;
+
+	while(fgets(row, MAX_ROW, taskrc) != NULL) {
+		if(taskrcRow(row, key, value, size) == 0)
+			found = 0;
+	}
+	fclose(taskrc);
+	return found;
+}
+
+/**
+ * @brief	read the active context from the taskrc
+ *
+ * task context writes the context to the taskrc of the user, a taskrc
+ * without it has no context.
+ *
+ * @param[out]	context	string of length size, "none" without a context
+ * @param[in]	size	size of context
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	taskrc not found or not readable
+ */
+int taskrcContext(char *context, size_t size)
+{
+	char path[PATH_MAX] = {0};
+
+	context[0] = '\0';
+	if(taskrcPath(path) != 0 || taskrcValue(path, "context", context, size) == -1)
+		return -1;
+	if(context[0] == '\0')
+		snprintf(context, size, "none");
+	return 0;
+}
+
+/**
+ * @brief	find the value of a key in a taskrc that is already in memory
+ *
+ * @param[in]	data	content of the taskrc
+ * @param[in]	length	number of bytes in data
+ * @param[in]	key	name of the setting
+ * @param[out]	value	string of length size
+ * @param[in]	size	size of value
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	key not found
+ */
+int taskrcBuffer(char *data, size_t length, char *key, char *value, size_t size)
+{
+	char row[MAX_ROW] = {0};
+	char *end = NULL;
+	size_t row_len = 0;
+	int found = 1;
+
+	while(length > 0) {
+		end = memchr(data, '\n', length);
+		row_len = end != NULL ? (size_t)(end - data) + 1 : length;
+		snprintf(row, MAX_ROW, "%.*s", (int)row_len, data);
+		if(taskrcRow(row, key, value, size) == 0)
+			found = 0;
+		data += row_len;
+		length -= row_len;
+	}
+	return found;
+}
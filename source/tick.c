@@ -0,0 +1,537 @@
+/**
+ * @file tick.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	a single run of the scheduler
+ *
+ * Read and parse the config, apply the command line flags, then switch the
+ * context if the current zone requires it. Used once per cron execution
+ * and on every timer expiration of the daemon. The runs of a user never
+ * overlap (runlock.c).
+ */
+
+#include "include/tick.h"
+
+extern int verbose;
+
+int compileConfig(struct runtime*, struct status*, char*, struct config*,
+		struct error*);
+int applyTick(struct runtime*, struct flags*, time_t, char*);
+int manualOverride(struct runtime*, struct config*, char*, time_t);
+void stageNext(struct runtime*, struct config*, char*, struct stage*, time_t);
+
+/**
+ * @brief	record an error in the status segment and the event stream
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	state	local status record of the run
+ * @param[in]	error_code	negative error code
+ * @param[in]	error_msg	description of the error
+ */
+void reportError(struct runtime *rt, struct status *state, int error_code,
+		char *error_msg)
+{
+	statusError(rt->status, state, error_code, error_msg);
+	emitEvent(rt->events, "error", "code=%d msg=%s", error_code, error_msg);
+}
+
+/**
+ * @brief	parse the config or take it from the compiled cache
+ *
+ * The cache is bypassed as soon as the config, the taskrc or the
+ * system-wide base changed, the result of a fresh parse replaces the
+ * cache. With a base the config of the user is parsed on top of it.
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	state	status record used for error reports
+ * @param[in]	config_path	location of the config
+ * @param[out]	config	parsed config
+ * @param[out]	error	errors found while parsing
+ *
+ * @retval	0	SUCCESS
+ * @retval	EXIT_FAILURE	FAILURE
+ */
+int compileConfig(struct runtime *rt, struct status *state, char *config_path,
+		struct config *config, struct error *error)
+{
+	CONFIG_STATE config_state = 0;
+	struct configcontent content = {
+		.amount = 0, .rowindex = {0}, .option_name = {{{0}}}, .option_value = {{{0}}},
+		.sub_option_amount = {0} };
+	struct cache_header header = {0};
+	struct compiled compiled;
+	struct base_layer local;
+	struct base_layer *base = rt->base;
+	char cache_path[PATH_MAX] = {0};
+	char taskrc_path[PATH_MAX] = {0};
+	int cacheable = 0;
+
+	if(base == NULL) {
+		base = &local;
+		if(loadBase(BASE_CONFIG, base) == -1)
+			fprintf(stderr, "WARNING: base config %s unreadable\n", BASE_CONFIG);
+	}
+	header.base = base->key;
+
+	if(cachePath(cache_path, config_path) == 0 &&
+			fileKey(config_path, &header.config) == 0 &&
+			taskrcPath(taskrc_path) == 0 &&
+			fileKey(taskrc_path, &header.taskrc) != -1) {
+		cacheable = 1;
+		if(loadCache(cache_path, &header, &compiled) == 0) {
+			if(verbose)
+				printf("config loaded from the cache at: %s\n", cache_path);
+			*config = compiled.config;
+			*error = compiled.error;
+			return 0;
+		}
+	}
+
+	config_state=readConfig(&content, error, config_path);
+	switch(config_state) {
+		case CONFIG_SUCCESS:
+			if(verbose)
+				printf("config read success\n");
+			break;
+		case CONFIG_BAD:
+			fprintf(stderr, "config has a bad format, reading failed!\n");
+			reportError(rt, state, -1, "config has a bad format");
+			return EXIT_FAILURE;
+		case CONFIG_NOTFOUND:
+			fprintf(stderr, "Config file was not found!\n");
+			reportError(rt, state, -1, "config file was not found");
+			return EXIT_FAILURE;
+	}
+
+	if((base->state == 0 ? layerConfig(&content, error, base, config) :
+				parseConfig(&content, error, config)) != 0) {
+		reportError(rt, state, -1, "config parse failed");
+		return EXIT_FAILURE;
+	}
+
+	if(cacheable) {
+		memset(&compiled, 0, sizeof(struct compiled));
+		compiled.config = *config;
+		compiled.error = *error;
+		if(storeCache(cache_path, &header, &compiled) != 0 && verbose)
+			printf("config cache %s not writable\n", cache_path);
+	}
+	return 0;
+}
+
+/**
+ * @brief	check if the context was changed by hand since the last switch
+ *
+ * A context that differs from the one csw applied is kept until the next
+ * boundary of the schedule.
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	config	config with the replayed journal
+ * @param[in]	current	active context in taskwarrior
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	1	the context was overridden, no switch
+ * @retval	0	the schedule applies
+ */
+int manualOverride(struct runtime *rt, struct config *config, char *current,
+		time_t rawtime)
+{
+	if(config->applied[0] == '\0' ||
+			strncmp(config->applied, current, MAX_COMMAND) == 0)
+		return 0;
+	return !boundaryPassed(&rt->timeline, config, (time_t)config->applied_at, rawtime);
+}
+
+/**
+ * @brief	stage the next transition if its boundary is near
+ *
+ * A transition is staged within STAGE_LEAD minutes or one interval before
+ * its boundary, a stage for a transition that isn't near is dropped.
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	config	config with the replayed journal
+ * @param[in]	path	location of the stage (empty if unavailable)
+ * @param[in,out]	stage	stored stage
+ * @param[in]	rawtime	current unix timestamp
+ */
+void stageNext(struct runtime *rt, struct config *config, char *path,
+		struct stage *stage, time_t rawtime)
+{
+	struct transition *transition = NULL;
+	struct tm datetime = {0};
+	char taskrc_path[PATH_MAX] = {0};
+	char directory[PATH_MAX] = {0};
+	int minute = (int)(rawtime / 60);
+	int lead = config->interval > STAGE_LEAD ? config->interval : STAGE_LEAD;
+	int distance = 0;
+	int next = -1;
+	int result = 0;
+
+	if(path[0] == '\0')
+		return;
+	if(rt->timeline.header != NULL) {
+		if((transition = nextTransition(&rt->timeline, minute)) != NULL) {
+			next = transition->zone;
+			distance = transition->minute - minute;
+		}
+	} else if(getDate(&datetime, rawtime) == 0) {
+		next = nextZone(config, datetime.tm_hour*60 + datetime.tm_min, &distance);
+	}
+	if(next < 0 || distance > lead || taskrcPath(taskrc_path) != 0) {
+		dropStage(path, stage);
+		return;
+	}
+	if(dataLocation(directory) != 0)
+		directory[0] = '\0';
+	if(stageCurrent(stage, taskrc_path, directory, config->zone_context[next],
+				(time_t)(minute + distance) * 60))
+		return;
+
+	dropStage(path, stage);
+	result = prepareStage(stage, taskrc_path, directory, config->zone_context[next],
+			(time_t)(minute + distance) * 60, config->cancel);
+	if(result == 0 && storeStage(path, stage) != 0) {
+		fprintf(stderr, "WARNING: stage %s not writable\n", path);
+		dropStage(path, stage);
+		return;
+	}
+	if(result != 0) {
+		if(result == -1 && verbose)
+			printf("transition to %s can't be staged\n", config->zone_context[next]);
+		memset(stage, 0, sizeof(struct stage));
+		return;
+	}
+	emitEvent(rt->events, "stage", "to=%s at=%ld stop=%d", stage->context,
+			stage->at, stage->amount);
+	if(verbose)
+		printf("transition to %s at %ld staged (%d active tasks)\n", stage->context,
+				stage->at, stage->amount);
+}
+
+/**
+ * @brief	run the scheduler for the given point in time, with the run lock
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	flag	parsed command line options
+ * @param[in]	rawtime	current unix timestamp
+ * @param[in]	config_path	location of the config
+ *
+ * @retval	EXIT_SUCCESS	switched or no switch required
+ * @retval	EXIT_FAILURE	config or taskwarrior failure
+ */
+int applyTick(struct runtime *rt, struct flags *flag, time_t rawtime,
+		char *config_path)
+{
+	SWITCH_STATE switch_state = 0;
+	struct tm datetime = {0};
+	char journal_path[PATH_MAX] = {0};
+	char timeline_path[PATH_MAX] = {0};
+	char failure_path[PATH_MAX] = {0};
+	char stage_path[PATH_MAX] = {0};
+	char taskrc_path[PATH_MAX] = {0};
+	struct timespec applied = {0};
+	struct stage stage = {0};
+	struct hook_run hooks;
+	struct profile_action action[MAX_PROFILES+1];
+	struct profile_action *failed = NULL;
+	struct failure_state failure = {0};
+	unsigned int notified = 0;
+	struct config before;
+	struct config config = {
+		.zone_name={{0}}, .ztime={{0}}, .zone_context={{0}}, .zone_amount=0,
+		.excl={
+			.type={{.weekdays={0}, .single_days={{0}}, .holiday_start={0},
+				.holiday_end={0}, .list_len=0, .sub_type={0}}},
+			.type_name={{0}}, .amount=0, },
+		.delay={0}, .cancel=0, .notify=0, .interval=0 };
+	struct error error = {
+		.amount = 0, .rowindex = {0}, .error_code = {0}, .error_msg = {{0}} };
+	char current_context[MAX_COMMAND] = {0};
+	char command[MAX_COMMAND] = {0};
+	struct status state = {0};
+	int excluded = 0;
+	int records = 0;
+	int amount = 0;
+	int zone = 0;
+
+	if(getDate(&datetime, rawtime) == -1)
+		return EXIT_FAILURE;
+
+	state.pid = getpid();
+	state.updated = rawtime;
+	rt->applied = 0;
+	rt->enforce[0] = '\0';
+
+	if(compileConfig(rt, &state, config_path, &config, &error) != 0)
+		return EXIT_FAILURE;
+	quietTask(config.large);
+
+	if(flag->show == 1)
+		showZones(&config);
+
+	if(journalPath(journal_path, config_path, config.persistent) != 0) {
+		reportError(rt, &state, -1, "state journal unavailable");
+		return EXIT_FAILURE;
+	}
+	if((records = replayJournal(&config, journal_path)) == -1)
+		fprintf(stderr, "WARNING: state journal %s unreadable\n", journal_path);
+
+	if(timelinePath(timeline_path, config_path) != 0 ||
+			loadTimeline(&rt->timeline, timeline_path, &config, rawtime) != 0)
+		fprintf(stderr, "WARNING: timeline %s unavailable\n", timeline_path);
+
+	before = config;
+	if(syncConfig(&config, flag, &datetime) == 1) {
+		if(verbose)
+			printf("append changes to the state journal\n");
+
+		if(journalChanges(journal_path, &before, &config) == -1) {
+			reportError(rt, &state, -1, "appending to the state journal failed");
+			return EXIT_FAILURE;
+		}
+	}
+	if(records > JOURNAL_COMPACT && compactJournal(journal_path, &config) != 0)
+		fprintf(stderr, "WARNING: compaction of the state journal failed\n");
+	rt->interval = config.interval;
+	rt->applied = 1;
+
+	if(failurePath(failure_path, config_path, config.persistent) != 0 ||
+			loadFailure(failure_path, &failure) != 0)
+		fprintf(stderr, "WARNING: failure state %s unreadable\n", failure_path);
+	notified = failure.notified;
+	if(newErrors(&failure, &error) && config.notify == 1) {
+		if(notifyError(&error) == -1 && verbose)
+			fprintf(stderr, "WARNING: sending notification to notify daemon failed\n");
+	}
+	if(failure.notified != notified)
+		storeFailure(failure_path, &failure);
+	if(stagePath(stage_path, config_path, config.persistent) == 0)
+		loadStage(stage_path, &stage);
+
+	if(rt->timeline.header != NULL)
+		zone = lookupTimeline(&rt->timeline, (int)(rawtime / 60));
+	else
+		zone = activeZone(&config, datetime.tm_hour*60+datetime.tm_min);
+	if(flag->switch_now == 0 && zone >= 0 &&
+			backedOff(&failure, config.zone_context[zone], rawtime)) {
+		if(verbose)
+			printf("switch to %s backed off after %d failures until %lld\n",
+					failure.context, failure.count, (long long)failure.retry);
+		return EXIT_SUCCESS;
+	}
+
+	if(taskrcContext(current_context, MAX_COMMAND) != 0 &&
+			currentContext(current_context) != 0) {
+		if(zone >= 0 && recordFailure(&failure, config.zone_context[zone],
+					SEND_FAILURE, rawtime))
+			fprintf(stderr, "ERROR: Couldn't aquire the active context\n");
+		storeFailure(failure_path, &failure);
+		reportError(rt, &state, -1, "couldn't aquire the active context");
+		return EXIT_FAILURE;
+	}
+
+	if(verbose) {
+		printf("current date & time : %d%s day of the week\t%4d-%02d-%02dT%02d:%02dZ\n",
+		       datetime.tm_wday, datetime.tm_wday==1?
+		       "st":datetime.tm_wday==2?"nd":
+		       datetime.tm_wday==3?"rd":"th",
+		       datetime.tm_year+1900, datetime.tm_mon+1,
+		       datetime.tm_mday, datetime.tm_hour, datetime.tm_min);
+	}
+
+	fillStatus(&state, &config, &datetime, rawtime, current_context);
+	if(rt->timeline.header != NULL)
+		timelineStatus(&rt->timeline, &config, &state, rawtime);
+	if(error.amount > 0) {
+		state.error_code = error.error_code[error.amount-1];
+		strncpy(state.error_msg, error.error_msg[error.amount-1], MAX_ROW-1);
+		for(int i = 0 ; i < error.amount ; i++) {
+			emitEvent(rt->events, "error", "code=%d line=%d msg=%s",
+					error.error_code[i], error.rowindex[i], error.error_msg[i]);
+		}
+	}
+	publishStatus(rt->status, &state);
+
+	if(state.delay != rt->delay) {
+		if(state.delay > 0)
+			emitEvent(rt->events, "delay", "until=%ld", (long)state.delay);
+		else
+			emitEvent(rt->events, "delay", "until=0");
+		rt->delay = state.delay;
+	}
+
+	if(config.delay.tm_year + config.delay.tm_mon)
+		return EXIT_SUCCESS;
+
+	if(flag->show == 1 && config.excl.amount > 0)
+		showExclusions(&config.excl);
+
+	excluded = switchExclusion(&config.excl, &datetime) == EXCLUSION_MATCH;
+	if(excluded != rt->excluded) {
+		emitEvent(rt->events, "exclusion", "match=%d", excluded);
+		rt->excluded = excluded;
+	}
+	if(excluded) {
+		if(verbose)
+			printf("found a exclusion that matches\n");
+		return EXIT_SUCCESS;
+	}
+
+	if(flag->switch_now == 0 && manualOverride(rt, &config, current_context, rawtime)) {
+		if(verbose)
+			printf("context %s set by hand, %s is applied at the next boundary\n",
+					current_context, config.applied);
+		stageNext(rt, &config, stage_path, &stage, rawtime);
+		return EXIT_SUCCESS;
+	}
+
+	switch_state = switchZone(&config, zone, &command[0], current_context);
+	if(switch_state == SWITCH_FAILURE) {
+		if(verbose)
+			printf("Switch failed!\n");
+		return EXIT_FAILURE;
+	}
+
+	/* the default taskrc and the profiles are switched concurrently */
+	amount = profileActions(&config, config.zone_context[zone],
+			switch_state == SWITCH_SUCCESS, action);
+	/* a staged transition is a rename of the prepared taskrc */
+	if(switch_state == SWITCH_SUCCESS && taskrcPath(taskrc_path) == 0 &&
+			commitStage(&stage, taskrc_path, command) == 0) {
+		action[0].staged = 1;
+		stagedTasks(&stage, action[0].directory, &action[0]);
+		clock_gettime(CLOCK_REALTIME, &applied);
+		if(verbose)
+			printf("context %s applied from the stage %.1f ms after the boundary\n",
+					command, ((applied.tv_sec - stage.at) * 1000000000L +
+						applied.tv_nsec) / 1000000.0);
+	}
+	fanOut(action, amount);
+	for(int i = 0 ; i < amount ; i++) {
+		if(action[i].result != SEND_SUCCESS && failed == NULL)
+			failed = &action[i];
+		if(action[i].stopped != 0)
+			fprintf(stderr, "Task stop failed (profile %s)!\n", action[i].name);
+		if(config.profile_amount > 0)
+			emitEvent(rt->events, "profile", "name=%s to=%s result=%s us=%ld",
+					action[i].name, action[i].context,
+					action[i].result == SEND_SUCCESS ? "switched" : "failed",
+					action[i].elapsed / 1000);
+	}
+
+	if(switch_state == SWITCH_SUCCESS && action[0].result == SEND_SUCCESS) {
+		if(journalApplied(journal_path, &config, command, rawtime) != 0)
+			fprintf(stderr, "WARNING: appending to the state journal failed\n");
+		emitEvent(rt->events, "transition", "zone=%s from=%s to=%s",
+				zone != -1 ? config.zone_name[zone] : "none",
+				state.context[0] ? state.context : "none", command);
+		/* the hooks run detached, the run doesn't wait for them */
+		if(prepareHooks(&config, zone, &hooks) > 0) {
+			snprintf(hooks.from, MAX_FIELD, "%s", state.context[0] ? state.context : "none");
+			snprintf(hooks.to, MAX_COMMAND, "%s", command);
+			if(hookLogPath(hooks.log, config_path, config.persistent) != 0)
+				hooks.log[0] = '\0';
+			if(startHooks(&hooks) != 0)
+				fprintf(stderr, "WARNING: the hooks of the transition couldn't be started\n");
+			else
+				emitEvent(rt->events, "hooks", "started=%d", hooks.amount);
+			if(verbose)
+				printf("%d hooks started, results in %s\n", hooks.amount, hooks.log);
+		}
+		strncpy(state.context, command, MAX_FIELD-1);
+		publishStatus(rt->status, &state);
+		if(verbose)
+			printf("Switch succesful!\n");
+	} else if(switch_state == SWITCH_NOTNEEDED) {
+		/* the context of a new zone was already set, adopt it */
+		if((strncmp(config.applied, config.zone_context[zone], MAX_COMMAND) != 0 ||
+				boundaryPassed(&rt->timeline, &config,
+					(time_t)config.applied_at, rawtime)) &&
+				journalApplied(journal_path, &config,
+					config.zone_context[zone], rawtime) != 0)
+			fprintf(stderr, "WARNING: appending to the state journal failed\n");
+		if(verbose)
+			printf("Switch not needed!\n");
+	}
+
+	if(failed != NULL) {
+		if(recordFailure(&failure, failed->context, failed->result, rawtime)) {
+			fprintf(stderr, "Sending the command failed: %s (profile %s)\n",
+					sendReason(failed->result), failed->name);
+			if(failed->reaction[0] != '\0')
+				fprintf(stderr,"Reaction from Taskwarrior:\n\n%s\n", failed->reaction);
+			if(config.notify == 1 && notifyFailure(&failure) == -1 && verbose)
+				fprintf(stderr, "WARNING: sending notification to notify daemon failed\n");
+		}
+		storeFailure(failure_path, &failure);
+		reportError(rt, &state, -1, "context switch failed");
+		return EXIT_FAILURE;
+	}
+	if(failure.count > 0) {
+		clearFailure(&failure);
+		storeFailure(failure_path, &failure);
+	}
+	if(config.cancel)
+		snprintf(rt->enforce, MAX_COMMAND, "%s", config.zone_context[zone]);
+	stageNext(rt, &config, stage_path, &stage, rawtime);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief	run the scheduler for the given point in time
+ *
+ * A tick that finds another run of the user in progress is skipped and
+ * counted in the status segment, a request from the command line waits
+ * for the run in progress.
+ *
+ * @param[in]	rt	runtime of the scheduler
+ * @param[in]	flag	parsed command line options
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	EXIT_SUCCESS	switched, no switch required or skipped
+ * @retval	EXIT_FAILURE	config or taskwarrior failure
+ */
+int runTick(struct runtime *rt, struct flags *flag, time_t rawtime)
+{
+	FILE_STATE file_state = 0;
+	char config_path[PATH_MAX] = {0};
+	char line[MAX_ROW] = {0};
+	int request = flag->show == 1 || buildControl(flag, line) > 0;
+	int result = 0;
+	int lock = -1;
+
+	rt->applied = 0;
+	file_state = findConfig("config", config_path);
+	switch(file_state) {
+		case FILE_GOOD:
+			if(verbose)
+				printf("File found and in good state at: %s\n", config_path);
+			break;
+		case FILE_NOTFOUND:
+			if(verbose)
+				printf("File was not found in .task/csw/\n");
+			return EXIT_FAILURE;
+		case FILE_ERROR:
+			fprintf(stderr,"ERROR: config file finder caused an error\n");
+			return EXIT_FAILURE;
+	}
+
+	switch(lockRun(config_path, request, &lock)) {
+		case RUN_LOCKED:
+			break;
+		case RUN_BUSY:
+			if(verbose)
+				printf("a run is in progress, tick skipped\n");
+			recordSkip(rt->status, rawtime);
+			emitEvent(rt->events, "skip", "reason=busy");
+			return EXIT_SUCCESS;
+		case RUN_UNLOCKED:
+			if(verbose)
+				printf("run lock unavailable, running without it\n");
+			break;
+	}
+
+	result = applyTick(rt, flag, rawtime, config_path);
+	unlockRun(lock);
+	return result;
+}
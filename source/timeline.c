@@ -0,0 +1,601 @@
+/**
+ * @file timeline.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	precomputed transitions of the schedule for the next year
+ *
+ * Zones and exclusions are expanded into a sorted list of
+ * (epoch-minute, zone) transitions, stored next to the config and mapped
+ * by every run. The zone at a point in time is a binary search, or a
+ * forward step of the cursor as time only moves forward. The file is
+ * rebuilt when the zones or exclusions change or when less than
+ * TIMELINE_REFRESH days are left on the horizon.
+ */
+
+#define _DEFAULT_SOURCE
+#include <sys/mman.h>
+#include "include/timeline.h"
+
+/**
+ * @brief	locate the timeline file next to the config
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	path of the config of the user
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int timelinePath(char *path, char *config_path)
+{
+	char *separator = NULL;
+
+	if(config_path == NULL || (separator = strrchr(config_path, '/')) == NULL)
+		return -1;
+
+	snprintf(path, PATH_MAX, "%.*s/timeline",
+			(int)(separator - config_path), config_path);
+	return 0;
+}
+
+/**
+ * @brief	identify the time zone of the process
+ *
+ * $TZ and the identity of the file the zone is read from: /etc/localtime
+ * without TZ, the file of TZ=:<path>. A new link or a rewritten file
+ * changes the identity, even while TZ stays unset.
+ *
+ * @param[out]	zone	string of length PATH_MAX
+ */
+void zoneIdentity(char *zone)
+{
+	struct file_key key = {0};
+	char *tz = getenv("TZ");
+	char *file = "/etc/localtime";
+
+	if(tz != NULL)
+		file = tz[0] == ':' ? tz + 1 : tz[0] == '/' ? tz : NULL;
+	if(file != NULL)
+		fileKey(file, &key);
+	snprintf(zone, PATH_MAX, "%.*s;%llx:%llx:%llx:%llx.%llx", PATH_MAX - 90,
+			tz != NULL ? tz : "", key.device, key.inode,
+			(unsigned long long)key.size, (unsigned long long)key.mtime,
+			(unsigned long long)key.mtime_nsec);
+}
+
+/**
+ * @brief	hash the inputs of the timeline
+ *
+ * Only the fields that shape the schedule are hashed, struct tm carries
+ * pointers that differ between two processes. The time zone is part of
+ * the hash as it moves the local time of every transition (see
+ * zoneIdentity).
+ *
+ * @param[in]	config	parsed config
+ *
+ * @retval	hash
+ */
+unsigned int scheduleHash(struct config *config)
+{
+	struct format_type *type = NULL;
+	unsigned int hash = checksum(&config->zone_amount, sizeof(int));
+	char zone[PATH_MAX] = {0};
+	int day[3] = {0};
+
+	zoneIdentity(zone);
+	hash = extendChecksum(hash, zone, strlen(zone));
+
+	for(int i = 0 ; i < config->zone_amount ; i++)
+		hash = extendChecksum(hash, &config->ztime[i], sizeof(struct zonetime));
+
+	hash = extendChecksum(hash, &config->excl.amount, sizeof(int));
+	for(int i = 0 ; i < config->excl.amount ; i++) {
+		type = &config->excl.type[i];
+		hash = extendChecksum(hash, config->excl.type_name[i], TYPE_LEN);
+		hash = extendChecksum(hash, type->sub_type, TYPE_LEN);
+		hash = extendChecksum(hash, type->weekdays, sizeof(type->weekdays));
+		hash = extendChecksum(hash, &type->list_len, sizeof(int));
+		for(int j = 0 ; j < MAX_EXCLUSION + 2 ; j++) {
+			struct tm *date = j < MAX_EXCLUSION ? &type->single_days[j] :
+				j == MAX_EXCLUSION ? &type->holiday_start : &type->holiday_end;
+			day[0] = date->tm_year;
+			day[1] = date->tm_mon;
+			day[2] = date->tm_mday;
+			hash = extendChecksum(hash, day, sizeof(day));
+		}
+	}
+	return hash;
+}
+
+/**
+ * @brief	compare the inputs of the timeline of two configs
+ *
+ * Compares the fields of scheduleHash, except the time zone which belongs
+ * to the process.
+ *
+ * @param[in]	first	parsed config
+ * @param[in]	second	parsed config
+ *
+ * @retval	1	both configs shape the same schedule
+ * @retval	0	the schedules differ
+ */
+int sameSchedule(struct config *first, struct config *second)
+{
+	struct format_type *type[2] = {NULL};
+	struct tm *date[2] = {NULL};
+
+	if(first->zone_amount != second->zone_amount ||
+			memcmp(first->ztime, second->ztime,
+				first->zone_amount * sizeof(struct zonetime)) != 0 ||
+			first->excl.amount != second->excl.amount)
+		return 0;
+
+	for(int i = 0 ; i < first->excl.amount ; i++) {
+		type[0] = &first->excl.type[i];
+		type[1] = &second->excl.type[i];
+		if(strncmp(first->excl.type_name[i], second->excl.type_name[i], TYPE_LEN) != 0 ||
+				strncmp(type[0]->sub_type, type[1]->sub_type, TYPE_LEN) != 0 ||
+				memcmp(type[0]->weekdays, type[1]->weekdays, sizeof(type[0]->weekdays)) != 0 ||
+				type[0]->list_len != type[1]->list_len)
+			return 0;
+		for(int j = 0 ; j < MAX_EXCLUSION + 2 ; j++) {
+			for(int k = 0 ; k < 2 ; k++)
+				date[k] = j < MAX_EXCLUSION ? &type[k]->single_days[j] :
+					j == MAX_EXCLUSION ? &type[k]->holiday_start : &type[k]->holiday_end;
+			if(date[0]->tm_year != date[1]->tm_year ||
+					date[0]->tm_mon != date[1]->tm_mon ||
+					date[0]->tm_mday != date[1]->tm_mday)
+				return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief	transitions of a day without exclusions
+ *
+ * The zone of every minute is taken from activeZone, so overlapping zones
+ * resolve exactly like a run at that minute.
+ *
+ * @param[in]	config	parsed config
+ * @param[out]	profile	array of DAY_TRANSITIONS transitions, minute is
+ * 						the minute of the day
+ *
+ * @retval	number of transitions (at least 1)
+ */
+int dayProfile(struct config *config, struct transition *profile)
+{
+	int amount = 0;
+	int zone = 0;
+
+	for(int minute = 0 ; minute < 24*60 ; minute++) {
+		zone = activeZone(config, minute);
+		if(amount > 0 && profile[amount-1].zone == zone)
+			continue;
+		if(amount == DAY_TRANSITIONS)
+			break;
+		profile[amount].minute = minute;
+		profile[amount].zone = zone;
+		amount++;
+	}
+	return amount;
+}
+
+/**
+ * @brief	expand the schedule into transitions
+ *
+ * The local time of every transition is converted with mktime, a
+ * transition that lands on or before its predecessor (daylight saving
+ * switch) replaces the predecessor.
+ *
+ * @param[in]	config	parsed config
+ * @param[in]	start	first second of the first day
+ * @param[in]	days	number of days to expand
+ * @param[out]	entry	array of days * DAY_TRANSITIONS transitions
+ *
+ * @retval	number of transitions
+ */
+int buildTimeline(struct config *config, time_t start, int days,
+		struct transition *entry)
+{
+	struct transition profile[DAY_TRANSITIONS];
+	struct tm first = {0};
+	struct tm date = {0};
+	int profile_amount = dayProfile(config, profile);
+	int amount = 0;
+	int excluded = 0;
+	int minute = 0;
+	int zone = 0;
+
+	localtime_r(&start, &first);
+	for(int day = 0 ; day < days ; day++) {
+		for(int i = 0 ; i < profile_amount ; i++) {
+			date = first;
+			date.tm_mday += day;
+			date.tm_hour = profile[i].minute / 60;
+			date.tm_min = profile[i].minute % 60;
+			date.tm_sec = 0;
+			date.tm_isdst = -1;
+			minute = (int)(mktime(&date) / 60);
+			if(i == 0)
+				excluded = switchExclusion(&config->excl, &date) == EXCLUSION_MATCH;
+			else if(excluded)
+				break;
+			zone = excluded ? -1 : profile[i].zone;
+
+			while(amount > 0 && entry[amount-1].minute >= minute)
+				amount--;
+			if(amount > 0 && entry[amount-1].zone == zone)
+				continue;
+			entry[amount].minute = minute;
+			entry[amount].zone = zone;
+			amount++;
+		}
+	}
+	return amount;
+}
+
+/**
+ * @brief	write the timeline through a temporary file and a rename
+ *
+ * @param[in]	path	location of the timeline
+ * @param[in,out]	header	header, magic, version and checksum are set
+ * @param[in]	entry	header->amount transitions
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int writeTimeline(char *path, struct timeline_header *header,
+		struct transition *entry)
+{
+	char tmp_name[PATH_MAX] = {0};
+	size_t size = header->amount * sizeof(struct transition);
+	int fd = -1;
+
+	memcpy(header->magic, TIMELINE_MAGIC, 4);
+	header->version = TIMELINE_VERSION;
+	header->checksum = checksum(entry, size);
+
+	snprintf(tmp_name, PATH_MAX, "%.*s.XXXXXX", PATH_MAX-8, path);
+	fd = mkstemp(tmp_name);
+	if(fd == -1)
+		return -1;
+
+	if(write(fd, header, sizeof(struct timeline_header)) !=
+			(ssize_t)sizeof(struct timeline_header) ||
+			write(fd, entry, size) != (ssize_t)size) {
+		close(fd);
+		unlink(tmp_name);
+		return -1;
+	}
+	close(fd);
+	if(rename(tmp_name, path) != 0) {
+		unlink(tmp_name);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	map a timeline file and verify it
+ *
+ * @param[out]	timeline	mapped timeline
+ * @param[in]	path	location of the timeline
+ *
+ * @retval	0	SUCCESS
+ * @retval	1	missing or corrupted file
+ */
+int openTimeline(struct timeline *timeline, char *path)
+{
+	struct timeline_header *header = NULL;
+	struct stat s;
+	void *mapping = NULL;
+	size_t size = 0;
+	int fd = -1;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+		return 1;
+
+	if(fstat(fd, &s) != 0 || (size_t)s.st_size < sizeof(struct timeline_header)) {
+		close(fd);
+		return 1;
+	}
+	size = s.st_size;
+	mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mapping == MAP_FAILED)
+		return 1;
+
+	header = mapping;
+	if(memcmp(header->magic, TIMELINE_MAGIC, 4) != 0 ||
+			header->version != TIMELINE_VERSION || header->amount == 0 ||
+			size != sizeof(struct timeline_header) +
+			header->amount * sizeof(struct transition) ||
+			header->checksum != checksum(header + 1,
+				header->amount * sizeof(struct transition))) {
+		munmap(mapping, size);
+		return 1;
+	}
+	timeline->header = header;
+	timeline->entry = (struct transition*)(header + 1);
+	timeline->size = size;
+	timeline->cursor = 0;
+	return 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+int validTimeline(struct timeline *timeline, unsigned int source, int minute)
+{
+	return timeline->header != NULL && timeline->header->source == source &&
+		timeline->header->start <= minute &&
+		timeline->header->end - TIMELINE_REFRESH*24*60 > minute;
+}
+
+void closeTimeline(struct timeline *timeline)
+{
+	if(timeline->header != NULL)
+		munmap(timeline->header, timeline->size);
+	memset(timeline, 0, sizeof(struct timeline));
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	expand the config into the transitions of the next year
+ *
+ * @param[in]	config	parsed config
+ * @param[in]	rawtime	current unix timestamp
+ * @param[out]	header	header with source, start, end and amount set
+ *
+ * @retval	transitions on the heap
+ * @retval	NULL	FAILURE
+ */
+struct transition* composeTimeline(struct config *config, time_t rawtime,
+		struct timeline_header *header)
+{
+	struct transition *entry = NULL;
+	struct tm midnight = {0};
+
+	entry = malloc((TIMELINE_DAYS+1) * DAY_TRANSITIONS * sizeof(struct transition));
+	if(entry == NULL)
+		return NULL;
+
+	localtime_r(&rawtime, &midnight);
+	midnight.tm_hour = 0;
+	midnight.tm_min = 0;
+	midnight.tm_sec = 0;
+	midnight.tm_isdst = -1;
+	header->source = scheduleHash(config);
+	header->amount = buildTimeline(config, mktime(&midnight), TIMELINE_DAYS+1, entry);
+	header->start = entry[0].minute;
+	midnight.tm_mday += TIMELINE_DAYS+1;
+	midnight.tm_isdst = -1;
+	header->end = (int)(mktime(&midnight) / 60);
+	return entry;
+}
+
+/**
+ * @brief	provide a timeline that matches the config and covers the time
+ *
+ * A mapped timeline is kept as long as it is valid, otherwise the file is
+ * mapped again or rebuilt from the config.
+ *
+ * @param[in,out]	timeline	mapped timeline
+ * @param[in]	path	location of the timeline
+ * @param[in]	config	parsed config
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE, the timeline is unmapped
+ */
+int loadTimeline(struct timeline *timeline, char *path, struct config *config,
+		time_t rawtime)
+{
+	struct timeline_header header = {0};
+	struct transition *entry = NULL;
+	unsigned int source = scheduleHash(config);
+	int minute = (int)(rawtime / 60);
+
+	if(validTimeline(timeline, source, minute))
+		return 0;
+
+	closeTimeline(timeline);
+	if(openTimeline(timeline, path) == 0 && validTimeline(timeline, source, minute))
+		return 0;
+
+	closeTimeline(timeline);
+	if((entry = composeTimeline(config, rawtime, &header)) == NULL)
+		return -1;
+
+	if(writeTimeline(path, &header, entry) != 0 || openTimeline(timeline, path) != 0) {
+		free(entry);
+		return -1;
+	}
+	free(entry);
+	return 0;
+}
+
+/**
+ * @brief	build a timeline in anonymous memory instead of a file
+ *
+ * Used by processes that serve many users, the timeline is released with
+ * closeTimeline like a mapped file.
+ *
+ * @param[out]	timeline	timeline in memory
+ * @param[in]	config	parsed config
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int memoryTimeline(struct timeline *timeline, struct config *config, time_t rawtime)
+{
+	struct timeline_header header = {0};
+	struct transition *entry = NULL;
+	void *mapping = NULL;
+	size_t size = 0;
+
+	if((entry = composeTimeline(config, rawtime, &header)) == NULL)
+		return -1;
+
+	memcpy(header.magic, TIMELINE_MAGIC, 4);
+	header.version = TIMELINE_VERSION;
+	header.checksum = checksum(entry, header.amount * sizeof(struct transition));
+	size = sizeof(struct timeline_header) + header.amount * sizeof(struct transition);
+	mapping = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(mapping == MAP_FAILED) {
+		free(entry);
+		return -1;
+	}
+	memcpy(mapping, &header, sizeof(struct timeline_header));
+	memcpy((struct timeline_header*)mapping + 1, entry,
+			header.amount * sizeof(struct transition));
+	free(entry);
+
+	timeline->header = mapping;
+	timeline->entry = (struct transition*)(timeline->header + 1);
+	timeline->size = size;
+	timeline->cursor = 0;
+	return 0;
+}
+
+/**
+ * @brief	zone at the given minute
+ *
+ * Steps the cursor forward while the next transition already passed,
+ * falls back to a binary search if the minute lies before the cursor or
+ * far ahead of it.
+ *
+ * @param[in,out]	timeline	mapped timeline
+ * @param[in]	minute	minutes since the epoch
+ *
+ * @retval	index of the active zone
+ * @retval	-1	no zone active or outside of the timeline
+ */
+int lookupTimeline(struct timeline *timeline, int minute)
+{
+	struct transition *entry = timeline->entry;
+	unsigned int amount = 0;
+	unsigned int low = 0;
+	unsigned int high = 0;
+	unsigned int middle = 0;
+
+	if(timeline->header == NULL || minute < timeline->header->start ||
+			minute >= timeline->header->end)
+		return -1;
+
+	amount = timeline->header->amount;
+	if(timeline->cursor < amount && entry[timeline->cursor].minute <= minute) {
+		for(int step = 0 ; step < 4 ; step++) {
+			if(timeline->cursor + 1 >= amount ||
+					entry[timeline->cursor + 1].minute > minute)
+				return entry[timeline->cursor].zone;
+			timeline->cursor++;
+		}
+	}
+
+	low = 0;
+	high = amount;
+	while(high - low > 1) {
+		middle = low + (high - low) / 2;
+		if(entry[middle].minute <= minute)
+			low = middle;
+		else
+			high = middle;
+	}
+	timeline->cursor = low;
+	return entry[low].zone;
+}
+
+/**
+ * @brief	first transition after the given minute
+ *
+ * @param[in,out]	timeline	mapped timeline
+ * @param[in]	minute	minutes since the epoch
+ *
+ * @retval	pointer to the transition
+ * @retval	NULL	no transition left on the horizon
+ */
+struct transition* nextTransition(struct timeline *timeline, int minute)
+{
+	if(timeline->header == NULL || minute >= timeline->header->end)
+		return NULL;
+	if(minute < timeline->header->start)
+		return &timeline->entry[0];
+
+	lookupTimeline(timeline, minute);
+	if(timeline->entry[timeline->cursor].minute > minute)
+		return &timeline->entry[timeline->cursor];
+	if(timeline->cursor + 1 >= timeline->header->amount)
+		return NULL;
+
+	return &timeline->entry[timeline->cursor + 1];
+}
+
+/**
+ * @brief	check for a boundary of the schedule between two points in time
+ *
+ * Without a timeline the zones of the config are compared, a span of a
+ * day or more always contains a boundary.
+ *
+ * @param[in,out]	timeline	mapped timeline (header NULL if unavailable)
+ * @param[in]	config	parsed config
+ * @param[in]	since	earlier unix timestamp
+ * @param[in]	rawtime	current unix timestamp
+ *
+ * @retval	1	a zone started or ended in between
+ * @retval	0	no boundary in between
+ */
+int boundaryPassed(struct timeline *timeline, struct config *config, time_t since,
+		time_t rawtime)
+{
+	struct transition *next = NULL;
+	struct tm before = {0};
+	struct tm now = {0};
+	int minute = 0;
+	int distance = 0;
+
+	if(timeline->header != NULL && (int)(since / 60) >= timeline->header->start) {
+		next = nextTransition(timeline, (int)(since / 60));
+		return next == NULL || next->minute <= (int)(rawtime / 60);
+	}
+	if(rawtime - since >= 24*60*60 || getDate(&before, since) == -1 ||
+			getDate(&now, rawtime) == -1)
+		return 1;
+	minute = before.tm_hour*60 + before.tm_min;
+	if(activeZone(config, minute) != activeZone(config, now.tm_hour*60 + now.tm_min))
+		return 1;
+	if(nextZone(config, minute, &distance) == -1)
+		return 0;
+	return (rawtime - since) / 60 >= distance;
+}
+
+/**
+ * @brief	set the zone and the next transition of the status from the timeline
+ *
+ * In contrast to the plain zone times the timeline respects exclusions.
+ *
+ * @param[in,out]	timeline	mapped timeline
+ * @param[in]	config	parsed config
+ * @param[out]	state	status record
+ * @param[in]	rawtime	current unix timestamp
+ */
+void timelineStatus(struct timeline *timeline, struct config *config,
+		struct status *state, time_t rawtime)
+{
+	struct transition *next = NULL;
+	int minute = (int)(rawtime / 60);
+	int zone = lookupTimeline(timeline, minute);
+
+	memset(state->zone, 0, MAX_FIELD);
+	if(zone != -1)
+		strncpy(state->zone, config->zone_name[zone], MAX_FIELD-1);
+
+	memset(state->next_zone, 0, MAX_FIELD);
+	state->next_transition = 0;
+	if((next = nextTransition(timeline, minute)) != NULL) {
+		if(next->zone != -1)
+			strncpy(state->next_zone, config->zone_name[next->zone], MAX_FIELD-1);
+		state->next_transition = (time_t)next->minute * 60;
+	}
+}
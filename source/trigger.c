@@ -0,0 +1,324 @@
+/**
+ * @file trigger.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	run the commands of the user after a transition (Hook=)
+ *
+ * A Hook= row runs on every transition, a Hook= in the row of a zone on a
+ * transition into that zone. The commands start once the context switch
+ * is committed, from a supervisor process that is detached from the run
+ * (double fork): the run neither waits for the commands nor reaps them, a
+ * slow command never delays a switch or the next tick.
+ *
+ * The supervisor runs at most HOOK_WORKERS commands at the same time and
+ * kills a command (its process group) after HOOK_TIMEOUT seconds. The exit
+ * status and latency of every command are appended to the log next to the
+ * journal (hooks.log). The commands get the transition in the environment:
+ * CSW_ZONE, CSW_FROM and CSW_TO.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/trigger.h"
+
+pid_t launchHook(struct hook_run*, int, sigset_t*);
+void logHook(int, struct hook_run*, int, int, long, int);
+int openLog(char*);
+void detachHooks(void);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+long hookClock(void)
+{
+	struct timespec now = {0};
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	build the path of the hook log next to the journal
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	config_path	location of the config
+ * @param[in]	persistent	1 if the state is kept next to the config
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	no location for the log
+ */
+int hookLogPath(char *path, char *config_path, int persistent)
+{
+	char *separator = NULL;
+
+	if(journalPath(path, config_path, persistent) != 0 ||
+			(separator = strrchr(path, '/')) == NULL)
+		return -1;
+	snprintf(separator + 1, PATH_MAX - (separator + 1 - path), "hooks.log");
+	return 0;
+}
+
+/**
+ * @brief	collect the commands of a transition into a zone
+ *
+ * @param[in]	config	parsed config
+ * @param[in]	zone	index of the new zone, -1 if no zone is active
+ * @param[out]	run	commands with the default limits
+ *
+ * @retval	number of commands
+ */
+int prepareHooks(struct config *config, int zone, struct hook_run *run)
+{
+	memset(run, 0, sizeof(struct hook_run));
+	run->workers = HOOK_WORKERS;
+	run->timeout = HOOK_TIMEOUT;
+	for(int i = 0 ; i < config->hook_amount ; i++)
+		snprintf(run->command[run->amount++], MAX_OPTION, "%s", config->hook[i]);
+	if(zone >= 0 && zone < config->zone_amount) {
+		snprintf(run->zone, MAX_FIELD, "%s", config->zone_name[zone]);
+		if(config->zone_hook[zone][0] != '\0')
+			snprintf(run->command[run->amount++], MAX_OPTION, "%s",
+					config->zone_hook[zone]);
+	}
+	return run->amount;
+}
+
+/**
+ * @brief	start a command in its own process group
+ *
+ * @param[in]	run	commands of the transition
+ * @param[in]	index	index of the command
+ * @param[in]	mask	signal mask of the command
+ *
+ * @retval	pid of the command
+ * @retval	-1	fork failed
+ */
+pid_t launchHook(struct hook_run *run, int index, sigset_t *mask)
+{
+	pid_t pid = fork();
+
+	if(pid != 0)
+		return pid;
+	sigprocmask(SIG_SETMASK, mask, NULL);
+	setpgid(0, 0);
+	setenv("CSW_ZONE", run->zone, 1);
+	setenv("CSW_FROM", run->from, 1);
+	setenv("CSW_TO", run->to, 1);
+	execl("/bin/sh", "sh", "-c", run->command[index], (char*)NULL);
+	_exit(127);
+}
+
+/**
+ * @brief	append the result of a command to the hook log
+ *
+ * @param[in]	fd	hook log (-1 to skip)
+ * @param[in]	run	commands of the transition
+ * @param[in]	index	index of the command
+ * @param[in]	status	wait status, -1 if the command didn't start
+ * @param[in]	elapsed	latency of the command in ns
+ * @param[in]	killed	1 if the command ran into the timeout
+ */
+void logHook(int fd, struct hook_run *run, int index, int status, long elapsed,
+		int killed)
+{
+	char row[MAX_MSG] = {0};
+	char date[MAX_FIELD] = {0};
+	char result[MAX_FIELD] = {0};
+	struct tm datetime = {0};
+	time_t now = time(NULL);
+	int length = 0;
+
+	if(fd == -1)
+		return;
+	gmtime_r(&now, &datetime);
+	strftime(date, MAX_FIELD, "%Y-%m-%dT%H:%M:%SZ", &datetime);
+	if(status == -1)
+		snprintf(result, MAX_FIELD, "status=failed");
+	else if(killed)
+		snprintf(result, MAX_FIELD, "status=timeout");
+	else if(WIFSIGNALED(status))
+		snprintf(result, MAX_FIELD, "status=signal%d", WTERMSIG(status));
+	else
+		snprintf(result, MAX_FIELD, "status=%d", WEXITSTATUS(status));
+	length = snprintf(row, MAX_MSG, "%s to=%s zone=%s %s ms=%.1f command=%s\n", date,
+			run->to, run->zone, result, elapsed / 1000000.0, run->command[index]);
+	if(length >= MAX_MSG)
+		length = MAX_MSG - 1;
+	if(write(fd, row, length) != length)
+		return;
+}
+
+/**
+ * @brief	open the hook log for appending, a full log is rotated
+ *
+ * @param[in]	path	location of the log (empty for no log)
+ *
+ * @retval	file descriptor of the log
+ * @retval	-1	no log
+ */
+int openLog(char *path)
+{
+	char previous[PATH_MAX] = {0};
+	struct stat s;
+
+	if(path[0] == '\0')
+		return -1;
+	if(stat(path, &s) == 0 && s.st_size > HOOK_LOG_MAX) {
+		snprintf(previous, PATH_MAX, "%.*s.1", PATH_MAX - 3, path);
+		rename(path, previous);
+	}
+	return open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+}
+
+/**
+ * @brief	run the commands with the limits of the transition
+ *
+ * Returns once every command finished or was killed.
+ *
+ * @param[in]	run	commands of the transition
+ */
+void superviseHooks(struct hook_run *run)
+{
+	pid_t pid[MAX_HOOKS + 1] = {0};
+	long start[MAX_HOOKS + 1] = {0};
+	int killed[MAX_HOOKS + 1] = {0};
+	long limit = (long)(run->timeout > 0 ? run->timeout : HOOK_TIMEOUT) * 1000000000L;
+	int workers = run->workers > 0 ? run->workers : 1;
+	struct timespec wait = {0};
+	sigset_t mask;
+	sigset_t previous;
+	long deadline = 0;
+	long now = 0;
+	pid_t done = 0;
+	int running = 0;
+	int status = 0;
+	int next = 0;
+	int fd = -1;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &mask, &previous);
+	fd = openLog(run->log);
+
+	while(next < run->amount || running > 0) {
+		for( ; next < run->amount && running < workers ; next++) {
+			start[next] = hookClock();
+			if((pid[next] = launchHook(run, next, &previous)) == -1) {
+				pid[next] = 0;
+				logHook(fd, run, next, -1, 0, 0);
+				continue;
+			}
+			running++;
+		}
+		while((done = waitpid(-1, &status, WNOHANG)) > 0) {
+			for(int i = 0 ; i < next ; i++) {
+				if(pid[i] != done)
+					continue;
+				logHook(fd, run, i, status, hookClock() - start[i], killed[i]);
+				pid[i] = 0;
+				running--;
+			}
+		}
+		if(running == 0)
+			continue;
+
+		/* sleep until a command ends or the earliest timeout */
+		now = hookClock();
+		deadline = now + 1000000000L;
+		for(int i = 0 ; i < next ; i++) {
+			if(pid[i] == 0 || killed[i])
+				continue;
+			if(now - start[i] >= limit) {
+				kill(-pid[i], SIGKILL);
+				killed[i] = 1;
+			} else if(start[i] + limit < deadline) {
+				deadline = start[i] + limit;
+			}
+		}
+		wait.tv_sec = (deadline - now) / 1000000000L;
+		wait.tv_nsec = (deadline - now) % 1000000000L;
+		sigtimedwait(&mask, NULL, &wait);
+	}
+
+	sigprocmask(SIG_SETMASK, &previous, NULL);
+	if(fd != -1)
+		close(fd);
+}
+
+/**
+ * @brief	detach the supervisor from the run
+ *
+ * A new session without the descriptors of the run: the run lock, the
+ * sockets of the daemon and the terminal stay with the run.
+ */
+void detachHooks(void)
+{
+	struct dirent *entry = NULL;
+	struct sigaction action = {0};
+	DIR *directory = NULL;
+	int fd = -1;
+
+	setsid();
+	action.sa_handler = SIG_DFL;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	sigaction(SIGPIPE, &action, NULL);
+
+	if((directory = opendir("/proc/self/fd")) != NULL) {
+		while((entry = readdir(directory)) != NULL) {
+			fd = atoi(entry->d_name);
+			if(fd > 2 && fd != dirfd(directory))
+				close(fd);
+		}
+		closedir(directory);
+	} else {
+		for(fd = 3 ; fd < 1024 ; fd++)
+			close(fd);
+	}
+	if((fd = open("/dev/null", O_RDWR)) != -1) {
+		dup2(fd, STDIN_FILENO);
+		dup2(fd, STDOUT_FILENO);
+		dup2(fd, STDERR_FILENO);
+		if(fd > 2)
+			close(fd);
+	}
+}
+
+/**
+ * @brief	start the commands of a transition in the background
+ *
+ * The supervisor is the grandchild of the run and belongs to init, the run
+ * only waits for the short-lived child in between.
+ *
+ * @param[in]	run	commands of the transition
+ *
+ * @retval	0	SUCCESS, the commands run
+ * @retval	-1	the supervisor couldn't be started
+ */
+int startHooks(struct hook_run *run)
+{
+	pid_t child = 0;
+	int status = 0;
+
+	if(run->amount == 0)
+		return 0;
+	fflush(stdout);
+	fflush(stderr);
+	if((child = fork()) == -1)
+		return -1;
+	if(child == 0) {
+		switch(fork()) {
+			case -1:
+				_exit(EXIT_FAILURE);
+			case 0:
+				break;
+			default:
+				_exit(EXIT_SUCCESS);
+		}
+		detachHooks();
+		superviseHooks(run);
+		_exit(EXIT_SUCCESS);
+	}
+	if(waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+			WEXITSTATUS(status) != EXIT_SUCCESS)
+		return -1;
+	return 0;
+}
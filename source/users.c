@@ -0,0 +1,175 @@
+/**
+ * @file users.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	discover the accounts with a csw config for the multi-user mode
+ *
+ * A single process started by root evaluates the schedule of every user
+ * that has a config at the location used by findConfig. Everything that
+ * touches taskwarrior or files of the user runs with the credentials and
+ * the environment of that user.
+ */
+
+#define _DEFAULT_SOURCE
+#include "include/users.h"
+
+/**
+ * @brief	location of the config of a user, same layout as findConfig
+ *
+ * @param[out]	path	string of length PATH_MAX
+ * @param[in]	home_root	directory containing the home directories
+ * @param[in]	name	login name
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	path too long
+ */
+int userConfig(char *path, char *home_root, char *name)
+{
+	if(snprintf(path, PATH_MAX, "%s/%s/.task/csw/config", home_root, name) >=
+			PATH_MAX)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief	append a password entry to the list
+ *
+ * @param[in,out]	list	list of users
+ * @param[in]	pw	entry of the password database
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	allocation failed or name too long
+ */
+int addUser(struct user_list *list, struct passwd *pw)
+{
+	struct user_entry *grown = NULL;
+	struct user_entry *user = NULL;
+
+	if(strnlen(pw->pw_name, MAX_USER) == MAX_USER)
+		return -1;
+
+	if(list->amount == list->size) {
+		grown = realloc(list->user, (list->size ? list->size*2 : 16) *
+				sizeof(struct user_entry));
+		if(grown == NULL)
+			return -1;
+		list->user = grown;
+		list->size = list->size ? list->size*2 : 16;
+	}
+	user = &list->user[list->amount];
+	memset(user, 0, sizeof(struct user_entry));
+	user->uid = pw->pw_uid;
+	user->gid = pw->pw_gid;
+	strncpy(user->name, pw->pw_name, MAX_USER-1);
+	strncpy(user->home, pw->pw_dir, PATH_MAX-1);
+	list->amount++;
+	return 0;
+}
+
+/**
+ * @brief	collect every account of the password database with a config
+ *
+ * Accounts are listed once, even if the database contains duplicates.
+ * Without root privileges only the calling user can be served.
+ *
+ * @param[out]	list	list of users, release with freeUsers
+ * @param[in]	home_root	directory containing the home directories
+ *
+ * @retval	number of users found
+ * @retval	-1	FAILURE
+ */
+int discoverUsers(struct user_list *list, char *home_root)
+{
+	char path[PATH_MAX] = {0};
+	struct passwd *pw = NULL;
+	struct stat s;
+	int duplicate = 0;
+
+	memset(list, 0, sizeof(struct user_list));
+	setpwent();
+	while((pw = getpwent()) != NULL) {
+		if(geteuid() != 0 && pw->pw_uid != getuid())
+			continue;
+		if(userConfig(path, home_root, pw->pw_name) != 0 ||
+				stat(path, &s) != 0 || !S_ISREG(s.st_mode))
+			continue;
+
+		duplicate = 0;
+		for(int i = 0 ; i < list->amount ; i++) {
+			if(strncmp(list->user[i].name, pw->pw_name, MAX_USER) == 0)
+				duplicate = 1;
+		}
+		if(duplicate)
+			continue;
+
+		if(addUser(list, pw) != 0) {
+			endpwent();
+			freeUsers(list);
+			return -1;
+		}
+	}
+	endpwent();
+	return list->amount;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void freeUsers(struct user_list *list)
+{
+	free(list->user);
+	memset(list, 0, sizeof(struct user_list));
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	replace the environment of root with the one of the user
+ *
+ * taskwarrior and findConfig locate their files through the environment,
+ * overrides of the caller must not leak into the runs of other users.
+ *
+ * @param[in]	user	target user
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE
+ */
+int userEnvironment(struct user_entry *user)
+{
+	char runtime[PATH_MAX] = {0};
+
+	unsetenv("TASKRC");
+	unsetenv("TASKDATA");
+	unsetenv("XDG_RUNTIME_DIR");
+	snprintf(runtime, PATH_MAX, "/run/user/%u", (unsigned int)user->uid);
+	if(access(runtime, W_OK | X_OK) == 0 && setenv("XDG_RUNTIME_DIR", runtime, 1) != 0)
+		return -1;
+
+	if(setenv("HOME", user->home, 1) != 0 || setenv("USER", user->name, 1) != 0 ||
+			setenv("LOGNAME", user->name, 1) != 0)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief	switch the process to the credentials of the user
+ *
+ * Nothing to do if the process already runs as the user.
+ *
+ * @param[in]	user	target user
+ *
+ * @retval	0	SUCCESS
+ * @retval	-1	FAILURE, the process must not continue
+ */
+int dropPrivileges(struct user_entry *user)
+{
+	if(getuid() == user->uid && geteuid() == user->uid)
+		return 0;
+
+	if(initgroups(user->name, user->gid) != 0 || setgid(user->gid) != 0 ||
+			setuid(user->uid) != 0)
+		return -1;
+
+	/* regaining root has to fail */
+	if(user->uid != 0 && setuid(0) == 0)
+		return -1;
+
+	return 0;
+}
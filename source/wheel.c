@@ -0,0 +1,232 @@
+/**
+ * @file wheel.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	hierarchical timer wheel keyed by the minute since the epoch
+ *
+ * Tracks the next transition and the end of the delay for thousands of
+ * users. Insert and cancel are O(1), the daemon only wakes up for the
+ * earliest non-empty slot instead of polling every user on an interval.
+ */
+
+#include "include/wheel.h"
+
+void linkTimer(struct wheel_timer*, struct wheel_timer*);
+void unlinkTimer(struct wheel_timer*);
+void cascadeSlot(struct wheel*, struct wheel_timer*);
+int emptySlot(struct wheel_timer*);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void linkTimer(struct wheel_timer *slot, struct wheel_timer *timer)
+{
+	timer->prev = slot->prev;
+	timer->next = slot;
+	slot->prev->next = timer;
+	slot->prev = timer;
+}
+
+void unlinkTimer(struct wheel_timer *timer)
+{
+	timer->prev->next = timer->next;
+	timer->next->prev = timer->prev;
+	timer->prev = NULL;
+	timer->next = NULL;
+}
+
+int emptySlot(struct wheel_timer *slot)
+{
+	return slot->next == slot;
+}
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+
+/**
+ * @brief	empty every slot of the wheel
+ *
+ * @param[out]	wheel	timer wheel
+ * @param[in]	minute	first minute to process
+ */
+void initWheel(struct wheel *wheel, int minute)
+{
+	for(int i = 0 ; i < WHEEL_MINUTES ; i++)
+		wheel->minute[i].prev = wheel->minute[i].next = &wheel->minute[i];
+	for(int i = 0 ; i < WHEEL_HOURS ; i++)
+		wheel->hour[i].prev = wheel->hour[i].next = &wheel->hour[i];
+	for(int i = 0 ; i < WHEEL_DAYS ; i++)
+		wheel->day[i].prev = wheel->day[i].next = &wheel->day[i];
+	wheel->current = minute;
+	wheel->amount = 0;
+}
+
+/**
+ * @brief	schedule a timer, a scheduled timer is moved
+ *
+ * A timer in the past fires on the next advance.
+ *
+ * @param[in,out]	wheel	timer wheel
+ * @param[in,out]	timer	timer to schedule
+ * @param[in]	expiry	minute since the epoch
+ */
+void addTimer(struct wheel *wheel, struct wheel_timer *timer, int expiry)
+{
+	int distance = 0;
+
+	cancelTimer(wheel, timer);
+	if(expiry < wheel->current)
+		expiry = wheel->current;
+
+	timer->expiry = expiry;
+	distance = expiry - wheel->current;
+	if(distance < WHEEL_MINUTES)
+		linkTimer(&wheel->minute[expiry % WHEEL_MINUTES], timer);
+	else if(distance < WHEEL_HOURS * 60)
+		linkTimer(&wheel->hour[(expiry / 60) % WHEEL_HOURS], timer);
+	else
+		linkTimer(&wheel->day[(expiry / (24*60)) % WHEEL_DAYS], timer);
+	wheel->amount++;
+}
+
+/**
+ * @brief	remove a timer from the wheel, nothing happens if not scheduled
+ *
+ * @param[in,out]	wheel	timer wheel
+ * @param[in,out]	timer	timer to remove
+ */
+void cancelTimer(struct wheel *wheel, struct wheel_timer *timer)
+{
+	if(timer->next == NULL)
+		return;
+
+	unlinkTimer(timer);
+	wheel->amount--;
+}
+
+/**
+ * @brief	move the timers of a slot to the level that fits their distance
+ *
+ * @param[in,out]	wheel	timer wheel
+ * @param[in,out]	slot	hour or day slot whose boundary is reached
+ */
+void cascadeSlot(struct wheel *wheel, struct wheel_timer *slot)
+{
+	struct wheel_timer pending;
+	struct wheel_timer *timer = NULL;
+
+	if(emptySlot(slot))
+		return;
+
+	/* detach the list, a timer may return to the same slot */
+	pending.next = slot->next;
+	pending.prev = slot->prev;
+	pending.next->prev = &pending;
+	pending.prev->next = &pending;
+	slot->next = slot->prev = slot;
+
+	while(!emptySlot(&pending)) {
+		timer = pending.next;
+		unlinkTimer(timer);
+		wheel->amount--;
+		addTimer(wheel, timer, timer->expiry);
+	}
+}
+
+/**
+ * @brief	process every minute up to and including the given minute
+ *
+ * Expired timers are removed from the wheel before the callback, the
+ * callback may schedule them again.
+ *
+ * @param[in,out]	wheel	timer wheel
+ * @param[in]	minute	current minute since the epoch
+ * @param[in]	fire	callback for every expired timer
+ * @param[in]	arg	argument of the callback
+ *
+ * @retval	number of expired timers
+ */
+int advanceWheel(struct wheel *wheel, int minute,
+		void (*fire)(struct wheel_timer*, void*), void *arg)
+{
+	struct wheel_timer *slot = NULL;
+	struct wheel_timer *timer = NULL;
+	struct wheel_timer *next = NULL;
+	struct wheel_timer due;
+	int expired = 0;
+
+	due.prev = due.next = &due;
+
+	while(wheel->current <= minute) {
+		if(wheel->amount == 0) {
+			wheel->current = minute + 1;
+			break;
+		}
+		if(wheel->current % (24*60) == 0)
+			cascadeSlot(wheel, &wheel->day[(wheel->current / (24*60)) % WHEEL_DAYS]);
+		if(wheel->current % 60 == 0)
+			cascadeSlot(wheel, &wheel->hour[(wheel->current / 60) % WHEEL_HOURS]);
+
+		/* collect first, a callback may schedule into the same slot */
+		slot = &wheel->minute[wheel->current % WHEEL_MINUTES];
+		for(timer = slot->next ; timer != slot ; timer = next) {
+			next = timer->next;
+			if(timer->expiry > wheel->current)
+				continue;
+			cancelTimer(wheel, timer);
+			linkTimer(&due, timer);
+		}
+		wheel->current++;
+		while(!emptySlot(&due)) {
+			timer = due.next;
+			unlinkTimer(timer);
+			fire(timer, arg);
+			expired++;
+		}
+	}
+	return expired;
+}
+
+/**
+ * @brief	earliest minute the wheel has to be advanced at
+ *
+ * Either the expiry of the earliest timer on the minute level or the
+ * boundary of the earliest non-empty hour or day slot.
+ *
+ * @param[in]	wheel	timer wheel
+ *
+ * @retval	minute since the epoch
+ * @retval	-1	no timer scheduled
+ */
+int nextExpiry(struct wheel *wheel)
+{
+	int boundary = 0;
+	int earliest = -1;
+
+	if(wheel->amount == 0)
+		return -1;
+
+	for(int i = 0 ; i < WHEEL_MINUTES ; i++) {
+		if(!emptySlot(&wheel->minute[(wheel->current + i) % WHEEL_MINUTES])) {
+			earliest = wheel->current + i;
+			break;
+		}
+	}
+
+	boundary = (wheel->current + 59) / 60 * 60;
+	for(int i = 0 ; i < WHEEL_HOURS ; i++, boundary += 60) {
+		if(earliest != -1 && boundary >= earliest)
+			break;
+		if(!emptySlot(&wheel->hour[(boundary / 60) % WHEEL_HOURS])) {
+			earliest = boundary;
+			break;
+		}
+	}
+
+	boundary = (wheel->current + 24*60 - 1) / (24*60) * (24*60);
+	for(int i = 0 ; i < WHEEL_DAYS ; i++, boundary += 24*60) {
+		if(earliest != -1 && boundary >= earliest)
+			break;
+		if(!emptySlot(&wheel->day[(boundary / (24*60)) % WHEEL_DAYS])) {
+			earliest = boundary;
+			break;
+		}
+	}
+	return earliest;
+}
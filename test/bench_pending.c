@@ -0,0 +1,108 @@
+/**
+ * @file bench_pending.c
+ * @author	Sebastian Fricke
+ * @date	2026-10-19
+ * @brief	benchmark of the active task detection on a large database
+ *
+ * Writes a synthetic data directory with BENCH_TASKS pending tasks, the
+ * only active task is the last one. Measures the scan of pending.data and,
+ * if taskwarrior is installed, the report of task +ACTIVE against the
+ * calls of Database=large.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../source/include/pending.h"
+
+#define BENCH_DIR "/tmp/csw-bench-pending"
+#define BENCH_TASKS 100000
+#define BENCH_ROUNDS 20
+
+int verbose = 0;
+
+double elapsedMs(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000.0 +
+		(now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+int writeTasks(char *path, int amount)
+{
+	FILE *data = fopen(path, "w");
+
+	if(data == NULL)
+		return -1;
+	for(int i = 0 ; i < amount ; i++) {
+		fprintf(data, "[description:\"synthetic task %d\" entry:\"1792300000\" "
+				"modified:\"1792300000\" project:\"bench.p%d\" ", i, i % 50);
+		if(i == amount - 1)
+			fprintf(data, "start:\"1792390000\" ");
+		fprintf(data, "status:\"pending\" uuid:\"%08x-0000-4000-8000-%012x\"]\n",
+				i, i);
+	}
+	return fclose(data);
+}
+
+void benchCommand(char *label, char *command)
+{
+	struct timespec start;
+	char buffer[MAX_ROW] = {0};
+	FILE *process = NULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if((process = popen(command, "r")) == NULL)
+		return;
+	while(fgets(buffer, MAX_ROW, process) != NULL);
+	pclose(process);
+	printf("%-28s %10.3f ms\n", label, elapsedMs(&start));
+}
+
+int main(void)
+{
+	char uuid[STOP_UUIDS][UUID_LEN];
+	char command[MAX_ROW] = {0};
+	struct timespec start;
+	int found = 0;
+
+	mkdir(BENCH_DIR, 0700);
+	if(writeTasks(BENCH_DIR "/pending.data", BENCH_TASKS) != 0) {
+		perror("writing " BENCH_DIR "/pending.data failed");
+		return EXIT_FAILURE;
+	}
+	printf("%d pending tasks, 1 active\n", BENCH_TASKS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int i = 0 ; i < BENCH_ROUNDS ; i++)
+		found = activeTasks(BENCH_DIR, NULL, 1);
+	printf("%-28s %10.3f ms (%d found)\n", "scan, existence",
+			elapsedMs(&start) / BENCH_ROUNDS, found);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int i = 0 ; i < BENCH_ROUNDS ; i++)
+		found = activeTasks(BENCH_DIR, uuid, STOP_UUIDS);
+	printf("%-28s %10.3f ms (%d found)\n", "scan, UUIDs",
+			elapsedMs(&start) / BENCH_ROUNDS, found);
+
+	if(system("command -v task >/dev/null 2>&1") == 0) {
+		benchCommand("task +ACTIVE", "task rc:/dev/null rc.data.location="
+				BENCH_DIR " +ACTIVE 2>&1");
+		snprintf(command, MAX_ROW, "task rc:/dev/null rc.data.location="
+				BENCH_DIR TASK_QUIET " _get rc.context 2>&1");
+		benchCommand("task _get (Database=large)", command);
+	} else {
+		printf("taskwarrior not installed, reports skipped\n");
+	}
+
+	unlink(BENCH_DIR "/pending.data");
+	rmdir(BENCH_DIR);
+	return EXIT_SUCCESS;
+}
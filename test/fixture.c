@@ -0,0 +1,30 @@
+#define _GNU_SOURCE
+#include "../unity/src/unity.h"
+#include <stdio.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "fixture.h"
+
+void writeFixture(char *path, char *content, mode_t mode)
+{
+	FILE *file = fopen(path, "w");
+
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(content, file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, chmod(path, mode));
+}
+
+int removeEntry(const char *path, const struct stat *s, int type, struct FTW *walk)
+{
+	(void)s;
+	(void)type;
+	(void)walk;
+	return remove(path);
+}
+
+void removeFixture(char *path)
+{
+	nftw(path, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
@@ -0,0 +1,9 @@
+#ifndef FIXTURE_H
+#define FIXTURE_H
+
+#include <sys/types.h>
+
+/* files and directories created by the tests */
+void writeFixture(char*, char*, mode_t);
+void removeFixture(char*);
+#endif /* FIXTURE_H */
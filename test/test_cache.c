@@ -0,0 +1,117 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../source/include/cache.h"
+#include "fixture.h"
+
+int verbose = 0;
+char config[PATH_MAX] = {0};
+char cache[PATH_MAX] = {0};
+struct compiled compiled;
+struct cache_header header;
+
+void setUp(void)
+{
+	snprintf(config, PATH_MAX, "/tmp/csw-test-cache-%d", (int)getpid());
+	TEST_ASSERT_EQUAL_INT(0, cachePath(cache, config));
+	writeFixture(config, "[Zones]\n", 0644);
+	memset(&compiled, 0, sizeof(struct compiled));
+	memset(&header, 0, sizeof(struct cache_header));
+	compiled.config.zone_amount = 2;
+	strcpy(compiled.config.zone_name[1], "work");
+	compiled.error.amount = 1;
+	TEST_ASSERT_EQUAL_INT(0, fileKey(config, &header.config));
+}
+
+void tearDown(void)
+{
+	unlink(config);
+	unlink(cache);
+}
+
+void test_cachePath(void)
+{
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, cachePath(path, "/home/user/.task/csw/config"));
+	TEST_ASSERT_EQUAL_STRING("/home/user/.task/csw/config.bin", path);
+	TEST_ASSERT_EQUAL_INT(-1, cachePath(path, ""));
+}
+
+void test_fileKey(void)
+{
+	struct file_key key;
+	struct file_key missing = {0};
+
+	TEST_ASSERT_EQUAL_INT(1, fileKey("/tmp/csw-test-cache-missing", &key));
+	TEST_ASSERT_TRUE(sameKey(&missing, &key));
+	TEST_ASSERT_EQUAL_INT(0, fileKey(config, &key));
+	TEST_ASSERT_TRUE(sameKey(&header.config, &key));
+	TEST_ASSERT_EQUAL_INT(8, key.size);
+
+	writeFixture(config, "[Zones]\nwork=0800-1200\n", 0644);
+	TEST_ASSERT_EQUAL_INT(0, fileKey(config, &key));
+	TEST_ASSERT_FALSE(sameKey(&header.config, &key));
+}
+
+void test_checksum(void)
+{
+	TEST_ASSERT_TRUE(checksum("", 0) == 2166136261u);
+	TEST_ASSERT_TRUE(checksum("a", 1) == 0xe40c292cu);
+	TEST_ASSERT_TRUE(checksum("ab", 2) != checksum("ba", 2));
+}
+
+void test_loadCache(void)
+{
+	struct compiled loaded;
+	struct cache_header expected = header;
+	FILE *file = NULL;
+
+	TEST_ASSERT_EQUAL_INT(1, loadCache(cache, &expected, &loaded));
+	TEST_ASSERT_EQUAL_INT(0, storeCache(cache, &header, &compiled));
+
+	memset(&loaded, 0, sizeof(struct compiled));
+	TEST_ASSERT_EQUAL_INT(0, loadCache(cache, &expected, &loaded));
+	TEST_ASSERT_EQUAL_INT(2, loaded.config.zone_amount);
+	TEST_ASSERT_EQUAL_STRING("work", loaded.config.zone_name[1]);
+	TEST_ASSERT_EQUAL_INT(1, loaded.error.amount);
+
+	/* a changed taskrc invalidates the cache */
+	expected.taskrc.inode = 42;
+	TEST_ASSERT_EQUAL_INT(1, loadCache(cache, &expected, &loaded));
+	expected.taskrc.inode = 0;
+
+	/* so does an edit of the base config */
+	expected.base.mtime = 42;
+	TEST_ASSERT_EQUAL_INT(1, loadCache(cache, &expected, &loaded));
+	expected.base.mtime = 0;
+	TEST_ASSERT_EQUAL_INT(0, loadCache(cache, &expected, &loaded));
+
+	/* a corrupted payload fails the checksum */
+	file = fopen(cache, "r+");
+	TEST_ASSERT_NOT_NULL(file);
+	fseek(file, sizeof(struct cache_header) + 4, SEEK_SET);
+	fputc(0x7f, file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(1, loadCache(cache, &expected, &loaded));
+
+	/* a truncated cache is ignored */
+	TEST_ASSERT_EQUAL_INT(0, truncate(cache, sizeof(struct cache_header)));
+	TEST_ASSERT_EQUAL_INT(1, loadCache(cache, &expected, &loaded));
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_cache.c");
+	RUN_TEST(test_cachePath);
+	RUN_TEST(test_fileKey);
+	RUN_TEST(test_checksum);
+	RUN_TEST(test_loadCache);
+
+	return UnityEnd();
+}
@@ -0,0 +1,95 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef HAVE_SQLITE
+#include <sqlite3.h>
+#endif
+
+#include "../source/include/champion.h"
+
+#define TEST_DIR "/tmp/csw-unity-champion"
+
+int verbose = 0;
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+}
+
+void tearDown(void)
+{
+	unlink(TEST_DIR "/taskchampion.sqlite3");
+	unlink(TEST_DIR "/pending.data");
+	rmdir(TEST_DIR);
+}
+
+#ifdef HAVE_SQLITE
+void createReplica(void)
+{
+	sqlite3 *db = NULL;
+
+	TEST_ASSERT_EQUAL_INT(SQLITE_OK, sqlite3_open(TEST_DIR "/taskchampion.sqlite3", &db));
+	TEST_ASSERT_EQUAL_INT(SQLITE_OK, sqlite3_exec(db,
+				"CREATE TABLE tasks (uuid STRING PRIMARY KEY, data STRING);"
+				"CREATE TABLE working_set (id INTEGER PRIMARY KEY, uuid STRING);"
+				"INSERT INTO tasks VALUES ('a1', '{\"status\":\"pending\",\"description\":\"plan\"}');"
+				"INSERT INTO tasks VALUES ('a2', '{\"status\":\"pending\",\"start\":\"1792390000\"}');"
+				"INSERT INTO tasks VALUES ('a3', '{\"status\":\"completed\",\"start\":\"1792390000\"}');"
+				"INSERT INTO tasks VALUES ('a4', '{\"status\":\"pending\",\"start\":\"1792391000\"}');"
+				"INSERT INTO working_set VALUES (1, 'a1'), (2, 'a2'), (3, 'a4');",
+				NULL, NULL, NULL));
+	sqlite3_close(db);
+}
+#endif /* HAVE_SQLITE */
+
+void test_taskBackend(void)
+{
+	FILE *file = NULL;
+
+	TEST_ASSERT_EQUAL_INT(BACKEND_TASK, taskBackend(TEST_DIR));
+	file = fopen(TEST_DIR "/pending.data", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(BACKEND_PENDING, taskBackend(TEST_DIR));
+
+	/* a replica wins over a leftover pending.data */
+	file = fopen(TEST_DIR "/taskchampion.sqlite3", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+#ifdef HAVE_SQLITE
+	TEST_ASSERT_EQUAL_INT(BACKEND_CHAMPION, taskBackend(TEST_DIR));
+#else
+	TEST_ASSERT_EQUAL_INT(BACKEND_TASK, taskBackend(TEST_DIR));
+#endif /* HAVE_SQLITE */
+}
+
+void test_championActive(void)
+{
+#ifdef HAVE_SQLITE
+	char uuid[4][UUID_LEN];
+
+	memset(uuid, 0, sizeof(uuid));
+	TEST_ASSERT_EQUAL_INT(-1, championActive(TEST_DIR, NULL, 1));
+	createReplica();
+	TEST_ASSERT_EQUAL_INT(2, championActive(TEST_DIR, uuid, 4));
+	TEST_ASSERT_TRUE(strcmp(uuid[0], "a2") == 0 || strcmp(uuid[1], "a2") == 0);
+	TEST_ASSERT_TRUE(strcmp(uuid[0], "a4") == 0 || strcmp(uuid[1], "a4") == 0);
+	TEST_ASSERT_EQUAL_INT(1, championActive(TEST_DIR, NULL, 1));
+#else
+	TEST_ASSERT_EQUAL_INT(-1, championActive(TEST_DIR, NULL, 1));
+#endif /* HAVE_SQLITE */
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_champion.c");
+	RUN_TEST(test_taskBackend);
+	RUN_TEST(test_championActive);
+
+	return UnityEnd();
+}
@@ -1065,136 +1065,6 @@ void test_checkExclusion(void)
 	}
 }
 
-#define WRITE_TEST 9
-void test_writeConfig(void)
-{
-	char expected_content[WRITE_TEST][MAX_ROW] = {
-		"Zone=Test1;Start=09:00;End=11:00;Context=work\n",
-		"Zone=Test2;Start=11:00;End=13:00;Context=study\n",
-		"Zone=Test3;Start=13:00;End=15:00;Context=freetime\n",
-		"Exclude=permanent(su,mo,tu)\n",
-		"Exclude=temporary(2019-11-20#2019-12-03)\n",
-		"Delay=2019-12-05T15:00Z\n",
-		"Cancel=on\n",
-		"Notify=off\n",
-		"Interval=10min\n"
-	};
-	char content[WRITE_TEST][MAX_ROW] = {{0}};
-	int result = 0;
-	int expect = 0;
-	struct config test_config = {
-		.zone_amount = 3,
-		.zone_name = {"Test1", "Test2", "Test3"},
-		.ztime = {
-			{
-			.start_hour=9,.start_minute=0,.end_hour=11,.end_minute=0
-			},
-			{
-			.start_hour=11,.start_minute=0,.end_hour=13,.end_minute=0
-			},
-			{
-			.start_hour=13,.start_minute=0,.end_hour=15,.end_minute=0
-			}
-		},
-		.zone_context={"work", "study", "freetime"},
-		.excl = {
-			.amount = 2,
-			.type_name = {"perm", "temp"},
-			.type = {
-				{
-					.weekdays = {1,2,3},
-					.single_days = {{0}},
-					.holiday_start={0},
-					.holiday_end={0},
-					.list_len=3,
-					.sub_type={"list"}
-				},
-				{
-					.weekdays = {0},
-					.single_days = {{0}},
-					.holiday_start={.tm_year=2019-1900,.tm_mon=11-1,.tm_mday=20,
-					.tm_hour=0, .tm_min=0, .tm_sec=0, .tm_isdst=0},
-					.holiday_end={.tm_year=2019-1900,.tm_mon=12-1,.tm_mday=3,
-					.tm_hour=0, .tm_min=0, .tm_sec=0, .tm_isdst=0},
-					.list_len=0,
-					.sub_type={"range"}
-				}
-			}
-		},
-		.delay = {
-			.tm_year=2019-1900,.tm_mon=12-1,.tm_mday=5,
-			.tm_hour=15, .tm_min=0, .tm_sec=0, .tm_isdst=0
-		},
-		.cancel = 1,
-		.notify = 0,
-		.interval = 10
-	};
-
-	// set path
-	int fd = 0;
-	FILE *read_file = NULL;
-	int index = 0;
-	int write_size = 0;
-	int test_len = 0;
-	char write_buffer[4][MAX_ROW] = {{0}};
-	char *username = NULL;
-	char pathname[22] = {"/.task/csw/.write_test"};
-	char config_path[PATH_MAX] = {0};
-	int size_user = 0;
-	char msg[MAX_MSG+35] = {0};
-
-	username = getenv("USER");
-	if(!username)
-		return;
-
-	size_user = strlen(username);
-
-	strncpy(config_path, "/home/", PATH_MAX);
-	strncat(config_path, username, size_user);
-	strncat(config_path, pathname, 22);
-
-	if(dirExist(config_path) != 1) {
-		// create file
-		strncpy(write_buffer[0],
-				"Zone=Test2;Start=08:00;End=08:30;Context=study",MAX_ROW);
-		strncpy(write_buffer[1],"Exclude=temporary(2019-09-12)",MAX_ROW);
-		strncpy(write_buffer[2],"Delay=2019-09-13T15:30Z",MAX_ROW);
-		strncpy(write_buffer[3],"Cancel=off",MAX_ROW);
-		fd = open(config_path, O_RDWR|O_CREAT, 0777);
-		if(fd < 0)
-			perror("file creation failed");
-
-		for(int i = 0 ; i < 4 ; i++) {
-			test_len = strnlen(write_buffer[i], MAX_ROW);
-			write_size = write(fd, write_buffer[i], test_len);
-			if(write_size < 1)
-				perror("write failed");
-		}
-		if(close(fd) < 0) {
-			perror("file closing failed");
-			return;
-		}
-	}
-	// use function
-	result = writeConfig(&test_config, config_path);
-	// read content
-	read_file = fopen(config_path, "r");
-	if(!read_file)
-		return;
-
-	while(fgets(content[index], MAX_ROW, read_file) != NULL) {
-		index++;
-	}
-	// compare content
-	for(int i = 0 ; i < WRITE_TEST ; i++) {
-		snprintf(msg, MAX_MSG+35, "%d. read row expect: %s was: %s",
-				i, expected_content[i], content[i]);
-		TEST_ASSERT_EQUAL_STRING_MESSAGE(expected_content[i], content[i], msg);
-	}
-	TEST_ASSERT_EQUAL_INT_MESSAGE(expect, result, "result didn't match");
-	fclose(read_file);
-}
-
 #define CONF_TEST 4
 #define MSG_LEN 1100
 void test_parseConfig(void)
@@ -1736,7 +1606,7 @@ void test_parseConfig(void)
 	}
 }
 
-#define KEY_TEST 12
+#define KEY_TEST 13
 void test_valueForKey(void)
 {
 	struct keyvalue lookuptable[VALID_OPTIONS] = {
@@ -1748,16 +1618,17 @@ void test_valueForKey(void)
 		{"cancel", FIND_CANCEL},
 		{"notify", FIND_NOTIFY},
 		{"interval", FIND_INTERVAL},
-		{"exclude", FIND_EXCLUDE}
+		{"exclude", FIND_EXCLUDE},
+		{"state", FIND_STATE}
 	};
 
 	char test_key[KEY_TEST][MAX_OPTION_NAME] = {
 		"zone", "start", "end", "context",
 		"delay", "cancel", "notify", "interval",
-		"exclude", "rubbish", "", "123"
+		"exclude", "state", "rubbish", "", "123"
 	};
 	int result[KEY_TEST] = {0};
-	int expect[KEY_TEST] = {0, 1, 2, 3, 4, 5, 6, 7, 8, -1, -1, -1};
+	int expect[KEY_TEST] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1, -1};
 
 	for(int i = 0 ; i < KEY_TEST ; i++) {
 		result[i] = valueForKey(&lookuptable[0], test_key[i]);
@@ -1779,7 +1650,6 @@ int main(void)
 	RUN_TEST(test_indexInList);
 	RUN_TEST(test_syncConfig);
 	RUN_TEST(test_checkExclusion);
-	RUN_TEST(test_writeConfig);
 	RUN_TEST(test_valueForKey);
 
 	return UnityEnd();
@@ -0,0 +1,143 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+
+#include "../source/include/control.h"
+
+int verbose = 0;
+char runtime_dir[PATH_MAX] = {0};
+
+void setUp(void)
+{
+	snprintf(runtime_dir, PATH_MAX, "/tmp/csw-test-control-%d", (int)getpid());
+	setenv("XDG_RUNTIME_DIR", runtime_dir, 1);
+	mkdir(runtime_dir, 0700);
+}
+
+void tearDown(void)
+{
+	char path[PATH_MAX+4] = {0};
+
+	snprintf(path, PATH_MAX+4, "%s/csw", runtime_dir);
+	rmdir(path);
+	rmdir(runtime_dir);
+}
+
+#define PARSE_TEST 8
+void test_parseControl(void)
+{
+	char line[PARSE_TEST][MAX_ROW] = {
+		{"delay 30min"}, {"cancel 1;notify 0"}, {"interval 5"}, {"switch"},
+		{"delay 1h;cancel 0;notify 1;interval 3;switch\r"}, {"cancel 2"},
+		{"restart"}, {"interval abc"}
+	};
+	int expected[PARSE_TEST] = {0, 0, 0, 0, 0, -1, -1, -1};
+	int exp_delay[PARSE_TEST] = {30, 0, 0, 0, 60, 0, 0, 0};
+	int exp_cancel[PARSE_TEST] = {-1, 1, -1, -1, 0, -1, -1, -1};
+	int exp_notify[PARSE_TEST] = {-1, 0, -1, -1, 1, -1, -1, -1};
+	int exp_interval[PARSE_TEST] = {-1, -1, 5, -1, 3, -1, -1, -1};
+	int exp_switch[PARSE_TEST] = {0, 0, 0, 1, 1, 0, 0, 0};
+	struct flags flag = {0};
+
+	for(int i = 0 ; i < PARSE_TEST ; i++) {
+		memset(&flag, 0, sizeof(struct flags));
+		flag.cancel_on = -1;
+		flag.notify_on = -1;
+		flag.cron_interval = -1;
+		TEST_ASSERT_EQUAL_INT(expected[i], parseControl(line[i], &flag));
+		TEST_ASSERT_EQUAL_INT(exp_delay[i], flag.delay);
+		TEST_ASSERT_EQUAL_INT(exp_cancel[i], flag.cancel_on);
+		TEST_ASSERT_EQUAL_INT(exp_notify[i], flag.notify_on);
+		TEST_ASSERT_EQUAL_INT(exp_interval[i], flag.cron_interval);
+		TEST_ASSERT_EQUAL_INT(exp_switch[i], flag.switch_now);
+	}
+}
+
+void test_buildControl(void)
+{
+	struct flags flag = {
+		.delay = 45, .cancel_on = 1, .notify_on = -1, .cron_interval = 2,
+		.switch_now = 1
+	};
+	struct flags empty = {.cancel_on = -1, .notify_on = -1, .cron_interval = -1};
+	char line[MAX_ROW] = {0};
+
+	TEST_ASSERT_EQUAL_INT(4, buildControl(&flag, line));
+	TEST_ASSERT_EQUAL_STRING("delay 45;cancel 1;interval 2;switch\n", line);
+	TEST_ASSERT_EQUAL_INT(0, buildControl(&empty, line));
+	TEST_ASSERT_EQUAL_STRING("", line);
+}
+
+void test_handleControl(void)
+{
+	struct control_server server;
+	struct sockaddr_un address = {0};
+	struct flags request = {.cancel_on = -1, .notify_on = -1, .cron_interval = -1};
+	char path[PATH_MAX] = {0};
+	char answer[MAX_ROW] = {0};
+	int epoll = epoll_create1(0);
+	int client = socket(AF_UNIX, SOCK_STREAM, 0);
+	int index = -1;
+
+	TEST_ASSERT_EQUAL_INT(0, controlPath(path));
+	TEST_ASSERT_EQUAL_INT(0, openControl(&server, epoll, path));
+
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path)-1);
+	TEST_ASSERT_EQUAL_INT(0, connect(client, (struct sockaddr*)&address,
+				sizeof(address)));
+	TEST_ASSERT_EQUAL_INT(CONTROL_HANDLED, handleControl(&server, server.fd,
+				EPOLLIN, &request, &index));
+
+	/* a partial line waits for the rest of the request */
+	TEST_ASSERT_EQUAL_INT(8, write(client, "cancel 1", 8));
+	TEST_ASSERT_EQUAL_INT(CONTROL_HANDLED, handleControl(&server,
+				server.client[0].fd, EPOLLIN, &request, &index));
+	TEST_ASSERT_EQUAL_INT(11, write(client, ";delay 15\n", 11));
+	TEST_ASSERT_EQUAL_INT(CONTROL_REQUEST, handleControl(&server,
+				server.client[0].fd, EPOLLIN, &request, &index));
+	TEST_ASSERT_EQUAL_INT(0, index);
+	TEST_ASSERT_EQUAL_INT(1, request.cancel_on);
+	TEST_ASSERT_EQUAL_INT(15, request.delay);
+
+	replyControl(&server, index, 0);
+	TEST_ASSERT_EQUAL_INT(3, read(client, answer, MAX_ROW));
+	TEST_ASSERT_EQUAL_STRING("ok\n", answer);
+	TEST_ASSERT_EQUAL_INT(-1, server.client[0].fd);
+	TEST_ASSERT_EQUAL_INT(CONTROL_IGNORED, handleControl(&server, 12345,
+				EPOLLIN, &request, &index));
+
+	close(client);
+	closeControl(&server);
+	close(epoll);
+}
+
+void test_sendControl(void)
+{
+	struct flags flag = {.delay = 30, .cancel_on = -1, .notify_on = -1,
+		.cron_interval = -1};
+	struct flags empty = {.cancel_on = -1, .notify_on = -1, .cron_interval = -1};
+	char response[MAX_ROW] = {0};
+
+	/* without a listening daemon the request is executed locally */
+	TEST_ASSERT_EQUAL_INT(1, sendControl(&flag, response));
+	TEST_ASSERT_EQUAL_INT(1, sendControl(&empty, response));
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_control.c");
+	RUN_TEST(test_parseControl);
+	RUN_TEST(test_buildControl);
+	RUN_TEST(test_handleControl);
+	RUN_TEST(test_sendControl);
+
+	return UnityEnd();
+}
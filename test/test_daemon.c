@@ -0,0 +1,69 @@
+#include "../unity/src/unity.h"
+#include <string.h>
+
+#include "../source/include/daemon.h"
+
+#define START (29000000 / 1440 * 1440)
+
+int verbose = 0;
+struct wheel wheel;
+struct user_job job[3];
+int held[3] = {0};
+
+void setUp(void)
+{
+	initWheel(&wheel, START);
+	memset(job, 0, sizeof(job));
+	for(int i = 0 ; i < 3 ; i++)
+		job[i].timer[TIMER_TRANSITION].owner = i;
+}
+
+void tearDown(void)
+{
+
+}
+
+void test_requestInTimerBatch(void)
+{
+	addTimer(&wheel, &job[1].timer[TIMER_TRANSITION], START + 1);
+	addTimer(&wheel, &job[2].timer[TIMER_TRANSITION], START + 30);
+
+	/* the timer of user 1 and a request of user 0 in one epoll batch */
+	TEST_ASSERT_EQUAL_INT(1, advanceWheel(&wheel, START + 2, markDue, job));
+	TEST_ASSERT_EQUAL_INT(1, job[1].due);
+	isolateJob(job, 3, 0, held);
+	TEST_ASSERT_EQUAL_INT(1, job[0].due);
+	TEST_ASSERT_EQUAL_INT(0, job[1].due);
+	TEST_ASSERT_EQUAL_INT(0, job[2].due);
+
+	/* user 1 left the wheel, it still has to run and be rescheduled */
+	restoreJobs(job, 3, 0, held);
+	TEST_ASSERT_EQUAL_INT(0, job[0].due);
+	TEST_ASSERT_EQUAL_INT(1, job[1].due);
+	TEST_ASSERT_EQUAL_INT(0, job[2].due);
+	TEST_ASSERT_EQUAL_INT(1, wheel.amount);
+}
+
+void test_requestOfDueUser(void)
+{
+	/* the request reschedules its own user */
+	job[0].due = 1;
+	job[2].due = 1;
+	isolateJob(job, 3, 0, held);
+	TEST_ASSERT_EQUAL_INT(1, job[0].due);
+	TEST_ASSERT_EQUAL_INT(0, job[2].due);
+	restoreJobs(job, 3, 0, held);
+	TEST_ASSERT_EQUAL_INT(0, job[0].due);
+	TEST_ASSERT_EQUAL_INT(0, job[1].due);
+	TEST_ASSERT_EQUAL_INT(1, job[2].due);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_daemon.c");
+	RUN_TEST(test_requestInTimerBatch);
+	RUN_TEST(test_requestOfDueUser);
+
+	return UnityEnd();
+}
@@ -0,0 +1,114 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../source/include/deadline.h"
+
+#define JOBS 64
+#define WORKERS 4
+
+int verbose = 0;
+int order[JOBS];
+int finished = 0;
+int running = 0;
+int peak = 0;
+long started[JOBS];
+pthread_mutex_t counter_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void setUp(void)
+{
+	finished = 0;
+	running = 0;
+	peak = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void recordJob(void *arg)
+{
+	int index = (int)(long)arg;
+
+	pthread_mutex_lock(&counter_lock);
+	started[index] = realtimeMs();
+	if(++running > peak)
+		peak = running;
+	pthread_mutex_unlock(&counter_lock);
+	usleep(2000);
+	pthread_mutex_lock(&counter_lock);
+	running--;
+	order[finished++] = index;
+	pthread_mutex_unlock(&counter_lock);
+}
+
+void test_heapOrder(void)
+{
+	struct deadline_queue queue = {0};
+	struct deadline_entry entry = {0};
+	long deadline[] = {500, 100, 300, 100, 900, 200};
+
+	for(int i = 0 ; i < 6 ; i++) {
+		entry.deadline = deadline[i];
+		entry.release = 6 - i;
+		TEST_ASSERT_EQUAL_INT(0, pushDeadline(&queue, &entry));
+	}
+	TEST_ASSERT_EQUAL_INT(6, queue.depth);
+
+	/* equal deadlines are ordered by the release */
+	TEST_ASSERT_EQUAL_INT(0, popDeadline(&queue, &entry));
+	TEST_ASSERT_TRUE(entry.deadline == 100 && entry.release == 3);
+	TEST_ASSERT_EQUAL_INT(0, popDeadline(&queue, &entry));
+	TEST_ASSERT_TRUE(entry.deadline == 100 && entry.release == 5);
+	for(long last = 100 ; popDeadline(&queue, &entry) == 0 ; last = entry.deadline)
+		TEST_ASSERT_TRUE(entry.deadline >= last);
+	TEST_ASSERT_EQUAL_INT(0, queue.amount);
+	free(queue.heap);
+}
+
+void test_queueCap(void)
+{
+	struct deadline_queue queue;
+	long now = realtimeMs();
+
+	TEST_ASSERT_EQUAL_INT(0, queueCreate(&queue, WORKERS));
+	for(long i = 0 ; i < JOBS ; i++)
+		TEST_ASSERT_EQUAL_INT(0, queueSubmit(&queue, now + i, now, recordJob, (void*)i));
+	queueWait(&queue);
+
+	TEST_ASSERT_EQUAL_INT(JOBS, finished);
+	TEST_ASSERT_TRUE(peak <= WORKERS);
+	TEST_ASSERT_TRUE(queue.depth > WORKERS);
+	queueStop(&queue);
+}
+
+void test_queueRelease(void)
+{
+	struct deadline_queue queue;
+	long now = realtimeMs();
+
+	TEST_ASSERT_EQUAL_INT(0, queueCreate(&queue, WORKERS));
+	/* the earlier deadline waits for its release, the released job runs first */
+	TEST_ASSERT_EQUAL_INT(0, queueSubmit(&queue, now + 100, now + 150, recordJob, (void*)0));
+	TEST_ASSERT_EQUAL_INT(0, queueSubmit(&queue, now + 200, now, recordJob, (void*)1));
+	queueWait(&queue);
+	queueStop(&queue);
+
+	TEST_ASSERT_EQUAL_INT(2, finished);
+	TEST_ASSERT_TRUE(started[0] >= now + 150);
+	TEST_ASSERT_TRUE(started[1] < started[0]);
+	TEST_ASSERT_EQUAL_INT(1, order[0]);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_deadline.c");
+	RUN_TEST(test_heapOrder);
+	RUN_TEST(test_queueCap);
+	RUN_TEST(test_queueRelease);
+
+	return UnityEnd();
+}
@@ -0,0 +1,147 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../source/include/enforce.h"
+
+#define TEST_DIR "/tmp/csw-unity-enforce"
+
+int verbose = 0;
+
+char *pending =
+	"[description:\"report\" entry:\"1792300000\" modified:\"1792390000\" "
+	"project:\"work.reports\" start:\"1792390000\" status:\"pending\" tags:\"office,writing\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a01\"]\n"
+	"[description:\"read\" entry:\"1792300000\" modified:\"1792391000\" "
+	"start:\"1792391000\" status:\"pending\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a02\"]\n";
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+}
+
+void tearDown(void)
+{
+	unlink(TEST_DIR "/pending.data");
+	unlink(TEST_DIR "/taskrc");
+	rmdir(TEST_DIR);
+	unsetenv("TASKDATA");
+	unsetenv("TASKRC");
+}
+
+void test_pendingTasks(void)
+{
+	struct active_task task[2];
+
+	memset(task, 0, sizeof(task));
+	TEST_ASSERT_EQUAL_INT(2, pendingTasks(pending, strlen(pending), task, 2));
+	TEST_ASSERT_EQUAL_STRING("0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a01", task[0].uuid);
+	TEST_ASSERT_EQUAL_STRING("work.reports", task[0].project);
+	TEST_ASSERT_EQUAL_STRING("office,writing", task[0].tags);
+	TEST_ASSERT_TRUE(task[0].modified == 1792390000);
+	TEST_ASSERT_EQUAL_STRING("", task[1].project);
+	TEST_ASSERT_EQUAL_STRING("", task[1].tags);
+}
+
+void test_filterMatch(void)
+{
+	struct active_task task = {.project = "work.reports", .tags = "office,writing"};
+
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("", &task));
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("project:work", &task));
+	/* project: is a left match, project.is: an exact one */
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("project:wor", &task));
+	TEST_ASSERT_EQUAL_INT(0, filterMatch("project.is:work", &task));
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("project.is:work.reports", &task));
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("pro:work.reports +office", &task));
+	TEST_ASSERT_EQUAL_INT(0, filterMatch("project:work and -writing", &task));
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("project:home or +office", &task));
+	TEST_ASSERT_EQUAL_INT(0, filterMatch("project:home or +off", &task));
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("project:'work'", &task));
+	/* unsupported terms never stop a task */
+	TEST_ASSERT_EQUAL_INT(-1, filterMatch("(project:work or +office)", &task));
+	TEST_ASSERT_EQUAL_INT(-1, filterMatch("due.before:tomorrow", &task));
+	TEST_ASSERT_EQUAL_INT(-1, filterMatch("project:work +READY", &task));
+	TEST_ASSERT_EQUAL_INT(-1, filterMatch("-OVERDUE", &task));
+}
+
+void test_filterPrefix(void)
+{
+	struct active_task task = {.project = "Homework"};
+
+	/* taskwarrior counts Homework as inside a context of project:Home */
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("project:Home", &task));
+	TEST_ASSERT_EQUAL_INT(1, filterMatch("pro:Home", &task));
+	TEST_ASSERT_EQUAL_INT(0, filterMatch("project.is:Home", &task));
+	TEST_ASSERT_EQUAL_INT(0, filterMatch("project:Work", &task));
+	TEST_ASSERT_EQUAL_INT(0, filterMatch("project:", &task));
+}
+
+void test_contextFilter(void)
+{
+	char filter[MAX_FILTER] = {0};
+	FILE *file = NULL;
+
+	setenv("TASKRC", TEST_DIR "/taskrc", 1);
+	TEST_ASSERT_EQUAL_INT(-1, contextFilter("work", filter));
+
+	file = fopen(TEST_DIR "/taskrc", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("context.home=project:home\n"
+			"context.work.read=project:work or +office\n"
+			"context.work.write=project:work\n", file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, contextFilter("work", filter));
+	TEST_ASSERT_EQUAL_STRING("project:work or +office", filter);
+	TEST_ASSERT_EQUAL_INT(0, contextFilter("home", filter));
+	TEST_ASSERT_EQUAL_STRING("project:home", filter);
+	TEST_ASSERT_EQUAL_INT(-1, contextFilter("study", filter));
+}
+
+void test_watchTasks(void)
+{
+	struct task_watch watch;
+	FILE *file = NULL;
+
+	setenv("TASKDATA", TEST_DIR, 1);
+	setenv("TASKRC", TEST_DIR "/taskrc", 1);
+	file = fopen(TEST_DIR "/pending.data", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(pending, file);
+	fclose(file);
+
+	TEST_ASSERT_EQUAL_INT(0, watchTasks(&watch));
+	TEST_ASSERT_EQUAL_INT(2, watch.amount);
+	TEST_ASSERT_EQUAL_INT(0, tasksChanged(&watch));
+
+	file = fopen(TEST_DIR "/taskrc", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, tasksChanged(&watch));
+
+	file = fopen(TEST_DIR "/pending.data", "a");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(1, tasksChanged(&watch));
+	/* the tasks are unchanged, nothing is stopped */
+	TEST_ASSERT_EQUAL_INT(0, enforceContext(&watch, "work"));
+	closeWatch(&watch);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_enforce.c");
+	RUN_TEST(test_pendingTasks);
+	RUN_TEST(test_filterMatch);
+	RUN_TEST(test_filterPrefix);
+	RUN_TEST(test_contextFilter);
+	RUN_TEST(test_watchTasks);
+
+	return UnityEnd();
+}
@@ -0,0 +1,97 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+
+#include "../source/include/event.h"
+
+char socket_path[PATH_MAX] = {0};
+struct event_server server;
+int epoll = -1;
+
+void setUp(void)
+{
+	snprintf(socket_path, PATH_MAX, "/tmp/csw-test-events-%d", (int)getpid());
+	epoll = epoll_create1(0);
+	openEvents(&server, epoll, socket_path);
+}
+
+void tearDown(void)
+{
+	closeEvents(&server);
+	close(epoll);
+}
+
+int connectClient(void)
+{
+	struct sockaddr_un address = {0};
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, socket_path, sizeof(address.sun_path)-1);
+	if(connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+		close(fd);
+		return -1;
+	}
+	handleEvents(&server, server.fd, EPOLLIN);
+	return fd;
+}
+
+void test_emitEvent(void)
+{
+	char buffer[MAX_EVENT] = {0};
+	char *details = NULL;
+	int client = connectClient();
+
+	TEST_ASSERT_EQUAL_INT(1, client != -1);
+	TEST_ASSERT_EQUAL_INT(client != -1, server.client[0].fd != -1);
+
+	emitEvent(&server, "transition", "zone=%s from=%s to=%s", "Work",
+			"study", "work");
+	TEST_ASSERT_EQUAL_INT(0, server.client[0].length);
+	TEST_ASSERT_EQUAL_INT(1, read(client, buffer, MAX_EVENT-1) > 0);
+	details = strchr(buffer, ' ');
+	TEST_ASSERT_EQUAL_STRING(" transition zone=Work from=study to=work\n",
+			details);
+
+	emitEvent(NULL, "error", "code=%d", -1);
+	TEST_ASSERT_EQUAL_INT(-1, handleEvents(&server, 12345, EPOLLIN));
+	close(client);
+}
+
+void test_dropSlowSubscriber(void)
+{
+	int slow = connectClient();
+	int fast = connectClient();
+	char buffer[SUBSCRIBER_BUFFER] = {0};
+
+	TEST_ASSERT_EQUAL_INT(1, slow != -1 && fast != -1);
+	for(int i = 0 ; i < 20000 && server.dropped == 0 ; i++) {
+		emitEvent(&server, "delay", "until=%d", i);
+		while(read(fast, buffer, SUBSCRIBER_BUFFER) == SUBSCRIBER_BUFFER);
+		handleEvents(&server, server.client[1].fd, EPOLLOUT);
+	}
+	TEST_ASSERT_EQUAL_INT(1, server.dropped);
+	TEST_ASSERT_EQUAL_INT(-1, server.client[0].fd);
+	TEST_ASSERT_EQUAL_INT(1, server.client[1].fd != -1);
+
+	/* a hang up frees the slot */
+	handleEvents(&server, server.client[1].fd, EPOLLHUP);
+	TEST_ASSERT_EQUAL_INT(-1, server.client[1].fd);
+	close(slow);
+	close(fast);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_event.c");
+	RUN_TEST(test_emitEvent);
+	RUN_TEST(test_dropSlowSubscriber);
+
+	return UnityEnd();
+}
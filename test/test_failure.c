@@ -0,0 +1,127 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../source/include/failure.h"
+
+#define TEST_DIR "/tmp/csw-unity-failure"
+
+int verbose = 0;
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+}
+
+void tearDown(void)
+{
+	unlink(TEST_DIR "/failure");
+	rmdir(TEST_DIR);
+}
+
+void test_failurePath(void)
+{
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, failurePath(path, TEST_DIR "/config", 1));
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/failure", path);
+}
+
+void test_backoffDelay(void)
+{
+	time_t delay = 0;
+
+	for(unsigned int seed = 0 ; seed < 100 ; seed++) {
+		delay = backoffDelay(1, seed);
+		TEST_ASSERT_TRUE(delay >= BACKOFF_BASE * 3 / 4 && delay <= BACKOFF_BASE);
+		delay = backoffDelay(3, seed);
+		TEST_ASSERT_TRUE(delay >= BACKOFF_BASE * 3 && delay <= BACKOFF_BASE * 4);
+		delay = backoffDelay(40, seed);
+		TEST_ASSERT_TRUE(delay >= BACKOFF_MAX * 3 / 4 && delay <= BACKOFF_MAX);
+	}
+}
+
+void test_recordFailure(void)
+{
+	struct failure_state failure = {0};
+	time_t now = 1792390000;
+
+	TEST_ASSERT_EQUAL_INT(0, backedOff(&failure, "work", now));
+	TEST_ASSERT_EQUAL_INT(1, recordFailure(&failure, "work", SEND_UNKNOWN, now));
+	TEST_ASSERT_EQUAL_INT(1, failure.count);
+	TEST_ASSERT_EQUAL_INT(1, backedOff(&failure, "work", now + 1));
+	/* another target is attempted at once */
+	TEST_ASSERT_EQUAL_INT(0, backedOff(&failure, "home", now + 1));
+	TEST_ASSERT_EQUAL_INT(0, backedOff(&failure, "work", failure.retry));
+
+	/* the same failure is reported once */
+	TEST_ASSERT_EQUAL_INT(0, recordFailure(&failure, "work", SEND_UNKNOWN, now + 60));
+	TEST_ASSERT_EQUAL_INT(2, failure.count);
+	TEST_ASSERT_TRUE(failure.retry >= now + 60 + BACKOFF_BASE * 3 / 2);
+	TEST_ASSERT_EQUAL_INT(1, recordFailure(&failure, "work", SEND_MISSING, now + 180));
+	TEST_ASSERT_EQUAL_INT(3, failure.count);
+	TEST_ASSERT_EQUAL_INT(1, recordFailure(&failure, "home", SEND_MISSING, now + 180));
+	TEST_ASSERT_EQUAL_INT(1, failure.count);
+
+	clearFailure(&failure);
+	TEST_ASSERT_EQUAL_INT(0, backedOff(&failure, "home", now + 181));
+}
+
+void test_storeFailure(void)
+{
+	struct failure_state failure = {0};
+	struct failure_state stored = {0};
+	struct stat s;
+
+	TEST_ASSERT_EQUAL_INT(0, loadFailure(TEST_DIR "/failure", &stored));
+	TEST_ASSERT_EQUAL_INT(0, stored.count);
+
+	recordFailure(&failure, "work", SEND_LOCKED, 1792390000);
+	failure.notified = 42;
+	TEST_ASSERT_EQUAL_INT(0, storeFailure(TEST_DIR "/failure", &failure));
+	TEST_ASSERT_EQUAL_INT(0, loadFailure(TEST_DIR "/failure", &stored));
+	TEST_ASSERT_EQUAL_STRING("work", stored.context);
+	TEST_ASSERT_EQUAL_INT(SEND_LOCKED, stored.reason);
+	TEST_ASSERT_EQUAL_INT(1, stored.count);
+	TEST_ASSERT_TRUE(stored.retry == failure.retry);
+	TEST_ASSERT_TRUE(stored.notified == 42);
+
+	/* an empty state removes the file */
+	clearFailure(&failure);
+	failure.notified = 0;
+	TEST_ASSERT_EQUAL_INT(0, storeFailure(TEST_DIR "/failure", &failure));
+	TEST_ASSERT_EQUAL_INT(-1, stat(TEST_DIR "/failure", &s));
+}
+
+void test_newErrors(void)
+{
+	struct failure_state failure = {0};
+	struct error error = {.amount = 1, .rowindex = {3}, .error_code = {-2},
+		.error_msg = {"invalid zone"}};
+	struct error none = {0};
+
+	TEST_ASSERT_EQUAL_INT(1, newErrors(&failure, &error));
+	TEST_ASSERT_EQUAL_INT(0, newErrors(&failure, &error));
+	error.rowindex[0] = 4;
+	TEST_ASSERT_EQUAL_INT(1, newErrors(&failure, &error));
+	TEST_ASSERT_EQUAL_INT(0, newErrors(&failure, &none));
+	TEST_ASSERT_TRUE(failure.notified == 0);
+	TEST_ASSERT_EQUAL_INT(1, newErrors(&failure, &error));
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_failure.c");
+	RUN_TEST(test_failurePath);
+	RUN_TEST(test_backoffDelay);
+	RUN_TEST(test_recordFailure);
+	RUN_TEST(test_storeFailure);
+	RUN_TEST(test_newErrors);
+
+	return UnityEnd();
+}
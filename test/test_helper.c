@@ -337,6 +337,19 @@ void test_multiplierForType(void)
 }
 
 
+void test_percentile(void)
+{
+	long values[10] = {9, 3, 7, 1, 5, 10, 2, 8, 4, 6};
+	long single[1] = {42};
+
+	TEST_ASSERT_EQUAL_INT(10, percentile(values, 10, 99));
+	TEST_ASSERT_EQUAL_INT(5, percentile(values, 10, 50));
+	TEST_ASSERT_EQUAL_INT(1, percentile(values, 10, 1));
+	TEST_ASSERT_EQUAL_INT(1, values[0]);
+	TEST_ASSERT_EQUAL_INT(42, percentile(single, 1, 99));
+	TEST_ASSERT_EQUAL_INT(0, percentile(NULL, 0, 99));
+}
+
 /*=======MAIN=====*/
 int main(void)
 {
@@ -348,6 +361,7 @@ int main(void)
 	RUN_TEST(test_compareTime);
 	RUN_TEST(test_multiplierForType);
 	RUN_TEST(test_parseTimeSpan);
+	RUN_TEST(test_percentile);
 
 	return UnityEnd();
 }
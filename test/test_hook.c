@@ -0,0 +1,122 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../source/include/hook.h"
+#include "fixture.h"
+
+#define TEST_DIR "/tmp/csw-unity-hook"
+
+int verbose = 0;
+
+char *taskrc =
+	"# taskrc\n"
+	"context.work=project:work\n"
+	"context = study # old\n"
+	"context.study=project:study";
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+	mkdir(TEST_DIR "/state", 0700);
+	setenv("XDG_RUNTIME_DIR", TEST_DIR "/state", 1);
+}
+
+void tearDown(void)
+{
+	removeFixture(TEST_DIR);
+	unsetenv("XDG_RUNTIME_DIR");
+}
+
+void test_replaceContext(void)
+{
+	char result[MAX_ROW] = {0};
+	FILE *out = fmemopen(result, MAX_ROW, "w");
+
+	TEST_ASSERT_NOT_NULL(out);
+	TEST_ASSERT_EQUAL_INT(0, replaceContext(taskrc, strlen(taskrc), "work", out));
+	fclose(out);
+	TEST_ASSERT_EQUAL_STRING("# taskrc\ncontext.work=project:work\n"
+			"context.study=project:study\ncontext=work\n", result);
+
+	memset(result, 0, MAX_ROW);
+	out = fmemopen(result, MAX_ROW, "w");
+	TEST_ASSERT_NOT_NULL(out);
+	TEST_ASSERT_EQUAL_INT(0, replaceContext(taskrc, strlen(taskrc), "none", out));
+	fclose(out);
+	TEST_ASSERT_EQUAL_STRING("# taskrc\ncontext.work=project:work\n"
+			"context.study=project:study\n", result);
+}
+
+void test_writeContext(void)
+{
+	char value[MAX_FIELD] = {0};
+	struct file_key key = {0};
+	struct stat s;
+	FILE *file = NULL;
+
+	TEST_ASSERT_EQUAL_INT(-1, writeContext(TEST_DIR "/missing", &key, taskrc,
+				strlen(taskrc), "work"));
+
+	file = fopen(TEST_DIR "/taskrc", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(taskrc, file);
+	fclose(file);
+	chmod(TEST_DIR "/taskrc", 0640);
+	TEST_ASSERT_EQUAL_INT(0, symlink(TEST_DIR "/taskrc", TEST_DIR "/link"));
+
+	/* a taskrc edited since the read is kept */
+	TEST_ASSERT_EQUAL_INT(-1, writeContext(TEST_DIR "/link", &key, taskrc,
+				strlen(taskrc), "work"));
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(TEST_DIR "/link", "context", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("study", value);
+
+	TEST_ASSERT_EQUAL_INT(0, fileKey(TEST_DIR "/link", &key));
+	TEST_ASSERT_EQUAL_INT(0, writeContext(TEST_DIR "/link", &key, taskrc,
+				strlen(taskrc), "work"));
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(TEST_DIR "/link", "context", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("work", value);
+	/* the link and the permissions are kept */
+	TEST_ASSERT_EQUAL_INT(0, lstat(TEST_DIR "/link", &s));
+	TEST_ASSERT_TRUE(S_ISLNK(s.st_mode));
+	TEST_ASSERT_EQUAL_INT(0, stat(TEST_DIR "/taskrc", &s));
+	TEST_ASSERT_TRUE((s.st_mode & 07777) == 0640);
+}
+
+void test_scheduledZone(void)
+{
+	struct config config = {
+		.zone_name = {{"Work"}},
+		.zone_context = {{"work"}},
+		.ztime = {{.start_hour = 0, .start_minute = 0, .end_hour = 23, .end_minute = 59}},
+		.zone_amount = 1
+	};
+	struct config delayed;
+	FILE *file = NULL;
+	time_t now = time(NULL);
+
+	/* no timeline next to the config, the zones are evaluated directly */
+	TEST_ASSERT_EQUAL_INT(0, scheduledZone(&config, TEST_DIR "/config", now));
+
+	delayed = config;
+	file = fopen(TEST_DIR "/state/csw/state", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fprintf(file, "Delay=2100-01-01T00:00Z\n");
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(-1, scheduledZone(&delayed, TEST_DIR "/config", now));
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_hook.c");
+	RUN_TEST(test_replaceContext);
+	RUN_TEST(test_writeContext);
+	RUN_TEST(test_scheduledZone);
+
+	return UnityEnd();
+}
@@ -0,0 +1,124 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../source/include/journal.h"
+
+int verbose = 0;
+char journal[PATH_MAX] = {0};
+
+void setUp(void)
+{
+	snprintf(journal, PATH_MAX, "/tmp/csw-test-journal-%d", (int)getpid());
+	unlink(journal);
+}
+
+void tearDown(void)
+{
+	unlink(journal);
+}
+
+void test_journalPath(void)
+{
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, journalPath(path, "/home/user/.task/csw/config", 1));
+	TEST_ASSERT_EQUAL_STRING("/home/user/.task/csw/state", path);
+	TEST_ASSERT_EQUAL_INT(-1, journalPath(path, "config", 1));
+
+	setenv("XDG_RUNTIME_DIR", "/tmp", 1);
+	TEST_ASSERT_EQUAL_INT(0, journalPath(path, "/home/user/.task/csw/config", 0));
+	TEST_ASSERT_EQUAL_STRING("/tmp/csw/state", path);
+}
+
+#define RECORD_TEST 7
+void test_applyRecord(void)
+{
+	char record[RECORD_TEST][MAX_ROW] = {
+		{"Cancel=on"}, {"Notify=on"}, {"Interval=5min"},
+		{"Delay=2020-12-24T18:30Z"}, {"Zone=Work"}, {"Delay=tomorrow"},
+		{"Notify=off"}
+	};
+	int expected[RECORD_TEST] = {0, 0, 0, 0, -1, -1, 0};
+	struct config config = {0};
+
+	for(int i = 0 ; i < RECORD_TEST ; i++)
+		TEST_ASSERT_EQUAL_INT(expected[i], applyRecord(&config, record[i]));
+
+	TEST_ASSERT_EQUAL_INT(1, config.cancel);
+	TEST_ASSERT_EQUAL_INT(0, config.notify);
+	TEST_ASSERT_EQUAL_INT(5, config.interval);
+	TEST_ASSERT_EQUAL_INT(2020-1900, config.delay.tm_year);
+	TEST_ASSERT_EQUAL_INT(18, config.delay.tm_hour);
+
+	TEST_ASSERT_EQUAL_INT(0, applyRecord(&config, "Delay=none"));
+	TEST_ASSERT_EQUAL_INT(0, config.delay.tm_year);
+
+	TEST_ASSERT_EQUAL_INT(0, applyRecord(&config, "Applied=work@1792390000"));
+	TEST_ASSERT_EQUAL_STRING("work", config.applied);
+	TEST_ASSERT_TRUE(config.applied_at == 1792390000);
+	TEST_ASSERT_EQUAL_INT(-1, applyRecord(&config, "Applied=work"));
+}
+
+void test_buildRecords(void)
+{
+	struct config before = {.cancel = 0, .notify = 1, .interval = 1};
+	struct config after = {.cancel = 1, .notify = 1, .interval = 3,
+		.delay = {.tm_year = 2020-1900, .tm_mon = 12-1, .tm_mday = 24,
+			.tm_hour = 18, .tm_min = 30}};
+	char records[MAX_ROW*4] = {0};
+
+	TEST_ASSERT_EQUAL_INT(3, buildRecords(&before, &after, records));
+	TEST_ASSERT_EQUAL_STRING("Delay=2020-12-24T18:30Z\nCancel=on\nInterval=3min\n",
+			records);
+	TEST_ASSERT_EQUAL_INT(0, buildRecords(&after, &after, records));
+	TEST_ASSERT_EQUAL_INT(4, buildRecords(NULL, &before, records));
+	TEST_ASSERT_EQUAL_STRING("Delay=none\nCancel=off\nNotify=on\nInterval=1min\n",
+			records);
+
+	strcpy(after.applied, "study");
+	after.applied_at = 1792390000;
+	TEST_ASSERT_EQUAL_INT(4, buildRecords(&before, &after, records));
+	TEST_ASSERT_EQUAL_STRING("Delay=2020-12-24T18:30Z\nCancel=on\nInterval=3min\n"
+			"Applied=study@1792390000\n", records);
+}
+
+void test_replayJournal(void)
+{
+	struct config before = {.cancel = 0, .notify = 0, .interval = 1};
+	struct config after = before;
+	struct config replay = before;
+
+	TEST_ASSERT_EQUAL_INT(0, replayJournal(&replay, journal));
+
+	for(int i = 0 ; i < JOURNAL_COMPACT + 1 ; i++) {
+		after.cancel = !before.cancel;
+		after.interval = i + 2;
+		TEST_ASSERT_EQUAL_INT(2, journalChanges(journal, &before, &after));
+		before = after;
+	}
+	TEST_ASSERT_EQUAL_INT(2*(JOURNAL_COMPACT+1), replayJournal(&replay, journal));
+	TEST_ASSERT_EQUAL_INT(after.cancel, replay.cancel);
+	TEST_ASSERT_EQUAL_INT(JOURNAL_COMPACT + 2, replay.interval);
+
+	TEST_ASSERT_EQUAL_INT(0, compactJournal(journal, &replay));
+	memset(&replay, 0, sizeof(struct config));
+	TEST_ASSERT_EQUAL_INT(4, replayJournal(&replay, journal));
+	TEST_ASSERT_EQUAL_INT(after.cancel, replay.cancel);
+	TEST_ASSERT_EQUAL_INT(JOURNAL_COMPACT + 2, replay.interval);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_journal.c");
+	RUN_TEST(test_journalPath);
+	RUN_TEST(test_applyRecord);
+	RUN_TEST(test_buildRecords);
+	RUN_TEST(test_replayJournal);
+
+	return UnityEnd();
+}
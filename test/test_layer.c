@@ -0,0 +1,222 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../source/include/layer.h"
+
+int verbose = 0;
+char path[PATH_MAX] = {0};
+char cache[PATH_MAX] = {0};
+struct config base;
+
+void setUp(void)
+{
+	snprintf(path, PATH_MAX, "/tmp/csw-test-layer-%d", (int)getpid());
+	TEST_ASSERT_EQUAL_INT(0, cachePath(cache, path));
+
+	memset(&base, 0, sizeof(struct config));
+	base.zone_amount = 2;
+	strcpy(base.zone_name[0], "Core");
+	strcpy(base.zone_context[0], "work");
+	base.ztime[0] = (struct zonetime){9, 0, 12, 0};
+	strcpy(base.zone_name[1], "Late");
+	strcpy(base.zone_context[1], "study");
+	base.ztime[1] = (struct zonetime){13, 0, 17, 0};
+	base.excl.amount = 1;
+	strcpy(base.excl.type_name[0], "temp");
+	base.cancel = 1;
+	base.interval = 15;
+}
+
+void tearDown(void)
+{
+	unlink(path);
+	unlink(cache);
+}
+
+void test_loadBase(void)
+{
+	struct base_layer layer;
+	FILE *file = NULL;
+
+	TEST_ASSERT_EQUAL_INT(1, loadBase(path, &layer));
+
+	file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("Zone=Core;Start=09:00;End=12:00;Context=work\n"
+			"Zone=Late;Start=13:00;End=17:00;Context=study\n"
+			"Cancel=on\n\n", file);
+	fclose(file);
+
+	TEST_ASSERT_EQUAL_INT(0, loadBase(path, &layer));
+	TEST_ASSERT_EQUAL_INT(2, layer.compiled.config.zone_amount);
+	TEST_ASSERT_EQUAL_STRING("Late", layer.compiled.config.zone_name[1]);
+	TEST_ASSERT_EQUAL_STRING("study", layer.compiled.config.zone_context[1]);
+	TEST_ASSERT_EQUAL_INT(1, layer.compiled.config.cancel);
+	TEST_ASSERT_EQUAL_INT(0, access(cache, R_OK));
+
+	/* the second load is served by the cache */
+	TEST_ASSERT_EQUAL_INT(0, loadBase(path, &layer));
+	TEST_ASSERT_EQUAL_INT(2, layer.compiled.config.zone_amount);
+}
+
+void test_mergeConfig(void)
+{
+	struct config diff;
+	struct config merged;
+	struct error error = {0};
+
+	emptyLayer(&diff);
+	diff.zone_amount = 2;
+	strcpy(diff.zone_name[0], "Late");
+	strcpy(diff.zone_context[0], "study");
+	diff.ztime[0] = (struct zonetime){14, 0, 18, 0};
+	strcpy(diff.zone_name[1], "Evening");
+	strcpy(diff.zone_context[1], "freetime");
+	diff.ztime[1] = (struct zonetime){19, 0, 21, 0};
+	diff.excl.amount = 1;
+	strcpy(diff.excl.type_name[0], "perm");
+	diff.notify = 1;
+
+	TEST_ASSERT_EQUAL_INT(0, mergeConfig(&base, &diff, NULL, &merged, &error));
+	TEST_ASSERT_EQUAL_INT(0, error.amount);
+	TEST_ASSERT_EQUAL_INT(3, merged.zone_amount);
+	TEST_ASSERT_EQUAL_STRING("Core", merged.zone_name[0]);
+	TEST_ASSERT_EQUAL_STRING("Late", merged.zone_name[1]);
+	TEST_ASSERT_EQUAL_INT(14, merged.ztime[1].start_hour);
+	TEST_ASSERT_EQUAL_STRING("Evening", merged.zone_name[2]);
+	TEST_ASSERT_EQUAL_STRING("freetime", merged.zone_context[2]);
+	TEST_ASSERT_EQUAL_INT(2, merged.excl.amount);
+	TEST_ASSERT_EQUAL_STRING("perm", merged.excl.type_name[1]);
+	TEST_ASSERT_EQUAL_INT(1, merged.cancel);
+	TEST_ASSERT_EQUAL_INT(1, merged.notify);
+	TEST_ASSERT_EQUAL_INT(15, merged.interval);
+}
+
+void test_mergeConfigLimits(void)
+{
+	struct context context = {.name = {"work"}, .amount = 1};
+	struct config diff;
+	struct config merged;
+	struct error error = {0};
+
+	emptyLayer(&diff);
+	diff.zone_amount = MAX_ZONES - 1;
+	for(int i = 0 ; i < diff.zone_amount ; i++) {
+		snprintf(diff.zone_name[i], MAX_FIELD, "Zone%d", i);
+		strcpy(diff.zone_context[i], "work");
+	}
+
+	/* one zone doesn't fit, the unknown context of the base is cleared */
+	TEST_ASSERT_EQUAL_INT(1, mergeConfig(&base, &diff, &context, &merged, &error));
+	TEST_ASSERT_EQUAL_INT(MAX_ZONES, merged.zone_amount);
+	TEST_ASSERT_EQUAL_INT(2, error.amount);
+	TEST_ASSERT_EQUAL_INT(-9, error.error_code[0]);
+	TEST_ASSERT_EQUAL_INT(-5, error.error_code[1]);
+	TEST_ASSERT_EQUAL_STRING("work", merged.zone_context[0]);
+	TEST_ASSERT_EQUAL_STRING("", merged.zone_context[1]);
+}
+
+void test_hooks(void)
+{
+	struct base_layer layer;
+	struct config diff;
+	struct config merged;
+	struct error error = {0};
+	FILE *file = NULL;
+
+	file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("Zone=Core;Start=09:00;End=12:00;Context=work;Hook=mute\n"
+			"Zone=Late;Start=13:00;End=17:00;Context=study;Hook=unmute\n"
+			"Hook=timew stop\n"
+			"hook=notify-send \"zone $CSW_ZONE\"; logger -t csw to=$CSW_TO\n"
+			"Cancel=on\n\n", file);
+	fclose(file);
+
+	TEST_ASSERT_EQUAL_INT(0, loadBase(path, &layer));
+	TEST_ASSERT_EQUAL_INT(2, layer.compiled.config.zone_amount);
+	TEST_ASSERT_EQUAL_STRING("mute", layer.compiled.config.zone_hook[0]);
+	TEST_ASSERT_EQUAL_STRING("unmute", layer.compiled.config.zone_hook[1]);
+	TEST_ASSERT_EQUAL_INT(2, layer.compiled.config.hook_amount);
+	TEST_ASSERT_EQUAL_STRING("timew stop", layer.compiled.config.hook[0]);
+	/* the command runs until the end of the row */
+	TEST_ASSERT_EQUAL_STRING("notify-send \"zone $CSW_ZONE\"; logger -t csw to=$CSW_TO",
+			layer.compiled.config.hook[1]);
+
+	/* the hooks of the base are never run for a user */
+	emptyLayer(&diff);
+	diff.zone_amount = 1;
+	strcpy(diff.zone_name[0], "Late");
+	strcpy(diff.zone_context[0], "study");
+	strcpy(diff.zone_hook[0], "wallpaper");
+	TEST_ASSERT_EQUAL_INT(0, mergeConfig(&layer.compiled.config, &diff, NULL, &merged,
+				&error));
+	TEST_ASSERT_EQUAL_STRING("", merged.zone_hook[0]);
+	TEST_ASSERT_EQUAL_STRING("wallpaper", merged.zone_hook[1]);
+	TEST_ASSERT_EQUAL_INT(0, merged.hook_amount);
+
+	/* the limit of a row doesn't apply to the command of its hook */
+	file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fprintf(file, "Zone=Core;Start=09:00;End=12:00;Context=work;Hook=%0100d\n"
+			"Hook=%0130d\n", 0, 0);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, loadBase(path, &layer));
+	TEST_ASSERT_EQUAL_INT(100, strlen(layer.compiled.config.zone_hook[0]));
+	TEST_ASSERT_EQUAL_INT(0, layer.compiled.config.hook_amount);
+	TEST_ASSERT_EQUAL_INT(1, layer.compiled.error.amount);
+	TEST_ASSERT_EQUAL_INT(-13, layer.compiled.error.error_code[0]);
+}
+
+void test_rowLimit(void)
+{
+	struct base_layer layer;
+	FILE *file = NULL;
+	int dropped = 0;
+
+	/* every kind of row at its limit, the last row beyond it */
+	file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	for(int i = 0 ; i < MAX_ZONES ; i++)
+		fprintf(file, "Zone=Z%d;Start=%02d:00;End=%02d:30;Context=work\n", i, i + 1,
+				i + 1);
+	for(int i = 0 ; i < MAX_EXCLUSION ; i++)
+		fprintf(file, "Exclude=temporary(2030-01-%02d)\n", i + 1);
+	fputs("Cancel=on\nNotify=on\nInterval=5min\nState=persistent\n"
+			"Database=large\n", file);
+	for(int i = 0 ; i < MAX_PROFILES ; i++)
+		fprintf(file, "Profile=/tmp/taskrc-%d\n", i);
+	for(int i = 0 ; i < MAX_HOOKS ; i++)
+		fprintf(file, "Hook=hook-%d\n", i);
+	fputs("Hook=too-many\nHook=dropped\n", file);
+	fclose(file);
+
+	TEST_ASSERT_EQUAL_INT(0, loadBase(path, &layer));
+	TEST_ASSERT_EQUAL_INT(MAX_ZONES, layer.compiled.config.zone_amount);
+	TEST_ASSERT_EQUAL_INT(MAX_PROFILES, layer.compiled.config.profile_amount);
+	TEST_ASSERT_EQUAL_INT(MAX_HOOKS, layer.compiled.config.hook_amount);
+	TEST_ASSERT_EQUAL_STRING("hook-3", layer.compiled.config.hook[MAX_HOOKS - 1]);
+	/* the fifth hook is read and rejected, the last row is dropped */
+	for(int i = 0 ; i < layer.compiled.error.amount ; i++)
+		dropped += layer.compiled.error.error_code[i] == -12;
+	TEST_ASSERT_EQUAL_INT(2, layer.compiled.error.amount);
+	TEST_ASSERT_EQUAL_INT(-11, layer.compiled.error.error_code[1]);
+	TEST_ASSERT_EQUAL_INT(1, dropped);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_layer.c");
+	RUN_TEST(test_loadBase);
+	RUN_TEST(test_mergeConfig);
+	RUN_TEST(test_mergeConfigLimits);
+	RUN_TEST(test_hooks);
+	RUN_TEST(test_rowLimit);
+
+	return UnityEnd();
+}
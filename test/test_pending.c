@@ -0,0 +1,138 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../source/include/pending.h"
+
+#define TEST_DIR "/tmp/csw-unity-pending"
+
+int verbose = 0;
+
+char *pending =
+	"[description:\"write report\" entry:\"1792300000\" status:\"pending\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a01\"]\n"
+	"[description:\"restart:&dquot;now&dquot;\" entry:\"1792300000\" status:\"pending\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a02\"]\n"
+	"[description:\"review\" entry:\"1792300000\" start:\"1792390000\" status:\"completed\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a03\"]\n"
+	"[description:\"call\" entry:\"1792300000\" start:\"1792390000\" status:\"pending\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a04\"]\n"
+	"[description:\"plan\" entry:\"1792300000\" start:\"1792391000\" status:\"pending\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a05\"]";
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+}
+
+void tearDown(void)
+{
+	unlink(TEST_DIR "/pending.data");
+	unlink(TEST_DIR "/taskrc");
+	rmdir(TEST_DIR);
+	unsetenv("TASKDATA");
+	unsetenv("TASKRC");
+}
+
+void test_pendingActive(void)
+{
+	char uuid[4][UUID_LEN];
+
+	memset(uuid, 0, sizeof(uuid));
+	/* only started tasks with the status pending, the last line without newline */
+	TEST_ASSERT_EQUAL_INT(2, pendingActive(pending, strlen(pending), uuid, 4));
+	TEST_ASSERT_EQUAL_STRING("0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a04", uuid[0]);
+	TEST_ASSERT_EQUAL_STRING("0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a05", uuid[1]);
+
+	TEST_ASSERT_EQUAL_INT(1, pendingActive(pending, strlen(pending), NULL, 1));
+	TEST_ASSERT_EQUAL_INT(0, pendingActive(pending, 0, NULL, 1));
+	/* the first two lines have no start attribute */
+	TEST_ASSERT_EQUAL_INT(0, pendingActive(pending, strchr(strchr(pending, '\n') + 1,
+					'\n') - pending, NULL, 1));
+}
+
+void test_activeTasks(void)
+{
+	char uuid[1][UUID_LEN] = {{0}};
+	FILE *file = NULL;
+
+	TEST_ASSERT_EQUAL_INT(-1, activeTasks(TEST_DIR, NULL, 1));
+	file = fopen(TEST_DIR "/pending.data", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, activeTasks(TEST_DIR, NULL, 1));
+
+	file = fopen(TEST_DIR "/pending.data", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(pending, file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(1, activeTasks(TEST_DIR, uuid, 1));
+	TEST_ASSERT_EQUAL_STRING("0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a04", uuid[0]);
+}
+
+void test_activeTasksRewrite(void)
+{
+	FILE *file = NULL;
+	pid_t writer = 0;
+	int found = 0;
+
+	file = fopen(TEST_DIR "/pending.data", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+	/* taskwarrior commits by truncating and rewriting pending.data in place */
+	writer = fork();
+	TEST_ASSERT_TRUE(writer != -1);
+	if(writer == 0) {
+		for(int i = 0 ; i < 500 ; i++) {
+			if((file = fopen(TEST_DIR "/pending.data", "w")) == NULL)
+				_exit(EXIT_FAILURE);
+			for(int line = 0 ; line < 200 ; line++)
+				fprintf(file, "%s\n", pending);
+			fclose(file);
+		}
+		_exit(EXIT_SUCCESS);
+	}
+	while(waitpid(writer, NULL, WNOHANG) == 0) {
+		found = activeTasks(TEST_DIR, NULL, 400);
+		TEST_ASSERT_TRUE(found >= 0 && found <= 400);
+	}
+}
+
+void test_dataLocation(void)
+{
+	char path[PATH_MAX] = {0};
+	FILE *file = NULL;
+
+	setenv("HOME", "/home/tester", 1);
+	setenv("TASKRC", TEST_DIR "/taskrc", 1);
+	TEST_ASSERT_EQUAL_INT(0, dataLocation(path));
+	TEST_ASSERT_EQUAL_STRING("/home/tester/.task", path);
+
+	file = fopen(TEST_DIR "/taskrc", "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("data.location=~/tasks # synced\n", file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, dataLocation(path));
+	TEST_ASSERT_EQUAL_STRING("/home/tester/tasks", path);
+
+	setenv("TASKDATA", "/srv/task", 1);
+	TEST_ASSERT_EQUAL_INT(0, dataLocation(path));
+	TEST_ASSERT_EQUAL_STRING("/srv/task", path);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_pending.c");
+	RUN_TEST(test_pendingActive);
+	RUN_TEST(test_activeTasks);
+	RUN_TEST(test_activeTasksRewrite);
+	RUN_TEST(test_dataLocation);
+
+	return UnityEnd();
+}
@@ -0,0 +1,113 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../source/include/pool.h"
+
+#define JOBS 1000
+
+int verbose = 0;
+int counter = 0;
+pthread_mutex_t counter_lock = PTHREAD_MUTEX_INITIALIZER;
+struct pool nested;
+
+void setUp(void)
+{
+	counter = 0;
+}
+
+void tearDown(void)
+{
+
+}
+
+void countJob(void *arg)
+{
+	int *slot = arg;
+
+	(*slot)++;
+	pthread_mutex_lock(&counter_lock);
+	counter++;
+	pthread_mutex_unlock(&counter_lock);
+}
+
+void slowJob(void *arg)
+{
+	usleep(1000);
+	countJob(arg);
+}
+
+void forwardJob(void *arg)
+{
+	TEST_ASSERT_EQUAL_INT(0, poolSubmit(&nested, slowJob, arg));
+}
+
+void test_deque(void)
+{
+	struct deque deque = {0};
+	struct job job = {0};
+	int value[POOL_QUEUE + 2] = {0};
+
+	TEST_ASSERT_EQUAL_INT(-1, popJob(&deque, &job));
+	for(int i = 0 ; i < POOL_QUEUE + 2 ; i++) {
+		job.arg = &value[i];
+		TEST_ASSERT_EQUAL_INT(0, pushJob(&deque, &job));
+	}
+	TEST_ASSERT_EQUAL_INT(POOL_QUEUE * 2, deque.capacity);
+
+	/* the owner takes the newest, a thief the oldest job */
+	TEST_ASSERT_EQUAL_INT(0, popJob(&deque, &job));
+	TEST_ASSERT_TRUE(job.arg == &value[POOL_QUEUE + 1]);
+	TEST_ASSERT_EQUAL_INT(0, stealJob(&deque, &job));
+	TEST_ASSERT_TRUE(job.arg == &value[0]);
+	TEST_ASSERT_EQUAL_INT(POOL_QUEUE, deque.amount);
+	free(deque.job);
+}
+
+void test_poolSubmit(void)
+{
+	struct pool pool;
+	int slot[JOBS] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, poolCreate(&pool, 4, 0));
+	TEST_ASSERT_EQUAL_INT(4, pool.workers);
+	for(int i = 0 ; i < JOBS ; i++)
+		TEST_ASSERT_EQUAL_INT(0, poolSubmit(&pool, countJob, &slot[i]));
+	poolWait(&pool);
+	TEST_ASSERT_EQUAL_INT(JOBS, counter);
+	for(int i = 0 ; i < JOBS ; i++)
+		TEST_ASSERT_EQUAL_INT(1, slot[i]);
+	poolStop(&pool);
+	TEST_ASSERT_NULL(pool.thread);
+}
+
+void test_poolLimit(void)
+{
+	struct pool pool;
+	int slot[64] = {0};
+
+	/* evaluation jobs hand over to a bounded pool and block at its limit */
+	TEST_ASSERT_EQUAL_INT(0, poolCreate(&pool, 4, 0));
+	TEST_ASSERT_EQUAL_INT(0, poolCreate(&nested, 2, 4));
+	for(int i = 0 ; i < 64 ; i++)
+		TEST_ASSERT_EQUAL_INT(0, poolSubmit(&pool, forwardJob, &slot[i]));
+	poolWait(&pool);
+	TEST_ASSERT_TRUE(nested.pending <= 4);
+	poolWait(&nested);
+	TEST_ASSERT_EQUAL_INT(64, counter);
+	poolStop(&pool);
+	poolStop(&nested);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_pool.c");
+	RUN_TEST(test_deque);
+	RUN_TEST(test_poolSubmit);
+	RUN_TEST(test_poolLimit);
+
+	return UnityEnd();
+}
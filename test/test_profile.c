@@ -0,0 +1,120 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../source/include/profile.h"
+#include "fixture.h"
+
+#define TEST_DIR "/tmp/csw-unity-profile"
+
+int verbose = 0;
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+	writeFixture(TEST_DIR "/taskrc", "context=home\n", 0600);
+	writeFixture(TEST_DIR "/taskrc-work", "data.location=" TEST_DIR "/work\ncontext=work\n", 0600);
+	writeFixture(TEST_DIR "/taskrc-personal", "data.location=~/personal\n", 0600);
+	setenv("TASKRC", TEST_DIR "/taskrc", 1);
+	setenv("TASKDATA", TEST_DIR "/default", 1);
+	setenv("HOME", TEST_DIR, 1);
+}
+
+void tearDown(void)
+{
+	removeFixture(TEST_DIR);
+	unsetenv("TASKRC");
+	unsetenv("TASKDATA");
+}
+
+void test_profileActions(void)
+{
+	struct config config = {.profile = {TEST_DIR "/taskrc-work", "~/taskrc-personal"},
+		.profile_amount = 2, .cancel = 1};
+	struct profile_action action[MAX_PROFILES+1];
+
+	TEST_ASSERT_EQUAL_INT(3, profileActions(&config, "study", 1, action));
+	TEST_ASSERT_EQUAL_STRING("default", action[0].name);
+	TEST_ASSERT_EQUAL_STRING("", action[0].rc);
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/default", action[0].directory);
+	TEST_ASSERT_EQUAL_STRING(" rc:'" TEST_DIR "/taskrc-work' rc.data.location='"
+			TEST_DIR "/work'", action[1].rc);
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/personal", action[2].directory);
+	TEST_ASSERT_EQUAL_STRING("study", action[2].context);
+	TEST_ASSERT_EQUAL_INT(1, action[2].cancel);
+
+	/* a profile with the context of the zone is left alone */
+	TEST_ASSERT_EQUAL_INT(1, profileActions(&config, "work", 0, action));
+	TEST_ASSERT_EQUAL_STRING("~/taskrc-personal", action[0].name);
+	/* a taskrc without a context has the context none */
+	TEST_ASSERT_EQUAL_INT(1, profileActions(&config, "none", 0, action));
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/taskrc-work", action[0].name);
+}
+
+void test_profileQuoted(void)
+{
+	struct config config = {.profile = {TEST_DIR "/taskrc it's;id"}, .profile_amount = 1};
+	struct profile_action action[MAX_PROFILES+1];
+	char command[PATH_MAX + MAX_ROW + 20] = {0};
+	char argument[2][PATH_MAX] = {{0}};
+	FILE *shell = NULL;
+
+	writeFixture(TEST_DIR "/taskrc it's;id", "data.location=" TEST_DIR "/my $HOME\n", 0600);
+	TEST_ASSERT_EQUAL_INT(1, profileActions(&config, "study", 0, action));
+	/* the shell hands both paths unchanged to taskwarrior */
+	snprintf(command, sizeof(command), "printf '%%s\\n'%s", action[0].rc);
+	shell = popen(command, "r");
+	TEST_ASSERT_NOT_NULL(shell);
+	for(int i = 0 ; i < 2 ; i++)
+		TEST_ASSERT_NOT_NULL(fgets(argument[i], PATH_MAX, shell));
+	TEST_ASSERT_EQUAL_INT(0, pclose(shell));
+	TEST_ASSERT_EQUAL_STRING("rc:" TEST_DIR "/taskrc it's;id\n", argument[0]);
+	TEST_ASSERT_EQUAL_STRING("rc.data.location=" TEST_DIR "/my $HOME\n", argument[1]);
+}
+
+void test_fanOut(void)
+{
+	struct config config = {.profile = {TEST_DIR "/taskrc-work", "~/taskrc-personal"},
+		.profile_amount = 2};
+	struct profile_action action[MAX_PROFILES+1];
+	char path[PATH_MAX] = {0};
+	struct timespec start = {0};
+	struct timespec end = {0};
+	double elapsed = 0;
+
+	/* every call of the fake taskwarrior takes 300 ms */
+	mkdir(TEST_DIR "/bin", 0700);
+	writeFixture(TEST_DIR "/bin/task", "#!/bin/sh\nsleep 0.3\n"
+			"case \"$*\" in *taskrc-personal*) echo \"Context 'x' not found.\";;\n"
+			"*) echo \"Context 'study' set.\";; esac\n", 0700);
+	snprintf(path, PATH_MAX, TEST_DIR "/bin:%s", getenv("PATH"));
+	setenv("PATH", path, 1);
+
+	TEST_ASSERT_EQUAL_INT(3, profileActions(&config, "study", 1, action));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TEST_ASSERT_EQUAL_INT(1, fanOut(action, 3));
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	TEST_ASSERT_EQUAL_INT(SEND_SUCCESS, action[0].result);
+	TEST_ASSERT_EQUAL_INT(SEND_SUCCESS, action[1].result);
+	TEST_ASSERT_EQUAL_INT(SEND_UNKNOWN, action[2].result);
+	TEST_ASSERT_TRUE(action[1].elapsed >= 300000000L);
+	/* the slowest profile, not the sum of all */
+	TEST_ASSERT_TRUE(elapsed < 0.8);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_profile.c");
+	RUN_TEST(test_profileActions);
+	RUN_TEST(test_profileQuoted);
+	RUN_TEST(test_fanOut);
+
+	return UnityEnd();
+}
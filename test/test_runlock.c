@@ -0,0 +1,88 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../source/include/runlock.h"
+
+#define TEST_CONFIG "/tmp/csw-unity-runlock/config"
+
+int verbose = 0;
+
+void setUp(void)
+{
+	mkdir("/tmp/csw-unity-runlock", 0700);
+}
+
+void tearDown(void)
+{
+	unlink(TEST_CONFIG ".lock");
+	rmdir("/tmp/csw-unity-runlock");
+}
+
+void test_lockPath(void)
+{
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, lockPath(path, TEST_CONFIG));
+	TEST_ASSERT_EQUAL_STRING(TEST_CONFIG ".lock", path);
+	TEST_ASSERT_EQUAL_INT(-1, lockPath(path, ""));
+	TEST_ASSERT_EQUAL_INT(-1, lockPath(path, NULL));
+}
+
+void test_lockRun(void)
+{
+	int first = -1;
+	int second = -1;
+
+	TEST_ASSERT_EQUAL_INT(RUN_LOCKED, lockRun(TEST_CONFIG, 0, &first));
+	TEST_ASSERT_TRUE(first != -1);
+
+	/* a tick during the run gives up right away */
+	TEST_ASSERT_EQUAL_INT(RUN_BUSY, lockRun(TEST_CONFIG, 0, &second));
+	TEST_ASSERT_EQUAL_INT(-1, second);
+
+	unlockRun(first);
+	TEST_ASSERT_EQUAL_INT(RUN_LOCKED, lockRun(TEST_CONFIG, 0, &second));
+	unlockRun(second);
+
+	TEST_ASSERT_EQUAL_INT(RUN_UNLOCKED, lockRun("/tmp/csw-unity-missing/config", 0,
+				&first));
+	TEST_ASSERT_EQUAL_INT(-1, first);
+}
+
+void test_lockRunWait(void)
+{
+	int status = 0;
+	int fd = -1;
+	pid_t pid = 0;
+
+	TEST_ASSERT_EQUAL_INT(RUN_LOCKED, lockRun(TEST_CONFIG, 0, &fd));
+	pid = fork();
+	if(pid == 0) {
+		/* the inherited descriptor shares the lock of the parent */
+		close(fd);
+		/* a request waits for the run in progress */
+		if(lockRun(TEST_CONFIG, 0, &fd) != RUN_BUSY)
+			_exit(1);
+		_exit(lockRun(TEST_CONFIG, 1, &fd) == RUN_LOCKED ? 0 : 2);
+	}
+	usleep(50000);
+	unlockRun(fd);
+	TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+	TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_runlock.c");
+	RUN_TEST(test_lockPath);
+	RUN_TEST(test_lockRun);
+	RUN_TEST(test_lockRunWait);
+
+	return UnityEnd();
+}
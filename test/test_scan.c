@@ -0,0 +1,127 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "../source/include/scan.h"
+#include "fixture.h"
+
+int verbose = 0;
+char path[3][PATH_MAX] = {{0}};
+struct scan_file file[3];
+struct scan_file *list[3] = {&file[0], &file[1], &file[2]};
+
+void setUp(void)
+{
+	for(int i = 0 ; i < 3 ; i++) {
+		snprintf(path[i], PATH_MAX, "/tmp/csw-test-scan-%d-%d", (int)getpid(), i);
+		TEST_ASSERT_EQUAL_INT(0, setFile(&file[i], path[i], i != 2));
+	}
+	writeFixture(path[0], "context=work\n", 0644);
+	writeFixture(path[2], "[Zones]\n", 0644);
+	unlink(path[1]);
+}
+
+void tearDown(void)
+{
+	for(int i = 0 ; i < 3 ; i++) {
+		unlink(path[i]);
+		releaseFile(&file[i]);
+	}
+}
+
+void checkScan(int (*scan)(struct scan_file**, int))
+{
+	TEST_ASSERT_EQUAL_INT(2, scan(list, 3));
+	TEST_ASSERT_EQUAL_INT(SCAN_CHANGED, file[0].state);
+	TEST_ASSERT_EQUAL_STRING("context=work\n", file[0].data);
+	TEST_ASSERT_TRUE(file[0].size == 13);
+	TEST_ASSERT_EQUAL_INT(SCAN_MISSING, file[1].state);
+	TEST_ASSERT_NULL(file[1].data);
+	TEST_ASSERT_EQUAL_INT(SCAN_CHANGED, file[2].state);
+	TEST_ASSERT_NULL(file[2].data);
+	TEST_ASSERT_TRUE(file[2].key.size == 8);
+
+	TEST_ASSERT_EQUAL_INT(0, scan(list, 3));
+	TEST_ASSERT_EQUAL_INT(SCAN_UNCHANGED, file[0].state);
+	TEST_ASSERT_EQUAL_STRING("context=work\n", file[0].data);
+	TEST_ASSERT_EQUAL_INT(SCAN_UNCHANGED, file[2].state);
+
+	writeFixture(path[0], "context=study\n", 0644);
+	writeFixture(path[1], "", 0644);
+	unlink(path[2]);
+	TEST_ASSERT_EQUAL_INT(2, scan(list, 3));
+	TEST_ASSERT_EQUAL_STRING("context=study\n", file[0].data);
+	TEST_ASSERT_EQUAL_INT(SCAN_CHANGED, file[1].state);
+	TEST_ASSERT_EQUAL_STRING("", file[1].data);
+	TEST_ASSERT_EQUAL_INT(SCAN_MISSING, file[2].state);
+}
+
+void test_scanFiles(void)
+{
+	checkScan(scanFiles);
+}
+
+void test_scanSync(void)
+{
+	checkScan(scanSync);
+}
+
+void test_scanFilesMany(void)
+{
+	struct scan_file many[SCAN_RING + 10];
+	struct scan_file *many_list[SCAN_RING + 10];
+	int existing = 0;
+
+	for(int i = 0 ; i < SCAN_RING + 10 ; i++) {
+		TEST_ASSERT_EQUAL_INT(0, setFile(&many[i], path[i % 3], 1));
+		many_list[i] = &many[i];
+		existing += i % 3 != 1;
+	}
+	TEST_ASSERT_EQUAL_INT(existing, scanFiles(many_list, SCAN_RING + 10));
+	for(int i = 0 ; i < SCAN_RING + 10 ; i++) {
+		TEST_ASSERT_EQUAL_INT(i % 3 == 1 ? SCAN_MISSING : SCAN_CHANGED,
+				many[i].state);
+		releaseFile(&many[i]);
+	}
+}
+
+void checkFifo(int (*scan)(struct scan_file**, int))
+{
+	time_t start = time(NULL);
+
+	/* a FIFO in place of the taskrc of a user */
+	TEST_ASSERT_EQUAL_INT(0, mkfifo(path[1], 0600));
+	TEST_ASSERT_EQUAL_INT(2, scan(list, 3));
+	TEST_ASSERT_TRUE(time(NULL) - start < 2);
+	TEST_ASSERT_EQUAL_INT(SCAN_FAILED, file[1].state);
+	TEST_ASSERT_NULL(file[1].data);
+	TEST_ASSERT_EQUAL_INT(SCAN_CHANGED, file[0].state);
+}
+
+void test_scanFifo(void)
+{
+	checkFifo(scanFiles);
+}
+
+void test_scanSyncFifo(void)
+{
+	checkFifo(scanSync);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_scan.c");
+	RUN_TEST(test_scanFiles);
+	RUN_TEST(test_scanSync);
+	RUN_TEST(test_scanFilesMany);
+	RUN_TEST(test_scanFifo);
+	RUN_TEST(test_scanSyncFifo);
+
+	return UnityEnd();
+}
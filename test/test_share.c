@@ -0,0 +1,127 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "../source/include/share.h"
+
+int verbose = 0;
+struct schedule_table table;
+struct config config;
+time_t monday = 0;
+
+void setUp(void)
+{
+	struct tm date = {.tm_year=2026-1900, .tm_mon=10-1, .tm_mday=19};
+
+	setenv("TZ", "UTC", 1);
+	tzset();
+	monday = mktime(&date);
+	initSchedules(&table);
+
+	memset(&config, 0, sizeof(struct config));
+	config.zone_amount = 2;
+	strcpy(config.zone_name[0], "morning");
+	strcpy(config.zone_context[0], "work");
+	config.ztime[0] = (struct zonetime){8, 0, 11, 59};
+	strcpy(config.zone_name[1], "afternoon");
+	strcpy(config.zone_context[1], "study");
+	config.ztime[1] = (struct zonetime){13, 0, 16, 59};
+}
+
+void tearDown(void)
+{
+	freeSchedules(&table);
+}
+
+void test_acquireSchedule(void)
+{
+	struct shared_schedule *first = NULL;
+	struct shared_schedule *second = NULL;
+	struct shared_schedule *other = NULL;
+	struct config copy = config;
+
+	/* context names don't shape the schedule */
+	strcpy(copy.zone_context[0], "office");
+	first = acquireSchedule(&table, &config, monday);
+	second = acquireSchedule(&table, &copy, monday);
+	TEST_ASSERT_NOT_NULL(first);
+	TEST_ASSERT_TRUE(first == second);
+	TEST_ASSERT_EQUAL_INT(2, first->references);
+	TEST_ASSERT_EQUAL_INT(1, table.amount);
+	TEST_ASSERT_EQUAL_INT(1, table.builds);
+
+	copy.ztime[1].end_hour = 17;
+	other = acquireSchedule(&table, &copy, monday);
+	TEST_ASSERT_NOT_NULL(other);
+	TEST_ASSERT_TRUE(first != other);
+	TEST_ASSERT_EQUAL_INT(2, table.amount);
+	TEST_ASSERT_EQUAL_INT(2, table.builds);
+
+	releaseSchedule(&table, other);
+	TEST_ASSERT_EQUAL_INT(1, table.amount);
+	releaseSchedule(&table, second);
+	TEST_ASSERT_EQUAL_INT(1, table.amount);
+	releaseSchedule(&table, first);
+	TEST_ASSERT_EQUAL_INT(0, table.amount);
+	TEST_ASSERT_NULL(table.first);
+}
+
+void test_scheduleZone(void)
+{
+	struct shared_schedule *schedule = acquireSchedule(&table, &config, monday);
+	int zone = 0;
+
+	TEST_ASSERT_NOT_NULL(schedule);
+	TEST_ASSERT_EQUAL_INT(0, scheduleZone(&table, schedule, monday + 9*3600, &zone));
+	TEST_ASSERT_EQUAL_INT(0, zone);
+	TEST_ASSERT_EQUAL_INT(0, scheduleZone(&table, schedule, monday + 12*3600, &zone));
+	TEST_ASSERT_EQUAL_INT(-1, zone);
+	TEST_ASSERT_EQUAL_INT(0, scheduleZone(&table, schedule, monday + 14*3600, &zone));
+	TEST_ASSERT_EQUAL_INT(1, zone);
+	TEST_ASSERT_EQUAL_INT((int)(monday / 60) + 13*60,
+			scheduleNext(&table, schedule, monday + 12*3600));
+
+	/* a point in time beyond the horizon rebuilds the timeline */
+	TEST_ASSERT_EQUAL_INT(0, scheduleZone(&table, schedule,
+				monday + 400*86400L + 9*3600, &zone));
+	TEST_ASSERT_EQUAL_INT(0, zone);
+	TEST_ASSERT_EQUAL_INT(2, table.builds);
+}
+
+void test_hashCollision(void)
+{
+	struct shared_schedule *first = acquireSchedule(&table, &config, monday);
+	struct shared_schedule *other = NULL;
+	struct config copy = config;
+
+	/* another schedule that collides with the stored hash */
+	copy.ztime[0].start_hour = 7;
+	TEST_ASSERT_NOT_NULL(first);
+	TEST_ASSERT_EQUAL_INT(0, sameSchedule(&config, &copy));
+	first->hash = scheduleHash(&copy);
+	other = acquireSchedule(&table, &copy, monday);
+	TEST_ASSERT_NOT_NULL(other);
+	TEST_ASSERT_TRUE(first != other);
+	TEST_ASSERT_EQUAL_INT(2, table.amount);
+
+	/* the same schedule in another time zone */
+	setenv("TZ", "Europe/Berlin", 1);
+	tzset();
+	TEST_ASSERT_TRUE(acquireSchedule(&table, &config, monday) != first);
+	TEST_ASSERT_EQUAL_INT(3, table.amount);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_share.c");
+	RUN_TEST(test_acquireSchedule);
+	RUN_TEST(test_scheduleZone);
+	RUN_TEST(test_hashCollision);
+
+	return UnityEnd();
+}
@@ -0,0 +1,121 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../source/include/spawn.h"
+
+#define SPAWN_THREADS 8
+
+int verbose = 0;
+struct spawner spawner;
+pid_t process = 0;
+
+int exitDelay(struct spawn_request *request)
+{
+	if(request->flag.verbose != &verbose || getppid() == process)
+		return EXIT_FAILURE;
+	usleep(10000);
+	return request->flag.delay;
+}
+
+int baseZones(struct spawn_request *request)
+{
+	return request->base.compiled.config.zone_amount;
+}
+
+void setUp(void)
+{
+	process = getpid();
+}
+
+void tearDown(void)
+{
+	stopSpawner(&spawner);
+}
+
+void test_spawnRequest(void)
+{
+	struct spawn_request request;
+	int status = -1;
+
+	memset(&request, 0, sizeof(request));
+	TEST_ASSERT_EQUAL_INT(0, startSpawner(&spawner, exitDelay));
+
+	/* the run is forked by the server, not by the process */
+	TEST_ASSERT_EQUAL_INT(0, spawnRequest(&spawner, &request, &status));
+	TEST_ASSERT_TRUE(WIFEXITED(status));
+	TEST_ASSERT_EQUAL_INT(EXIT_SUCCESS, WEXITSTATUS(status));
+
+	request.flag.delay = 7;
+	TEST_ASSERT_EQUAL_INT(0, spawnRequest(&spawner, &request, &status));
+	TEST_ASSERT_EQUAL_INT(7, WEXITSTATUS(status));
+}
+
+void test_spawnBase(void)
+{
+	struct spawn_request request;
+	int status = -1;
+
+	/* the run gets the base compiled by the process */
+	memset(&request, 0, sizeof(request));
+	request.base.compiled.config.zone_amount = 3;
+	TEST_ASSERT_EQUAL_INT(0, startSpawner(&spawner, baseZones));
+	TEST_ASSERT_EQUAL_INT(0, spawnRequest(&spawner, &request, &status));
+	TEST_ASSERT_TRUE(WIFEXITED(status));
+	TEST_ASSERT_EQUAL_INT(3, WEXITSTATUS(status));
+}
+
+void* requestThread(void *arg)
+{
+	struct spawn_request request;
+	int *result = arg;
+	int status = -1;
+
+	memset(&request, 0, sizeof(request));
+	request.flag.delay = *result;
+	if(spawnRequest(&spawner, &request, &status) != 0 || !WIFEXITED(status))
+		*result = -1;
+	else
+		*result = WEXITSTATUS(status);
+	return NULL;
+}
+
+void test_spawnRequestConcurrent(void)
+{
+	pthread_t thread[SPAWN_THREADS];
+	int result[SPAWN_THREADS];
+
+	TEST_ASSERT_EQUAL_INT(0, startSpawner(&spawner, exitDelay));
+	for(int i = 0 ; i < SPAWN_THREADS ; i++) {
+		result[i] = i + 1;
+		pthread_create(&thread[i], NULL, requestThread, &result[i]);
+	}
+	for(int i = 0 ; i < SPAWN_THREADS ; i++) {
+		pthread_join(thread[i], NULL);
+		TEST_ASSERT_EQUAL_INT(i + 1, result[i]);
+	}
+}
+
+void test_stopSpawner(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, startSpawner(&spawner, exitDelay));
+	stopSpawner(&spawner);
+	TEST_ASSERT_EQUAL_INT(-1, spawner.pid);
+	/* the server is gone, a second stop is ignored */
+	stopSpawner(&spawner);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_spawn.c");
+	RUN_TEST(test_spawnRequest);
+	RUN_TEST(test_spawnBase);
+	RUN_TEST(test_spawnRequestConcurrent);
+	RUN_TEST(test_stopSpawner);
+
+	return UnityEnd();
+}
@@ -0,0 +1,171 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../source/include/stage.h"
+#include "fixture.h"
+
+#define TEST_DIR "/tmp/csw-unity-stage"
+
+int verbose = 0;
+
+char *pending =
+	"[description:\"report\" entry:\"1792300000\" start:\"1792390000\" "
+	"status:\"pending\" uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a01\"]\n"
+	"[description:\"read\" entry:\"1792300000\" status:\"pending\" "
+	"uuid:\"0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a02\"]\n";
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+	writeFixture(TEST_DIR "/taskrc", "context.work=project:work\n"
+			"context.study.read=project:study\ncontext=work\n", 0644);
+	writeFixture(TEST_DIR "/pending.data", pending, 0644);
+}
+
+void tearDown(void)
+{
+	removeFixture(TEST_DIR);
+}
+
+void test_storeStage(void)
+{
+	struct stage stage = {.context = "study", .at = 1792400000, .amount = -1};
+	struct stage loaded;
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, stagePath(path, TEST_DIR "/config", 1));
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/stage", path);
+	TEST_ASSERT_EQUAL_INT(1, loadStage(path, &loaded));
+	TEST_ASSERT_EQUAL_INT(0, storeStage(path, &stage));
+	TEST_ASSERT_EQUAL_INT(0, loadStage(path, &loaded));
+	TEST_ASSERT_EQUAL_STRING("study", loaded.context);
+	TEST_ASSERT_TRUE(loaded.at == 1792400000);
+	dropStage(path, &loaded);
+	TEST_ASSERT_EQUAL_INT(-1, access(path, F_OK));
+}
+
+void test_prepareStage(void)
+{
+	struct stage stage;
+	char value[MAX_FIELD] = {0};
+	time_t at = 1792400000;
+
+	/* the context is already set or not defined */
+	TEST_ASSERT_EQUAL_INT(1, prepareStage(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"work", at, 1));
+	TEST_ASSERT_EQUAL_INT(-1, prepareStage(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"home", at, 1));
+	TEST_ASSERT_EQUAL_INT(-1, prepareStage(&stage, TEST_DIR "/missing", TEST_DIR,
+				"study", at, 1));
+
+	TEST_ASSERT_EQUAL_INT(0, prepareStage(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", at, 1));
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/taskrc.stage", stage.artifact);
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(stage.artifact, "context", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("study", value);
+	TEST_ASSERT_EQUAL_INT(1, stage.amount);
+	TEST_ASSERT_EQUAL_STRING("0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a01", stage.uuid[0]);
+	/* the taskrc is untouched until the boundary */
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(TEST_DIR "/taskrc", "context", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("work", value);
+
+	TEST_ASSERT_EQUAL_INT(1, stageCurrent(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", at));
+	TEST_ASSERT_EQUAL_INT(0, stageCurrent(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", at + 60));
+	writeFixture(TEST_DIR "/pending.data", "", 0644);
+	TEST_ASSERT_EQUAL_INT(0, stageCurrent(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", at));
+}
+
+void test_commitStage(void)
+{
+	struct profile_action action = {.amount = -1};
+	struct stage stage;
+	char value[MAX_FIELD] = {0};
+	time_t at = 1792400000;
+
+	TEST_ASSERT_EQUAL_INT(0, prepareStage(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", at, 1));
+	TEST_ASSERT_EQUAL_INT(-1, commitStage(&stage, TEST_DIR "/taskrc", "work"));
+	TEST_ASSERT_EQUAL_INT(0, commitStage(&stage, TEST_DIR "/taskrc", "study"));
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(TEST_DIR "/taskrc", "context", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("study", value);
+	TEST_ASSERT_EQUAL_INT(-1, access(TEST_DIR "/taskrc.stage", F_OK));
+	/* the artifact is used up */
+	TEST_ASSERT_EQUAL_INT(-1, commitStage(&stage, TEST_DIR "/taskrc", "study"));
+
+	stagedTasks(&stage, TEST_DIR, &action);
+	TEST_ASSERT_EQUAL_INT(1, action.amount);
+	TEST_ASSERT_EQUAL_STRING("0b5c7e52-1f0e-4d7a-9a63-6f3c1f1a0a01", action.uuid[0]);
+	writeFixture(TEST_DIR "/pending.data", "", 0644);
+	stagedTasks(&stage, TEST_DIR, &action);
+	TEST_ASSERT_EQUAL_INT(-1, action.amount);
+}
+
+void test_changedTaskrc(void)
+{
+	struct stage stage;
+	char value[MAX_FIELD] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, prepareStage(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", 1792400000, 0));
+	TEST_ASSERT_EQUAL_INT(-1, stage.amount);
+	/* a context set by hand after the stage */
+	writeFixture(TEST_DIR "/taskrc", "context.work=project:work\n"
+			"context.study.read=project:study\n", 0644);
+	TEST_ASSERT_EQUAL_INT(-1, commitStage(&stage, TEST_DIR "/taskrc", "study"));
+	TEST_ASSERT_EQUAL_INT(1, taskrcValue(TEST_DIR "/taskrc", "context", value, MAX_FIELD));
+}
+
+void test_lockedTaskrc(void)
+{
+	struct stage stage;
+	char value[MAX_FIELD] = {0};
+	char ready = 0;
+	int channel[2];
+	pid_t writer = 0;
+	int lock = -1;
+
+	TEST_ASSERT_EQUAL_INT(0, prepareStage(&stage, TEST_DIR "/taskrc", TEST_DIR,
+				"study", 1792400000, 0));
+	TEST_ASSERT_EQUAL_INT(0, pipe(channel));
+	/* another writer of csw edits the taskrc while the commit waits */
+	writer = fork();
+	TEST_ASSERT_TRUE(writer != -1);
+	if(writer == 0) {
+		lock = open(TEST_DIR "/taskrc", O_RDONLY);
+		if(lock == -1 || flock(lock, LOCK_EX) != 0 || write(channel[1], "x", 1) != 1)
+			_exit(EXIT_FAILURE);
+		usleep(100000);
+		writeFixture(TEST_DIR "/taskrc", "context.study.read=project:study\n", 0644);
+		_exit(EXIT_SUCCESS);
+	}
+	TEST_ASSERT_EQUAL_INT(1, read(channel[0], &ready, 1));
+	TEST_ASSERT_EQUAL_INT(-1, commitStage(&stage, TEST_DIR "/taskrc", "study"));
+	waitpid(writer, NULL, 0);
+	close(channel[0]);
+	close(channel[1]);
+	TEST_ASSERT_EQUAL_INT(1, taskrcValue(TEST_DIR "/taskrc", "context", value, MAX_FIELD));
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_stage.c");
+	RUN_TEST(test_storeStage);
+	RUN_TEST(test_prepareStage);
+	RUN_TEST(test_commitStage);
+	RUN_TEST(test_changedTaskrc);
+	RUN_TEST(test_lockedTaskrc);
+
+	return UnityEnd();
+}
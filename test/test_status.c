@@ -0,0 +1,127 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "../source/include/status.h"
+
+#define TEST_SEGMENT "/csw-unity-test"
+
+void setUp(void)
+{
+	shm_unlink(TEST_SEGMENT);
+}
+
+void tearDown(void)
+{
+	shm_unlink(TEST_SEGMENT);
+}
+
+void test_statusName(void)
+{
+	char name[STATUS_NAME_LEN] = {0};
+
+	setenv("USER", "tester", 1);
+	TEST_ASSERT_EQUAL_INT(0, statusName(name));
+	TEST_ASSERT_EQUAL_STRING("/csw-tester", name);
+
+	unsetenv("USER");
+	TEST_ASSERT_EQUAL_INT(-1, statusName(name));
+}
+
+void test_publishStatus(void)
+{
+	struct status *writer = NULL;
+	struct status *reader = NULL;
+	struct status update = {
+		.pid = 42, .updated = 1000, .context = {"work"}, .zone = {"Work"},
+		.next_zone = {"Evening"}, .next_transition = 4600, .delay = 0,
+		.error_code = -5, .error_msg = {"Invalid context:foo"}
+	};
+	struct status snapshot = {0};
+
+	TEST_ASSERT_NULL(openStatus(TEST_SEGMENT, 0));
+	writer = openStatus(TEST_SEGMENT, 1);
+	TEST_ASSERT_NOT_NULL(writer);
+	reader = openStatus(TEST_SEGMENT, 0);
+	TEST_ASSERT_NOT_NULL(reader);
+
+	publishStatus(writer, &update);
+	TEST_ASSERT_EQUAL_INT(0, readStatus(reader, &snapshot));
+	TEST_ASSERT_EQUAL_INT(2, snapshot.sequence);
+	TEST_ASSERT_EQUAL_INT(42, snapshot.pid);
+	TEST_ASSERT_EQUAL_INT(4600, snapshot.next_transition);
+	TEST_ASSERT_EQUAL_INT(-5, snapshot.error_code);
+	TEST_ASSERT_EQUAL_STRING("work", snapshot.context);
+	TEST_ASSERT_EQUAL_STRING("Work", snapshot.zone);
+	TEST_ASSERT_EQUAL_STRING("Evening", snapshot.next_zone);
+	TEST_ASSERT_EQUAL_STRING("Invalid context:foo", snapshot.error_msg);
+
+	/* a writer that never finishes must not hand out a torn record */
+	writer->sequence += 1;
+	TEST_ASSERT_EQUAL_INT(-1, readStatus(reader, &snapshot));
+	writer->sequence += 1;
+	TEST_ASSERT_EQUAL_INT(0, readStatus(reader, &snapshot));
+	TEST_ASSERT_EQUAL_INT(4, snapshot.sequence);
+
+	TEST_ASSERT_EQUAL_INT(-1, readStatus(NULL, &snapshot));
+	closeStatus(reader);
+	closeStatus(writer);
+}
+
+void test_recordSkip(void)
+{
+	struct status *writer = openStatus(TEST_SEGMENT, 1);
+	struct status update = {.pid = 42, .context = {"work"}};
+	struct status snapshot = {0};
+
+	TEST_ASSERT_NOT_NULL(writer);
+	recordSkip(writer, 1000);
+	recordSkip(writer, 1060);
+	/* the run in progress doesn't reset the counter */
+	publishStatus(writer, &update);
+	TEST_ASSERT_EQUAL_INT(0, readStatus(writer, &snapshot));
+	TEST_ASSERT_TRUE(snapshot.skipped == 2);
+	TEST_ASSERT_EQUAL_INT(1060, snapshot.skipped_at);
+	recordSkip(NULL, 1120);
+	closeStatus(writer);
+}
+
+void test_fillStatus(void)
+{
+	struct config config = {
+		.zone_name = {{"Morning"}, {"Work"}},
+		.ztime = {
+			{.start_hour = 5, .start_minute = 0, .end_hour = 8, .end_minute = 0},
+			{.start_hour = 8, .start_minute = 30, .end_hour = 16, .end_minute = 0}
+		},
+		.zone_context = {{"study"}, {"work"}},
+		.zone_amount = 2
+	};
+	struct tm datetime = {
+		.tm_year = 2020-1900, .tm_mon = 1-1, .tm_mday = 6,
+		.tm_hour = 6, .tm_min = 0, .tm_sec = 30
+	};
+	struct status state = {0};
+
+	fillStatus(&state, &config, &datetime, 100000, "study\n");
+	TEST_ASSERT_EQUAL_STRING("study", state.context);
+	TEST_ASSERT_EQUAL_STRING("Morning", state.zone);
+	TEST_ASSERT_EQUAL_STRING("Work", state.next_zone);
+	TEST_ASSERT_EQUAL_INT(100000 - 30 + 150*60, state.next_transition);
+	TEST_ASSERT_EQUAL_INT(0, state.delay);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_status.c");
+	RUN_TEST(test_statusName);
+	RUN_TEST(test_publishStatus);
+	RUN_TEST(test_recordSkip);
+	RUN_TEST(test_fillStatus);
+
+	return UnityEnd();
+}
@@ -242,6 +242,92 @@ void test_rangeMatch(void)
 	TEST_ASSERT_EQUAL_INT_ARRAY(expected, result, TESTS*3);
 }
 
+void test_activeZone(void)
+{
+	struct config config = {
+		.zone_name = {{"Morning"}, {"Work"}, {"Evening"}},
+		.ztime = {
+			{.start_hour = 5, .start_minute = 0, .end_hour = 8, .end_minute = 0},
+			{.start_hour = 8, .start_minute = 30, .end_hour = 16, .end_minute = 0},
+			{.start_hour = 20, .start_minute = 0, .end_hour = 21, .end_minute = 30}
+		},
+		.zone_amount = 3
+	};
+	int min[TESTS] = {300, 495, 960, 1320};
+	int expected[TESTS] = {0, -1, 1, -1};
+	int result[TESTS] = {0};
+
+	for(int i = 0 ; i < TESTS ; i++)
+		result[i] = activeZone(&config, min[i]);
+
+	TEST_ASSERT_EQUAL_INT_ARRAY(expected, result, TESTS);
+	TEST_ASSERT_EQUAL_INT(-1, activeZone(NULL, 300));
+}
+
+void test_nextZone(void)
+{
+	struct config config = {
+		.zone_name = {{"Morning"}, {"Work"}, {"Evening"}},
+		.ztime = {
+			{.start_hour = 5, .start_minute = 0, .end_hour = 8, .end_minute = 0},
+			{.start_hour = 8, .start_minute = 30, .end_hour = 16, .end_minute = 0},
+			{.start_hour = 20, .start_minute = 0, .end_hour = 21, .end_minute = 30}
+		},
+		.zone_amount = 3
+	};
+	struct config empty = {.zone_amount = 0};
+	int min[TESTS] = {0, 300, 600, 1320};
+	int expected[TESTS] = {0, 1, 2, 0};
+	int expected_distance[TESTS] = {300, 210, 600, 420};
+	int result[TESTS] = {0};
+	int distance[TESTS] = {0};
+
+	for(int i = 0 ; i < TESTS ; i++)
+		result[i] = nextZone(&config, min[i], &distance[i]);
+
+	TEST_ASSERT_EQUAL_INT_ARRAY(expected, result, TESTS);
+	TEST_ASSERT_EQUAL_INT_ARRAY(expected_distance, distance, TESTS);
+	TEST_ASSERT_EQUAL_INT(-1, nextZone(&empty, 300, NULL));
+}
+
+void test_switchZone(void)
+{
+	struct config config = {
+		.zone_context = {{"study"}, {"work"}},
+		.zone_amount = 2
+	};
+	char context[MAX_COMMAND] = {0};
+
+	TEST_ASSERT_EQUAL_INT(SWITCH_SUCCESS, switchZone(&config, 1, context, "study"));
+	TEST_ASSERT_EQUAL_STRING("work", context);
+	TEST_ASSERT_EQUAL_INT(SWITCH_NOTNEEDED, switchZone(&config, 0, context, "study"));
+	TEST_ASSERT_EQUAL_STRING("none", context);
+	TEST_ASSERT_EQUAL_INT(SWITCH_FAILURE, switchZone(&config, -1, context, "study"));
+	TEST_ASSERT_EQUAL_INT(SWITCH_FAILURE, switchZone(&config, 2, context, "study"));
+}
+
+void test_stopCommand(void)
+{
+	char uuid[2][UUID_LEN] = {"a4b6f8a1-0c1d-4e2f-8a3b-4c5d6e7f8091",
+		"b5c7a9b2-1d2e-4f30-9b4c-5d6e7f8091a2"};
+	char command[MAX_ROW] = {0};
+
+	quietTask(0);
+	TEST_ASSERT_EQUAL_INT(0, stopCommand(command, MAX_ROW, "", uuid, 2));
+	TEST_ASSERT_EQUAL_STRING("task" TASK_STOP " a4b6f8a1-0c1d-4e2f-8a3b-4c5d6e7f8091"
+			" b5c7a9b2-1d2e-4f30-9b4c-5d6e7f8091a2 stop 2>&1", command);
+	quietTask(1);
+	TEST_ASSERT_EQUAL_INT(0, stopCommand(command, MAX_ROW, "", NULL, 0));
+	TEST_ASSERT_EQUAL_STRING("task" TASK_QUIET TASK_STOP " +ACTIVE stop 2>&1", command);
+	TEST_ASSERT_EQUAL_INT(-1, stopCommand(command, 40, "", uuid, 2));
+	/* a profile selects its taskrc and data directory */
+	TEST_ASSERT_EQUAL_INT(0, stopCommand(command, MAX_ROW,
+				" rc:/home/a/.taskrc-work rc.data.location=/home/a/.task-work", NULL, 0));
+	TEST_ASSERT_EQUAL_STRING("task" TASK_QUIET " rc:/home/a/.taskrc-work"
+			" rc.data.location=/home/a/.task-work" TASK_STOP " +ACTIVE stop 2>&1", command);
+	quietTask(0);
+}
+
 /*=======MAIN=====*/
 int main(void)
 {
@@ -249,6 +335,10 @@ int main(void)
 	RUN_TEST(test_switchExclusion);
 	RUN_TEST(test_switchContext);
 	RUN_TEST(test_rangeMatch);
+	RUN_TEST(test_activeZone);
+	RUN_TEST(test_nextZone);
+	RUN_TEST(test_switchZone);
+	RUN_TEST(test_stopCommand);
 
 	return UnityEnd();
 }
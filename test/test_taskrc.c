@@ -0,0 +1,94 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../source/include/taskrc.h"
+
+int verbose = 0;
+char path[PATH_MAX] = {0};
+
+void setUp(void)
+{
+	FILE *file = NULL;
+
+	snprintf(path, PATH_MAX, "/tmp/csw-test-taskrc-%d", (int)getpid());
+	file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("# Taskwarrior program configuration file.\n"
+		"data.location=~/.task\n"
+		"context.work=+work\n"
+		"context=study\n"
+		"  context = work   # switched by csw\n"
+		"# context=freetime\n"
+		"contexts=ignored\n", file);
+	fclose(file);
+}
+
+void tearDown(void)
+{
+	unlink(path);
+}
+
+void test_taskrcValue(void)
+{
+	char value[MAX_FIELD] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(path, "context", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("work", value);
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(path, "data.location", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("~/.task", value);
+	TEST_ASSERT_EQUAL_INT(0, taskrcValue(path, "context.work", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("+work", value);
+	TEST_ASSERT_EQUAL_INT(1, taskrcValue(path, "report", value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_INT(-1, taskrcValue("/tmp/csw-test-taskrc-missing",
+				"context", value, MAX_FIELD));
+}
+
+void test_taskrcBuffer(void)
+{
+	char data[] = "context=study\n  context = work   # switched by csw\ncontext.work=+work";
+	char value[MAX_FIELD] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, taskrcBuffer(data, strlen(data), "context",
+				value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("work", value);
+	TEST_ASSERT_EQUAL_INT(0, taskrcBuffer(data, strlen(data), "context.work",
+				value, MAX_FIELD));
+	TEST_ASSERT_EQUAL_STRING("+work", value);
+	TEST_ASSERT_EQUAL_INT(1, taskrcBuffer(data, strlen(data), "report",
+				value, MAX_FIELD));
+}
+
+void test_taskrcContext(void)
+{
+	char context[MAX_COMMAND] = {0};
+	FILE *file = NULL;
+
+	setenv("TASKRC", path, 1);
+	TEST_ASSERT_EQUAL_INT(0, taskrcContext(context, MAX_COMMAND));
+	TEST_ASSERT_EQUAL_STRING("work", context);
+
+	file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("context.work=+work\n", file);
+	fclose(file);
+	TEST_ASSERT_EQUAL_INT(0, taskrcContext(context, MAX_COMMAND));
+	TEST_ASSERT_EQUAL_STRING("none", context);
+
+	setenv("TASKRC", "/tmp/csw-test-taskrc-missing", 1);
+	TEST_ASSERT_EQUAL_INT(-1, taskrcContext(context, MAX_COMMAND));
+	unsetenv("TASKRC");
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_taskrc.c");
+	RUN_TEST(test_taskrcValue);
+	RUN_TEST(test_taskrcBuffer);
+	RUN_TEST(test_taskrcContext);
+
+	return UnityEnd();
+}
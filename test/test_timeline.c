@@ -0,0 +1,227 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "../source/include/timeline.h"
+
+int verbose = 0;
+char path[PATH_MAX] = {0};
+struct config config;
+time_t monday = 0;
+
+void setUp(void)
+{
+	struct tm date = {.tm_year=2026-1900, .tm_mon=10-1, .tm_mday=19};
+
+	setenv("TZ", "UTC", 1);
+	tzset();
+	monday = mktime(&date);
+	snprintf(path, PATH_MAX, "/tmp/csw-test-timeline-%d", (int)getpid());
+	unlink(path);
+
+	memset(&config, 0, sizeof(struct config));
+	config.zone_amount = 2;
+	strcpy(config.zone_name[0], "morning");
+	strcpy(config.zone_context[0], "work");
+	config.ztime[0] = (struct zonetime){8, 0, 11, 59};
+	strcpy(config.zone_name[1], "afternoon");
+	strcpy(config.zone_context[1], "study");
+	config.ztime[1] = (struct zonetime){13, 0, 16, 59};
+	config.excl.amount = 1;
+	strcpy(config.excl.type_name[0], "perm");
+	config.excl.type[0].weekdays[0] = 1;
+	config.excl.type[0].list_len = 1;
+}
+
+void tearDown(void)
+{
+	unlink(path);
+}
+
+void test_timelinePath(void)
+{
+	char result[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, timelinePath(result, "/home/user/.task/csw/config"));
+	TEST_ASSERT_EQUAL_STRING("/home/user/.task/csw/timeline", result);
+	TEST_ASSERT_EQUAL_INT(-1, timelinePath(result, "config"));
+}
+
+void test_dayProfile(void)
+{
+	struct transition profile[DAY_TRANSITIONS];
+	int minute[5] = {0, 480, 720, 780, 1020};
+	int zone[5] = {-1, 0, -1, 1, -1};
+
+	TEST_ASSERT_EQUAL_INT(5, dayProfile(&config, profile));
+	for(int i = 0 ; i < 5 ; i++) {
+		TEST_ASSERT_EQUAL_INT(minute[i], profile[i].minute);
+		TEST_ASSERT_EQUAL_INT(zone[i], profile[i].zone);
+	}
+}
+
+void test_buildTimeline(void)
+{
+	struct transition entry[8 * DAY_TRANSITIONS];
+	int start = (int)(monday / 60);
+
+	/* monday to saturday with 4 transitions each, sunday is excluded */
+	TEST_ASSERT_EQUAL_INT(25, buildTimeline(&config, monday, 7, entry));
+	TEST_ASSERT_EQUAL_INT(start, entry[0].minute);
+	TEST_ASSERT_EQUAL_INT(-1, entry[0].zone);
+	TEST_ASSERT_EQUAL_INT(start + 480, entry[1].minute);
+	TEST_ASSERT_EQUAL_INT(0, entry[1].zone);
+	TEST_ASSERT_EQUAL_INT(start + 1440 + 480, entry[5].minute);
+	TEST_ASSERT_EQUAL_INT(start + 5*1440 + 1020, entry[24].minute);
+
+	/* the first monday after the excluded sunday */
+	TEST_ASSERT_EQUAL_INT(29, buildTimeline(&config, monday, 8, entry));
+	TEST_ASSERT_EQUAL_INT(start + 7*1440 + 480, entry[25].minute);
+}
+
+void test_lookupTimeline(void)
+{
+	struct timeline timeline = {0};
+	struct transition *next = NULL;
+	int start = (int)(monday / 60);
+
+	TEST_ASSERT_EQUAL_INT(-1, lookupTimeline(&timeline, start));
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday + 600));
+	TEST_ASSERT_EQUAL_INT(start, timeline.header->start);
+
+	TEST_ASSERT_EQUAL_INT(-1, lookupTimeline(&timeline, start + 479));
+	TEST_ASSERT_EQUAL_INT(0, lookupTimeline(&timeline, start + 480));
+	TEST_ASSERT_EQUAL_INT(0, lookupTimeline(&timeline, start + 719));
+	TEST_ASSERT_EQUAL_INT(1, lookupTimeline(&timeline, start + 800));
+	/* backwards and far ahead */
+	TEST_ASSERT_EQUAL_INT(0, lookupTimeline(&timeline, start + 500));
+	TEST_ASSERT_EQUAL_INT(-1, lookupTimeline(&timeline, start + 6*1440 + 600));
+	TEST_ASSERT_EQUAL_INT(0, lookupTimeline(&timeline, start + 7*1440 + 600));
+	TEST_ASSERT_EQUAL_INT(-1, lookupTimeline(&timeline, start - 1));
+
+	next = nextTransition(&timeline, start + 1020);
+	TEST_ASSERT_NOT_NULL(next);
+	TEST_ASSERT_EQUAL_INT(start + 1440 + 480, next->minute);
+	TEST_ASSERT_EQUAL_INT(0, next->zone);
+	next = nextTransition(&timeline, start + 5*1440 + 1020);
+	TEST_ASSERT_EQUAL_INT(start + 7*1440 + 480, next->minute);
+	closeTimeline(&timeline);
+}
+
+void test_loadTimeline(void)
+{
+	struct timeline timeline = {0};
+	struct timeline_header *header = NULL;
+	int end = 0;
+
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday));
+	header = timeline.header;
+	end = header->end;
+
+	/* an unchanged schedule keeps the mapping */
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday + 86400));
+	TEST_ASSERT_TRUE(header == timeline.header);
+	closeTimeline(&timeline);
+
+	/* the file is reused by the next process */
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday + 86400));
+	TEST_ASSERT_EQUAL_INT(end, timeline.header->end);
+
+	/* a changed zone triggers a rebuild */
+	config.ztime[0].start_hour = 7;
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday + 86400));
+	TEST_ASSERT_EQUAL_INT(0, lookupTimeline(&timeline, (int)(monday / 60) + 1440 + 420));
+
+	/* a short horizon triggers a rebuild */
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config,
+				(time_t)(end - TIMELINE_REFRESH*24*60) * 60));
+	TEST_ASSERT_TRUE(timeline.header->end > end);
+	closeTimeline(&timeline);
+}
+
+void test_timelineStatus(void)
+{
+	struct timeline timeline = {0};
+	struct status state = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday));
+	timelineStatus(&timeline, &config, &state, monday + 500*60);
+	TEST_ASSERT_EQUAL_STRING("morning", state.zone);
+	TEST_ASSERT_EQUAL_STRING("", state.next_zone);
+	TEST_ASSERT_EQUAL_INT(monday + 720*60, state.next_transition);
+
+	timelineStatus(&timeline, &config, &state, monday + 5*86400 + 1100*60);
+	TEST_ASSERT_EQUAL_STRING("", state.zone);
+	TEST_ASSERT_EQUAL_STRING("morning", state.next_zone);
+	TEST_ASSERT_EQUAL_INT(monday + 7*86400 + 480*60, state.next_transition);
+	closeTimeline(&timeline);
+}
+
+void test_boundaryPassed(void)
+{
+	struct timeline timeline = {0};
+
+	/* zones of the config without a timeline */
+	TEST_ASSERT_EQUAL_INT(0, boundaryPassed(&timeline, &config, monday + 500*60,
+				monday + 700*60));
+	TEST_ASSERT_EQUAL_INT(1, boundaryPassed(&timeline, &config, monday + 500*60,
+				monday + 800*60));
+	TEST_ASSERT_EQUAL_INT(1, boundaryPassed(&timeline, &config, monday + 1100*60,
+				monday + 1440*60 + 500*60));
+	TEST_ASSERT_EQUAL_INT(1, boundaryPassed(&timeline, &config, monday + 500*60,
+				monday + 1440*60 + 500*60));
+
+	TEST_ASSERT_EQUAL_INT(0, loadTimeline(&timeline, path, &config, monday));
+	TEST_ASSERT_EQUAL_INT(0, boundaryPassed(&timeline, &config, monday + 500*60,
+				monday + 719*60));
+	TEST_ASSERT_EQUAL_INT(1, boundaryPassed(&timeline, &config, monday + 500*60,
+				monday + 720*60));
+	/* the excluded weekend has no boundary */
+	TEST_ASSERT_EQUAL_INT(0, boundaryPassed(&timeline, &config, monday + 5*86400 + 1100*60,
+				monday + 6*86400 + 600*60));
+	closeTimeline(&timeline);
+}
+
+void test_zoneIdentity(void)
+{
+	char zone[PATH_MAX + 6] = {0};
+	unsigned int hash = 0;
+	FILE *file = NULL;
+
+	snprintf(zone, sizeof(zone), ":%s.zone", path);
+	file = fopen(zone + 1, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("TZif", file);
+	fclose(file);
+	setenv("TZ", zone, 1);
+	hash = scheduleHash(&config);
+	TEST_ASSERT_TRUE(hash == scheduleHash(&config));
+
+	/* the file of the zone changes while TZ stays the same */
+	file = fopen(zone + 1, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs("TZif2", file);
+	fclose(file);
+	TEST_ASSERT_TRUE(hash != scheduleHash(&config));
+	unlink(zone + 1);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_timeline.c");
+	RUN_TEST(test_timelinePath);
+	RUN_TEST(test_dayProfile);
+	RUN_TEST(test_buildTimeline);
+	RUN_TEST(test_lookupTimeline);
+	RUN_TEST(test_loadTimeline);
+	RUN_TEST(test_timelineStatus);
+	RUN_TEST(test_boundaryPassed);
+	RUN_TEST(test_zoneIdentity);
+
+	return UnityEnd();
+}
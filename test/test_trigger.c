@@ -0,0 +1,124 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../source/include/trigger.h"
+#include "fixture.h"
+
+#define TEST_DIR "/tmp/csw-unity-trigger"
+
+int verbose = 0;
+
+void setUp(void)
+{
+	mkdir(TEST_DIR, 0700);
+}
+
+void tearDown(void)
+{
+	removeFixture(TEST_DIR);
+}
+
+void test_hookLogPath(void)
+{
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, hookLogPath(path, TEST_DIR "/config", 1));
+	TEST_ASSERT_EQUAL_STRING(TEST_DIR "/hooks.log", path);
+}
+
+void test_prepareHooks(void)
+{
+	struct config config = {
+		.zone_name = {"Early", "Late"},
+		.zone_hook = {"", "unmute"},
+		.zone_amount = 2,
+		.hook = {"timew stop"},
+		.hook_amount = 1
+	};
+	struct hook_run run;
+
+	TEST_ASSERT_EQUAL_INT(1, prepareHooks(&config, 0, &run));
+	TEST_ASSERT_EQUAL_STRING("Early", run.zone);
+	TEST_ASSERT_EQUAL_INT(HOOK_WORKERS, run.workers);
+	TEST_ASSERT_EQUAL_INT(2, prepareHooks(&config, 1, &run));
+	TEST_ASSERT_EQUAL_STRING("timew stop", run.command[0]);
+	TEST_ASSERT_EQUAL_STRING("unmute", run.command[1]);
+	TEST_ASSERT_EQUAL_INT(1, prepareHooks(&config, -1, &run));
+}
+
+void test_superviseHooks(void)
+{
+	struct config config = {
+		.zone_name = {"Late"},
+		.zone_hook = {"echo $CSW_FROM-$CSW_TO > " TEST_DIR "/env"},
+		.zone_amount = 1,
+		.hook = {"sleep 5", "exit 3", "sleep 0.3"},
+		.hook_amount = 3
+	};
+	struct hook_run run;
+	struct timespec start = {0};
+	struct timespec end = {0};
+	char log[MAX_MSG] = {0};
+	char value[MAX_FIELD] = {0};
+	FILE *file = NULL;
+	size_t length = 0;
+
+	TEST_ASSERT_EQUAL_INT(4, prepareHooks(&config, 0, &run));
+	run.timeout = 1;
+	snprintf(run.from, MAX_FIELD, "work");
+	snprintf(run.to, MAX_COMMAND, "study");
+	TEST_ASSERT_EQUAL_INT(0, hookLogPath(run.log, TEST_DIR "/config", 1));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	superviseHooks(&run);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	/* the slow hook is killed, the others run beside it */
+	TEST_ASSERT_TRUE(end.tv_sec - start.tv_sec < 3);
+
+	file = fopen(run.log, "r");
+	TEST_ASSERT_NOT_NULL(file);
+	length = fread(log, 1, MAX_MSG - 1, file);
+	fclose(file);
+	TEST_ASSERT_TRUE(length > 0);
+	TEST_ASSERT_NOT_NULL(strstr(log, "status=timeout ms="));
+	TEST_ASSERT_NOT_NULL(strstr(log, "status=3 ms="));
+	TEST_ASSERT_NOT_NULL(strstr(log, "status=0 ms="));
+	TEST_ASSERT_NOT_NULL(strstr(log, "to=study zone=Late"));
+
+	file = fopen(TEST_DIR "/env", "r");
+	TEST_ASSERT_NOT_NULL(file);
+	TEST_ASSERT_NOT_NULL(fgets(value, MAX_FIELD, file));
+	fclose(file);
+	TEST_ASSERT_EQUAL_STRING("work-study\n", value);
+}
+
+void test_startHooks(void)
+{
+	struct hook_run run = {.command = {"sleep 2"}, .amount = 1, .workers = 1,
+		.timeout = 5};
+	struct timespec start = {0};
+	struct timespec end = {0};
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TEST_ASSERT_EQUAL_INT(0, startHooks(&run));
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	/* the caller never waits for the hooks */
+	TEST_ASSERT_TRUE(end.tv_sec - start.tv_sec < 1);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_trigger.c");
+	RUN_TEST(test_hookLogPath);
+	RUN_TEST(test_prepareHooks);
+	RUN_TEST(test_superviseHooks);
+	RUN_TEST(test_startHooks);
+
+	return UnityEnd();
+}
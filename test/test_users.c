@@ -0,0 +1,110 @@
+#define _DEFAULT_SOURCE
+#include "../unity/src/unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../source/include/users.h"
+#include "fixture.h"
+
+int verbose = 0;
+char home_root[PATH_MAX] = {0};
+char config_path[PATH_MAX] = {0};
+struct passwd *self = NULL;
+
+void setUp(void)
+{
+	char command[PATH_MAX*2] = {0};
+	FILE *file = NULL;
+
+	self = getpwuid(getuid());
+	TEST_ASSERT_NOT_NULL(self);
+	snprintf(home_root, PATH_MAX, "/tmp/csw-test-users-%d", (int)getpid());
+	snprintf(command, PATH_MAX*2, "mkdir -p %s/%s/.task/csw", home_root, self->pw_name);
+	TEST_ASSERT_EQUAL_INT(0, system(command));
+	TEST_ASSERT_EQUAL_INT(0, userConfig(config_path, home_root, self->pw_name));
+	file = fopen(config_path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fclose(file);
+}
+
+void tearDown(void)
+{
+	removeFixture(home_root);
+}
+
+void test_userConfig(void)
+{
+	char path[PATH_MAX] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, userConfig(path, "/home", "basti"));
+	TEST_ASSERT_EQUAL_STRING("/home/basti/.task/csw/config", path);
+}
+
+void test_addUser(void)
+{
+	struct user_list list = {0};
+	struct passwd pw = {.pw_name = "basti", .pw_dir = "/home/basti",
+		.pw_uid = 1000, .pw_gid = 100};
+
+	for(int i = 0 ; i < 40 ; i++)
+		TEST_ASSERT_EQUAL_INT(0, addUser(&list, &pw));
+	TEST_ASSERT_EQUAL_INT(40, list.amount);
+	TEST_ASSERT_EQUAL_INT(64, list.size);
+	TEST_ASSERT_EQUAL_STRING("basti", list.user[39].name);
+	TEST_ASSERT_EQUAL_STRING("/home/basti", list.user[39].home);
+	TEST_ASSERT_EQUAL_INT(1000, list.user[39].uid);
+	freeUsers(&list);
+	TEST_ASSERT_EQUAL_INT(0, list.amount);
+}
+
+void test_discoverUsers(void)
+{
+	struct user_list list = {0};
+
+	TEST_ASSERT_EQUAL_INT(1, discoverUsers(&list, home_root));
+	TEST_ASSERT_EQUAL_STRING(self->pw_name, list.user[0].name);
+	TEST_ASSERT_EQUAL_INT(getuid(), list.user[0].uid);
+	freeUsers(&list);
+
+	unlink(config_path);
+	TEST_ASSERT_EQUAL_INT(0, discoverUsers(&list, home_root));
+	freeUsers(&list);
+}
+
+void test_userEnvironment(void)
+{
+	struct user_entry user = {.uid = 4242, .gid = 4242, .name = "basti",
+		.home = "/home/basti"};
+
+	setenv("TASKRC", "/root/.taskrc", 1);
+	TEST_ASSERT_EQUAL_INT(0, userEnvironment(&user));
+	TEST_ASSERT_EQUAL_STRING("/home/basti", getenv("HOME"));
+	TEST_ASSERT_EQUAL_STRING("basti", getenv("USER"));
+	TEST_ASSERT_EQUAL_STRING("basti", getenv("LOGNAME"));
+	TEST_ASSERT_NULL(getenv("TASKRC"));
+	TEST_ASSERT_NULL(getenv("XDG_RUNTIME_DIR"));
+}
+
+void test_dropPrivileges(void)
+{
+	struct user_entry user = {.uid = getuid(), .gid = getgid()};
+
+	strncpy(user.name, self->pw_name, MAX_USER-1);
+	TEST_ASSERT_EQUAL_INT(0, dropPrivileges(&user));
+	TEST_ASSERT_EQUAL_INT(getuid(), user.uid);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_users.c");
+	RUN_TEST(test_userConfig);
+	RUN_TEST(test_addUser);
+	RUN_TEST(test_discoverUsers);
+	RUN_TEST(test_userEnvironment);
+	RUN_TEST(test_dropPrivileges);
+
+	return UnityEnd();
+}
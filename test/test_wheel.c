@@ -0,0 +1,128 @@
+#include "../unity/src/unity.h"
+#include <string.h>
+
+#include "../source/include/wheel.h"
+
+#define START (29000000 / 1440 * 1440)
+
+int verbose = 0;
+struct wheel wheel;
+int fired[8] = {0};
+int fired_at[8] = {0};
+
+void setUp(void)
+{
+	initWheel(&wheel, START);
+	memset(fired, 0, sizeof(fired));
+	memset(fired_at, 0, sizeof(fired_at));
+}
+
+void tearDown(void)
+{
+
+}
+
+void recordTimer(struct wheel_timer *timer, void *arg)
+{
+	fired[timer->owner]++;
+	fired_at[timer->owner] = ((struct wheel*)arg)->current - 1;
+}
+
+void rescheduleTimer(struct wheel_timer *timer, void *arg)
+{
+	recordTimer(timer, arg);
+	if(fired[timer->owner] < 3)
+		addTimer(arg, timer, timer->expiry);
+}
+
+void test_addTimer(void)
+{
+	struct wheel_timer timer[3] = {{.owner = 0}, {.owner = 1}, {.owner = 2}};
+
+	TEST_ASSERT_EQUAL_INT(-1, nextExpiry(&wheel));
+	addTimer(&wheel, &timer[0], START + 5);
+	addTimer(&wheel, &timer[1], START + 90);
+	addTimer(&wheel, &timer[2], START + 3*1440 + 7);
+	TEST_ASSERT_EQUAL_INT(3, wheel.amount);
+	TEST_ASSERT_EQUAL_INT(START + 5, nextExpiry(&wheel));
+
+	/* moving a timer doesn't duplicate it */
+	addTimer(&wheel, &timer[0], START + 10);
+	TEST_ASSERT_EQUAL_INT(3, wheel.amount);
+	TEST_ASSERT_EQUAL_INT(START + 10, nextExpiry(&wheel));
+
+	cancelTimer(&wheel, &timer[0]);
+	cancelTimer(&wheel, &timer[0]);
+	TEST_ASSERT_EQUAL_INT(2, wheel.amount);
+	TEST_ASSERT_NULL(timer[0].next);
+	/* the hour slot of the second timer starts at START + 60 */
+	TEST_ASSERT_EQUAL_INT(START + 60, nextExpiry(&wheel));
+}
+
+void test_advanceWheel(void)
+{
+	struct wheel_timer timer[4] = {{.owner = 0}, {.owner = 1}, {.owner = 2},
+		{.owner = 3}};
+	int wakeups = 0;
+	int next = 0;
+
+	addTimer(&wheel, &timer[0], START + 5);
+	addTimer(&wheel, &timer[1], START + 90);
+	addTimer(&wheel, &timer[2], START + 3*1440 + 7);
+	addTimer(&wheel, &timer[3], START + 600*1440 + 1);
+
+	/* jump from wakeup to wakeup like the daemon */
+	while((next = nextExpiry(&wheel)) != -1 && wakeups < 100) {
+		advanceWheel(&wheel, next, recordTimer, &wheel);
+		wakeups++;
+	}
+	for(int i = 0 ; i < 4 ; i++)
+		TEST_ASSERT_EQUAL_INT(1, fired[i]);
+	TEST_ASSERT_EQUAL_INT(START + 5, fired_at[0]);
+	TEST_ASSERT_EQUAL_INT(START + 90, fired_at[1]);
+	TEST_ASSERT_EQUAL_INT(START + 3*1440 + 7, fired_at[2]);
+	TEST_ASSERT_EQUAL_INT(START + 600*1440 + 1, fired_at[3]);
+	TEST_ASSERT_TRUE(wakeups < 20);
+	TEST_ASSERT_EQUAL_INT(0, wheel.amount);
+}
+
+void test_advanceLate(void)
+{
+	struct wheel_timer timer[2] = {{.owner = 0}, {.owner = 1}};
+
+	/* a suspended host processes every missed minute at once */
+	addTimer(&wheel, &timer[0], START + 30);
+	addTimer(&wheel, &timer[1], START + 2000);
+	TEST_ASSERT_EQUAL_INT(2, advanceWheel(&wheel, START + 5000, recordTimer, &wheel));
+	TEST_ASSERT_EQUAL_INT(1, fired[0]);
+	TEST_ASSERT_EQUAL_INT(1, fired[1]);
+
+	/* a timer in the past fires on the next advance */
+	addTimer(&wheel, &timer[0], START);
+	TEST_ASSERT_EQUAL_INT(START + 5001, nextExpiry(&wheel));
+	TEST_ASSERT_EQUAL_INT(1, advanceWheel(&wheel, START + 5001, recordTimer, &wheel));
+}
+
+void test_rescheduleInCallback(void)
+{
+	struct wheel_timer timer = {.owner = 0};
+
+	addTimer(&wheel, &timer, START + 1);
+	TEST_ASSERT_EQUAL_INT(1, advanceWheel(&wheel, START + 1, rescheduleTimer, &wheel));
+	TEST_ASSERT_EQUAL_INT(START + 2, nextExpiry(&wheel));
+	TEST_ASSERT_EQUAL_INT(2, advanceWheel(&wheel, START + 10, rescheduleTimer, &wheel));
+	TEST_ASSERT_EQUAL_INT(3, fired[0]);
+	TEST_ASSERT_EQUAL_INT(0, wheel.amount);
+}
+
+/*=======MAIN=====*/
+int main(void)
+{
+	UnityBegin("test_wheel.c");
+	RUN_TEST(test_addTimer);
+	RUN_TEST(test_advanceWheel);
+	RUN_TEST(test_advanceLate);
+	RUN_TEST(test_rescheduleInCallback);
+
+	return UnityEnd();
+}